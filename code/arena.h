@@ -0,0 +1,472 @@
+/* date = October 17th 2026 9:42 am */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+// NOTE(jdiaz): Arenas. Linear allocators over a block of memory, everything pushed is freed at once
+// by clearing the arena or by ending a temporary memory marker. Pushes are aligned (to the type
+// alignment for PushStruct/PushArray) and can be zeroed.
+//
+// An arena made with MakeArena over a fixed buffer asserts when it runs out. An arena with a
+// MinimumBlockSize (or just zero initialized, see ARENA_DEFAULT_BLOCK_SIZE) grows instead: when a
+// push does not fit, a new block is taken from the platform (AllocateArenaBlock) and chained in
+// front of the current one, the previous block is remembered in a footer at the end of the new one.
+//
+// Scratch memory. Every thread gets its own slice (slot) of the platform reservation the
+// first time it opens a scratch_block, and uses it as a stack: a block takes the next Size bytes
+// and gives them back when it goes out of scope. Pages are committed the first time the stack
+// grows over them and stay committed while they are within SCRATCH_DECOMMIT_THRESHOLD of the top,
+// so once warmed up a scratch_block costs no syscalls, but a one-off big block does not keep its
+// pages for the life of the process. When a thread exits its slot is decommitted and reused.
+// Blocks reserve their whole Size up front, so nested blocks never overlap an outer one, even
+// when the inner code keeps pushing into the outer arena.
+//
+// Block region. Large pages can only be committed all at once, so with --large-pages the platform
+// maps one ARENA_BLOCK_REGION_SIZE region up front and serves the growing arena blocks from it
+// (BlockRegionAllocate). Blocks are rounded to ARENA_BLOCK_GRANULARITY and carved from the end of
+// the used part. A freed block goes back to the end when it is the last one, otherwise to a free
+// list, where it waits for a block of the same size (arenas keep asking for the same sizes). When
+// the region is full the platform takes the block from the OS with regular pages.
+
+#define SCRATCH_MAX_THREADS        128
+#define SCRATCH_THREAD_RESERVE     MB(256) // address space per thread
+#define SCRATCH_COMMIT_GRANULARITY KB(64)
+#define SCRATCH_DECOMMIT_THRESHOLD MB(32)  // committed bytes kept above the top when a block closes
+
+#define ARENA_DEFAULT_BLOCK_SIZE   MB(1)
+#define ARENA_DEFAULT_ALIGNMENT    16
+
+#define ARENA_BLOCK_REGION_SIZE    MB(512)
+#define ARENA_BLOCK_GRANULARITY    KB(64)
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+enum arena_flags
+{
+    Arena_FixedSize = 0x1, // never grows, MakeArena over a buffer the arena does not own
+};
+
+enum arena_push_flags
+{
+    ArenaPush_Zero = 0x1,
+};
+
+struct arena
+{
+    u64 Size;
+    u64 Head;
+    u8* Buffer;
+    
+    u64 MinimumBlockSize; // 0 means ARENA_DEFAULT_BLOCK_SIZE
+    u32 Flags;
+    u32 BlockCount;       // chained blocks, not counting a fixed buffer
+    i32 TempCount;
+    u32 Tag;              // memory_tag the chained blocks are accounted under
+    
+    // Stats
+    u64 PreviousBlocksUsed; // bytes in use in the chained blocks before the current one
+    u64 HighWater;          // most bytes in use at once
+};
+
+// Stored at the end of every chained block, points back to the block before it
+struct arena_block_footer
+{
+    u8* Buffer;
+    u64 Size;
+    u64 Head;
+};
+
+struct temp_memory
+{
+    arena* Arena;
+    u8*    Buffer;
+    u64    Head;
+};
+
+struct scratch_block
+{
+    arena Arena;
+    u64   Mark; // thread scratch top when the block was opened
+    
+    scratch_block();
+    scratch_block(u64 Size);
+    ~scratch_block();
+    
+    scratch_block(const scratch_block&) = delete;
+    scratch_block& operator=(const scratch_block&) = delete;
+    
+    operator arena*() { return &Arena; }
+};
+
+// Platform reservation, SCRATCH_THREAD_RESERVE bytes per thread
+struct scratch_memory
+{
+    u64          Size;
+    u8*          Buffer;
+    volatile u32 SlotUsed[SCRATCH_MAX_THREADS]; // taken by a live thread
+};
+
+// Stored at the start of a freed block while it is in the block region free list
+struct free_arena_block
+{
+    free_arena_block* Next;
+    u64               Size;
+};
+
+// Large page memory the platform carves growing arena blocks from, Buffer is NULL when unused
+struct arena_block_region
+{
+    u8*               Buffer;
+    u64               Size;
+    u64               Used;    // blocks are carved from the end of the used part
+    u64               Touched; // most Used ever, the memory after it was never handed out
+    volatile u32      Lock;
+    free_arena_block* FreeList;
+};
+
+struct thread_scratch
+{
+    u8* Base;
+    u64 Top;       // end of the innermost open block
+    u64 Committed;
+    
+    ~thread_scratch(); // gives the slot back when the thread exits
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal thread_local thread_scratch ThreadScratch;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: Implemented by the platform layer on top of its reservation (App.ScratchMemory), with
+// ScratchMemoryAcquireSlot / ScratchMemoryReleaseSlot
+u8*  ReserveThreadScratchMemory();
+void ReleaseThreadScratchMemory(u8* Base);
+void CommitScratchMemory(u8* Base, u64 Size);
+void DecommitScratchMemory(u8* Base, u64 Size);
+
+// NOTE: Implemented by the platform layer, committed and zeroed memory for growing arenas
+u8*  AllocateArenaBlock(u64 Size);
+void FreeArenaBlock(u8* Base, u64 Size);
+
+inline void BlockRegionLock(arena_block_region *Region)
+{
+    while (AtomicCompareExchange(&Region->Lock, 0, 1) != 0)
+    {
+        CpuPause();
+    }
+}
+
+inline void BlockRegionUnlock(arena_block_region *Region)
+{
+    AtomicStoreRelease(&Region->Lock, 0);
+}
+
+// Zeroed block of Size bytes, NULL when there is no region or it is full
+internal u8* BlockRegionAllocate(arena_block_region *Region, u64 Size)
+{
+    if (!Region->Buffer) {
+        return NULL;
+    }
+    
+    Size = (Size + ARENA_BLOCK_GRANULARITY - 1) & ~(ARENA_BLOCK_GRANULARITY - 1);
+    u8* Res = NULL;
+    
+    BlockRegionLock(Region);
+    
+    for (free_arena_block **Link = &Region->FreeList; *Link; Link = &(*Link)->Next)
+    {
+        if ((*Link)->Size == Size)
+        {
+            Res   = (u8*)*Link;
+            *Link = (*Link)->Next;
+            break;
+        }
+    }
+    
+    if (!Res && Region->Used + Size <= Region->Size)
+    {
+        Res = Region->Buffer + Region->Used;
+        Region->Used += Size;
+    }
+    
+    // only the memory past Touched is still as the OS gave it, zeroed
+    u64 Dirty = 0;
+    if (Res)
+    {
+        u64 Offset = Res - Region->Buffer;
+        Dirty = Offset < Region->Touched ? Min(Size, Region->Touched - Offset) : 0;
+        Region->Touched = Max(Region->Touched, Offset + Size);
+    }
+    
+    BlockRegionUnlock(Region);
+    
+    if (Dirty) {
+        memset(Res, 0, Dirty);
+    }
+    
+    return Res;
+}
+
+// False when Base does not come from the region
+internal b32 BlockRegionFree(arena_block_region *Region, u8* Base, u64 Size)
+{
+    if (Base < Region->Buffer || Base >= Region->Buffer + Region->Size) {
+        return false;
+    }
+    
+    Size = (Size + ARENA_BLOCK_GRANULARITY - 1) & ~(ARENA_BLOCK_GRANULARITY - 1);
+    
+    BlockRegionLock(Region);
+    
+    if (Base + Size == Region->Buffer + Region->Used)
+    {
+        Region->Used -= Size;
+    }
+    else
+    {
+        free_arena_block *Block = (free_arena_block*)Base;
+        Block->Size = Size;
+        Block->Next = Region->FreeList;
+        Region->FreeList = Block;
+    }
+    
+    BlockRegionUnlock(Region);
+    return true;
+}
+
+inline arena MakeArena(u8* Buffer, u64 Size)
+{
+    arena Arena  = {};
+    Arena.Size   = Size;
+    Arena.Buffer = Buffer;
+    Arena.Flags  = Arena_FixedSize;
+    return Arena;
+}
+
+inline arena MakeGrowingArena(u64 MinimumBlockSize, u32 Tag = MemoryTag_Untagged)
+{
+    arena Arena = {};
+    Arena.MinimumBlockSize = MinimumBlockSize;
+    Arena.Tag              = Tag;
+    return Arena;
+}
+
+inline u64 ArenaAlignmentOffset(arena *Arena, u64 Alignment)
+{
+    Assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0);
+    u64 Address = (u64)(Arena->Buffer + Arena->Head);
+    return (Alignment - (Address & (Alignment - 1))) & (Alignment - 1);
+}
+
+inline u64 ArenaUsed(arena *Arena)
+{
+    return Arena->PreviousBlocksUsed + Arena->Head;
+}
+
+// Chains a new block able to hold Size bytes aligned to Alignment
+internal void ArenaGrow(arena *Arena, u64 Size, u64 Alignment)
+{
+    Assert(!(Arena->Flags & Arena_FixedSize)); // out of memory
+    
+    u64 MinimumBlockSize = Arena->MinimumBlockSize ? Arena->MinimumBlockSize : ARENA_DEFAULT_BLOCK_SIZE;
+    u64 FooterAlignment  = alignof(arena_block_footer);
+    u64 BlockSize = Max(Size + Alignment - 1, MinimumBlockSize);
+    BlockSize = (BlockSize + FooterAlignment - 1) & ~(FooterAlignment - 1); // the footer goes right after
+    u64 AllocationSize = BlockSize + sizeof(arena_block_footer);
+    
+    u8* Buffer = AllocateArenaBlock(AllocationSize);
+    Assert(Buffer);
+    MemoryTrackAlloc(Arena->Tag, AllocationSize);
+    
+    arena_block_footer *Footer = (arena_block_footer*)(Buffer + BlockSize);
+    Footer->Buffer = Arena->Buffer;
+    Footer->Size   = Arena->Size;
+    Footer->Head   = Arena->Head;
+    
+    Arena->PreviousBlocksUsed += Arena->Head;
+    Arena->Buffer = Buffer;
+    Arena->Size   = BlockSize;
+    Arena->Head   = 0;
+    Arena->BlockCount++;
+}
+
+// Gives the current chained block back to the platform and makes the previous one current
+internal void ArenaFreeCurrentBlock(arena *Arena)
+{
+    Assert(Arena->BlockCount > 0);
+    
+    u8* Buffer = Arena->Buffer;
+    u64 Size   = Arena->Size;
+    arena_block_footer Footer = *(arena_block_footer*)(Buffer + Size);
+    
+    Arena->Buffer = Footer.Buffer;
+    Arena->Size   = Footer.Size;
+    Arena->Head   = Footer.Head;
+    Arena->PreviousBlocksUsed -= Footer.Head;
+    Arena->BlockCount--;
+    
+    FreeArenaBlock(Buffer, Size + sizeof(arena_block_footer));
+    MemoryTrackFree(Arena->Tag, Size + sizeof(arena_block_footer));
+}
+
+inline u8* PushSize_(arena *Arena, u64 Size, u64 Alignment = ARENA_DEFAULT_ALIGNMENT, u32 PushFlags = 0)
+{
+    u64 Offset = Arena->Buffer ? ArenaAlignmentOffset(Arena, Alignment) : 0;
+    
+    if (!Arena->Buffer || Arena->Head + Offset + Size > Arena->Size)
+    {
+        ArenaGrow(Arena, Size, Alignment);
+        Offset = ArenaAlignmentOffset(Arena, Alignment);
+    }
+    
+    u8* Res = Arena->Buffer + Arena->Head + Offset;
+    Arena->Head += Offset + Size;
+    Arena->HighWater = Max(Arena->HighWater, ArenaUsed(Arena));
+    
+    // NOTE(jdiaz): New blocks come zeroed from the platform, reused memory does not
+    if (PushFlags & ArenaPush_Zero) {
+        memset(Res, 0, Size);
+    }
+    
+    return Res;
+}
+
+#define PushSize(Arena, Size, ...)           PushSize_(Arena, Size, ##__VA_ARGS__)
+#define PushStruct(Arena, type, ...)         (type*)PushSize_(Arena,           sizeof(type), alignof(type), ##__VA_ARGS__)
+#define PushArray(Arena, type, Count, ...)   (type*)PushSize_(Arena, (Count) * sizeof(type), alignof(type), ##__VA_ARGS__)
+
+// Frees everything, a fixed size arena keeps its buffer
+internal void ClearArena(arena *Arena)
+{
+    Assert(Arena->TempCount == 0);
+    
+    while (Arena->BlockCount > 0) {
+        ArenaFreeCurrentBlock(Arena);
+    }
+    Arena->Head = 0;
+}
+
+// Everything pushed between Begin and End is freed by End, chained blocks included
+inline temp_memory BeginTempMemory(arena *Arena)
+{
+    temp_memory Temp = { Arena, Arena->Buffer, Arena->Head };
+    Arena->TempCount++;
+    return Temp;
+}
+
+inline void EndTempMemory(temp_memory Temp)
+{
+    arena *Arena = Temp.Arena;
+    
+    while (Arena->Buffer != Temp.Buffer) {
+        ArenaFreeCurrentBlock(Arena);
+    }
+    
+    Assert(Arena->Head >= Temp.Head && Arena->TempCount > 0);
+    Arena->Head = Temp.Head;
+    Arena->TempCount--;
+}
+
+// Base of a free slot, which is taken until ScratchMemoryReleaseSlot
+internal u8* ScratchMemoryAcquireSlot(scratch_memory *Memory)
+{
+    for (u32 Slot = 0; Slot < SCRATCH_MAX_THREADS; ++Slot)
+    {
+        if (!Memory->SlotUsed[Slot] && AtomicCompareExchange(Memory->SlotUsed + Slot, 0, 1) == 0) {
+            return Memory->Buffer + Slot * SCRATCH_THREAD_RESERVE;
+        }
+    }
+    
+    // NOTE(jdiaz): More than SCRATCH_MAX_THREADS live threads have used scratch memory
+    Assert(!"Out of scratch memory slots, raise SCRATCH_MAX_THREADS");
+    return NULL;
+}
+
+inline void ScratchMemoryReleaseSlot(scratch_memory *Memory, u8* Base)
+{
+    u64 Slot = (Base - Memory->Buffer) / SCRATCH_THREAD_RESERVE;
+    Assert(Slot < SCRATCH_MAX_THREADS && Memory->SlotUsed[Slot]);
+    AtomicStoreRelease(Memory->SlotUsed + Slot, 0);
+}
+
+// Commits or decommits the end of the slot so exactly Committed bytes are committed
+internal void ThreadScratchSetCommitted(thread_scratch *Scratch, u64 Committed)
+{
+    if (Committed > Scratch->Committed) {
+        CommitScratchMemory(Scratch->Base + Scratch->Committed, Committed - Scratch->Committed);
+    } else if (Committed < Scratch->Committed) {
+        DecommitScratchMemory(Scratch->Base + Committed, Scratch->Committed - Committed);
+    }
+    
+    // counted as one allocation per thread, resized
+    if (Scratch->Committed) {
+        MemoryTrackFree(MemoryTag_Scratch, Scratch->Committed);
+    }
+    if (Committed) {
+        MemoryTrackAlloc(MemoryTag_Scratch, Committed);
+    }
+    Scratch->Committed = Committed;
+}
+
+thread_scratch::~thread_scratch()
+{
+    // NOTE(jdiaz): No Assert(Top == 0) here: exit() runs the thread_local destructors of the calling
+    // thread, so a fatal error raised with scratch blocks open ends up here with them still open.
+    // Nothing can use them after this anyway.
+    if (Base)
+    {
+        ThreadScratchSetCommitted(this, 0);
+        ReleaseThreadScratchMemory(Base);
+        Base = NULL;
+    }
+}
+
+inline void ScratchBlockOpen(scratch_block *Block, u64 Size)
+{
+    thread_scratch *Scratch = &ThreadScratch;
+    if (!Scratch->Base) {
+        Scratch->Base = ReserveThreadScratchMemory();
+    }
+    
+    // keeps the next block 16 byte aligned
+    u64 Top = Scratch->Top + ((Size + 15) & ~15ull);
+    Assert(Top <= SCRATCH_THREAD_RESERVE);
+    
+    if (Top > Scratch->Committed) {
+        ThreadScratchSetCommitted(Scratch, (Top + SCRATCH_COMMIT_GRANULARITY - 1) & ~(SCRATCH_COMMIT_GRANULARITY - 1));
+    }
+    
+    Block->Mark   = Scratch->Top;
+    Block->Arena  = MakeArena(Scratch->Base + Scratch->Top, Size);
+    Scratch->Top  = Top;
+}
+
+scratch_block::scratch_block()
+{
+    ScratchBlockOpen(this, MB(1));
+}
+
+scratch_block::scratch_block(u64 Size)
+{
+    ScratchBlockOpen(this, Size);
+}
+
+scratch_block::~scratch_block()
+{
+    // blocks are closed in reverse order, they live on the stack of the thread that opened them
+    thread_scratch *Scratch = &ThreadScratch;
+    Assert(Scratch->Top == Mark + ((Arena.Size + 15) & ~15ull));
+    Scratch->Top = Mark;
+    
+    // gives back what a big block committed once it is far enough from the top
+    u64 Keep = (Mark + SCRATCH_DECOMMIT_THRESHOLD + SCRATCH_COMMIT_GRANULARITY - 1) & ~(SCRATCH_COMMIT_GRANULARITY - 1);
+    if (Scratch->Committed > Keep) {
+        ThreadScratchSetCommitted(Scratch, Keep);
+    }
+}
+
+#endif //ARENA_H
@@ -0,0 +1,59 @@
+/* date = October 17th 2026 11:05 am */
+
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+// NOTE(jdiaz): Batched asynchronous whole-file reads. Reads are queued with AsyncIOSubmitRead,
+// handed to the kernel in batches with AsyncIOFlush and finish in any order. Finished reads are
+// collected by any thread with AsyncIOGetCompletions. Implemented by win32_async_io.cpp
+// (overlapped I/O + completion port) and linux_async_io.cpp (io_uring).
+
+#define ASYNC_IO_DEFAULT_QUEUE_DEPTH 64
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct async_read
+{
+    // Filled by the caller
+    const char*  FilePath;
+    void*        UserData;
+    
+    // Filled by the I/O engine. Bytes is NUL terminated (ByteCount does not include it).
+    u8*          Bytes;
+    u64          ByteCount;
+    volatile b32 Completed;
+    b32          Succeeded;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal void AsyncIOInit(u32 QueueDepth);
+internal void AsyncIOShutdown();
+
+// Opens the file, allocates Read->Bytes from Arena and queues the read. Returns false if the file
+// cannot be opened or if QueueDepth reads are already in flight (drain some completions first).
+internal b32  AsyncIOSubmitRead(async_read *Read, arena *Arena);
+
+// Hands all the queued reads to the kernel in a single call.
+internal void AsyncIOFlush();
+
+// Stores up to MaxCount finished reads in Completions and returns how many. If Wait is set and
+// there are reads in flight, it blocks until at least one of them finishes.
+internal u32  AsyncIOGetCompletions(async_read **Completions, u32 MaxCount, b32 Wait);
+
+internal void AsyncIOWaitFor(async_read *Read)
+{
+    AsyncIOFlush();
+    
+    while (!Read->Completed)
+    {
+        async_read *Completions[16];
+        if (AsyncIOGetCompletions(Completions, ArrayCount(Completions), true) == 0 && !Read->Completed)
+        {
+            ExitWithError("Waiting for a read that was never submitted");
+        }
+    }
+}
+
+#endif //ASYNC_IO_H
@@ -0,0 +1,865 @@
+/* date = October 18th 2026 1:35 am */
+
+#ifndef BVH_H
+#define BVH_H
+
+// NOTE(jdiaz): Bounding volume hierarchy over object AABBs, for visibility and picking in scenes
+// too big to scan. 4 wide: a node holds the bounds of its (up to) 4 children in SoA, so the queries
+// test the 4 of them at once with one f32x4 per component. A child is another node or one object.
+//
+// Built top down with binned SAH: a node splits its objects in two with the cheapest of BVH_BINS
+// planes per axis, then splits the bigger halves again until it has 4 children. The objects under
+// any node are a contiguous range of Indices, so a node completely inside a frustum appends its
+// whole range without going further down. The top of the tree is split on the calling thread until
+// the ranges are down to BVH_JOB_OBJECTS, the subtrees below are built as jobs and appended in
+// order afterwards, the tree does not depend on the scheduling. Ranges under BVH_MIN_JOB_OBJECTS
+// are not worth a job and are built in place.
+//
+// BvhQueryFrustumParallel splits the same way: the top of the tree is tested on the calling thread,
+// every subtree of up to BVH_QUERY_JOB_OBJECTS that touches the frustum is a job writing at the
+// start of its own range of the output, and the ranges are packed together in Indices order after.
+//
+// Children always come after their parents. BvhRefit walks the nodes backwards to update the bounds
+// of moving objects without a rebuild (the tree gets worse as they move away from where it was
+// built, rebuild it then).
+
+#define BVH_BINS              16
+#define BVH_MAX_DEPTH         48    // splits below are halves by index, which keeps the stacks bounded
+#define BVH_STACK_SIZE        256   // more than 3 entries per level of a tree that deep
+#define BVH_JOB_OBJECTS       16384 // subtrees built as one job
+#define BVH_MIN_JOB_OBJECTS   1024  // smaller subtrees are built on the calling thread
+#define BVH_MAX_JOBS          1024  // past that the subtrees are built on the calling thread
+#define BVH_QUERY_JOB_OBJECTS 8192  // subtrees queried as one job
+#define BVH_MAX_QUERY_JOBS    1024
+
+#define BVH_EMPTY       U32_MAX    // unused child, also "no object" in the query results
+#define BVH_OBJECT      0x80000000 // flag on a child that is an object index instead of a node
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct aabb
+{
+    vec3 Min;
+    vec3 Max;
+};
+
+// Bounds are Min[Axis][Child], unused children have empty (inverted) bounds that no query hits
+struct alignas(16) bvh_node
+{
+    f32 Min[3][4];
+    f32 Max[3][4];
+    u32 Child[4]; // node index, BVH_OBJECT | object index or BVH_EMPTY
+    u32 First[4]; // range of Indices under the child
+    u32 Count[4];
+};
+
+struct bvh
+{
+    u32       Count;     // objects
+    u32       Capacity;
+    u32       NodeCount;
+    bvh_node* Nodes;     // Nodes[0] is the root
+    u32*      Indices;   // object indices in tree order
+};
+
+struct bvh_build_job
+{
+    const aabb* Boxes;
+    const vec3* Centroids;
+    u32*        Indices;
+    u32         First;
+    u32         Count;
+    u32         Depth;
+    u32         Parent;    // node and child that point at the subtree
+    u32         Slot;
+    bvh_node*   Nodes;     // the subtree, node indices local to it
+    u32         NodeCount;
+};
+
+struct bvh_builder
+{
+    const aabb*    Boxes;
+    const vec3*    Centroids;
+    u32*           Indices;
+    bvh_node*      Nodes;
+    u32            NodeCount;
+    u32            NodeCapacity;
+    bvh_build_job* Jobs;      // only while splitting the top of the tree
+    u32            JobCount;
+};
+
+// Frustum planes broadcast for the 4 wide node tests
+struct bvh_frustum
+{
+    f32x4 Planes[6][4];
+    b32   FarIsMax[6][3];
+};
+
+struct bvh_query_job
+{
+    const bvh*         Bvh;
+    const bvh_frustum* Frustum;
+    u32                Node;    // subtree root, BVH_EMPTY when the whole range is inside
+    u32                First;   // range of Indices under it
+    u32                Count;
+    u32*               Visible; // the whole output, the job writes from Visible + First
+    u32                VisibleCount;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+inline aabb AabbEmpty()
+{
+    aabb Res = {V3(F32_MAX), V3(-F32_MAX)};
+    return Res;
+}
+
+inline void AabbGrow(aabb *Box, const aabb &Other)
+{
+    Box->Min = V3(Min(Box->Min.x, Other.Min.x), Min(Box->Min.y, Other.Min.y), Min(Box->Min.z, Other.Min.z));
+    Box->Max = V3(Max(Box->Max.x, Other.Max.x), Max(Box->Max.y, Other.Max.y), Max(Box->Max.z, Other.Max.z));
+}
+
+// Half the surface area, all SAH needs
+inline f32 AabbHalfArea(const aabb &Box)
+{
+    vec3 Size = Box.Max - Box.Min;
+    return Size.x * Size.y + Size.y * Size.z + Size.z * Size.x;
+}
+
+internal void BvhInit(bvh *Bvh, arena *Arena, u32 Capacity)
+{
+    *Bvh = {};
+    Bvh->Capacity = Capacity;
+    Bvh->Nodes    = PushArray(Arena, bvh_node, Max(1u, Capacity)); // at most Capacity - 1 nodes
+    Bvh->Indices  = PushArray(Arena, u32, Capacity);
+}
+
+inline void BvhSetChild(bvh_node *Node, u32 Slot, const aabb &Box, u32 Child, u32 First, u32 Count)
+{
+    Node->Min[0][Slot] = Box.Min.x;
+    Node->Min[1][Slot] = Box.Min.y;
+    Node->Min[2][Slot] = Box.Min.z;
+    Node->Max[0][Slot] = Box.Max.x;
+    Node->Max[1][Slot] = Box.Max.y;
+    Node->Max[2][Slot] = Box.Max.z;
+    Node->Child[Slot]  = Child;
+    Node->First[Slot]  = First;
+    Node->Count[Slot]  = Count;
+}
+
+internal aabb BvhRangeBounds(bvh_builder *Builder, u32 First, u32 Count)
+{
+    aabb Res = AabbEmpty();
+    for (u32 i = First; i < First + Count; ++i) {
+        AabbGrow(&Res, Builder->Boxes[Builder->Indices[i]]);
+    }
+    return Res;
+}
+
+// Splits Indices[First, First + Count) in two, returns the size of the first part (never 0 or Count)
+internal u32 BvhSplit(bvh_builder *Builder, u32 First, u32 Count, u32 Depth)
+{
+    Assert(Count >= 2);
+    u32 *Indices = Builder->Indices;
+    
+    aabb Centroids = AabbEmpty();
+    for (u32 i = First; i < First + Count; ++i)
+    {
+        vec3 c = Builder->Centroids[Indices[i]];
+        aabb Point = {c, c};
+        AabbGrow(&Centroids, Point);
+    }
+    
+    vec3 Extent = Centroids.Max - Centroids.Min;
+    if (Count == 2 || Depth >= BVH_MAX_DEPTH || (Extent.x <= 0.0f && Extent.y <= 0.0f && Extent.z <= 0.0f)) {
+        return Count / 2;
+    }
+    
+    // bin the objects by centroid along the 3 axes at once
+    f32 Scale[3] = {
+        Extent.x > 0.0f ? BVH_BINS * 0.9999f / Extent.x : 0.0f,
+        Extent.y > 0.0f ? BVH_BINS * 0.9999f / Extent.y : 0.0f,
+        Extent.z > 0.0f ? BVH_BINS * 0.9999f / Extent.z : 0.0f,
+    };
+    
+    aabb BinBounds[3][BVH_BINS];
+    u32  BinCounts[3][BVH_BINS] = {};
+    for (u32 Axis = 0; Axis < 3; ++Axis)
+    {
+        for (u32 b = 0; b < BVH_BINS; ++b) {
+            BinBounds[Axis][b] = AabbEmpty();
+        }
+    }
+    
+    for (u32 i = First; i < First + Count; ++i)
+    {
+        u32  Index = Indices[i];
+        vec3 c     = Builder->Centroids[Index];
+        u32  Bins[3] = {
+            (u32)((c.x - Centroids.Min.x) * Scale[0]),
+            (u32)((c.y - Centroids.Min.y) * Scale[1]),
+            (u32)((c.z - Centroids.Min.z) * Scale[2]),
+        };
+        for (u32 Axis = 0; Axis < 3; ++Axis)
+        {
+            AabbGrow(&BinBounds[Axis][Bins[Axis]], Builder->Boxes[Index]);
+            ++BinCounts[Axis][Bins[Axis]];
+        }
+    }
+    
+    // cost of splitting after bin b: area * count of both sides
+    f32 BestCost = F32_MAX;
+    u32 BestAxis = 0;
+    u32 BestBin  = 0;
+    for (u32 Axis = 0; Axis < 3; ++Axis)
+    {
+        if (Scale[Axis] == 0.0f) {
+            continue;
+        }
+        
+        f32  RightCost[BVH_BINS];
+        aabb Right      = AabbEmpty();
+        u32  RightCount = 0;
+        for (u32 b = BVH_BINS - 1; b > 0; --b)
+        {
+            AabbGrow(&Right, BinBounds[Axis][b]);
+            RightCount  += BinCounts[Axis][b];
+            RightCost[b] = RightCount ? AabbHalfArea(Right) * RightCount : 0.0f;
+        }
+        
+        aabb Left      = AabbEmpty();
+        u32  LeftCount = 0;
+        for (u32 b = 0; b < BVH_BINS - 1; ++b)
+        {
+            AabbGrow(&Left, BinBounds[Axis][b]);
+            LeftCount += BinCounts[Axis][b];
+            if (LeftCount == 0 || LeftCount == Count) {
+                continue;
+            }
+            
+            f32 Cost = AabbHalfArea(Left) * LeftCount + RightCost[b + 1];
+            if (Cost < BestCost)
+            {
+                BestCost = Cost;
+                BestAxis = Axis;
+                BestBin  = b;
+            }
+        }
+    }
+    
+    if (BestCost == F32_MAX) {
+        return Count / 2;
+    }
+    
+    // partition, the objects in bins [0, BestBin] first
+    f32 AxisMin = BestAxis == 0 ? Centroids.Min.x : BestAxis == 1 ? Centroids.Min.y : Centroids.Min.z;
+    u32 i = First;
+    u32 j = First + Count;
+    while (i < j)
+    {
+        vec3 c = Builder->Centroids[Indices[i]];
+        f32  Value = BestAxis == 0 ? c.x : BestAxis == 1 ? c.y : c.z;
+        if ((u32)((Value - AxisMin) * Scale[BestAxis]) <= BestBin)
+        {
+            ++i;
+        }
+        else
+        {
+            u32 Swap = Indices[i];
+            Indices[i] = Indices[--j];
+            Indices[j] = Swap;
+        }
+    }
+    
+    Assert(i > First && i < First + Count);
+    return i - First;
+}
+
+// Node for Indices[First, First + Count), Count >= 2, returns its index
+internal u32 BvhBuildNode(bvh_builder *Builder, u32 First, u32 Count, u32 Depth)
+{
+    Assert(Count >= 2 && Builder->NodeCount < Builder->NodeCapacity);
+    u32       NodeIndex = Builder->NodeCount++;
+    bvh_node *Node      = Builder->Nodes + NodeIndex;
+    
+    // up to 4 ranges, splitting the biggest one each time (they stay in Indices order)
+    u32 RangeFirst[4] = {First};
+    u32 RangeCount[4] = {Count};
+    u32 Ranges        = 1;
+    
+    if (Count <= 4)
+    {
+        for (u32 i = 0; i < Count; ++i)
+        {
+            RangeFirst[i] = First + i;
+            RangeCount[i] = 1;
+        }
+        Ranges = Count;
+    }
+    else
+    {
+        while (Ranges < 4)
+        {
+            u32 Biggest = 0;
+            for (u32 r = 1; r < Ranges; ++r)
+            {
+                if (RangeCount[r] > RangeCount[Biggest]) {
+                    Biggest = r;
+                }
+            }
+            
+            u32 Left = BvhSplit(Builder, RangeFirst[Biggest], RangeCount[Biggest], Depth);
+            for (u32 r = Ranges; r > Biggest + 1; --r)
+            {
+                RangeFirst[r] = RangeFirst[r - 1];
+                RangeCount[r] = RangeCount[r - 1];
+            }
+            RangeFirst[Biggest + 1] = RangeFirst[Biggest] + Left;
+            RangeCount[Biggest + 1] = RangeCount[Biggest] - Left;
+            RangeCount[Biggest]     = Left;
+            ++Ranges;
+        }
+    }
+    
+    for (u32 Slot = 0; Slot < 4; ++Slot) {
+        BvhSetChild(Node, Slot, AabbEmpty(), BVH_EMPTY, 0, 0);
+    }
+    
+    for (u32 Slot = 0; Slot < Ranges; ++Slot)
+    {
+        u32 SlotFirst = RangeFirst[Slot];
+        u32 SlotCount = RangeCount[Slot];
+        
+        if (SlotCount == 1)
+        {
+            u32 Object = Builder->Indices[SlotFirst];
+            BvhSetChild(Node, Slot, Builder->Boxes[Object], BVH_OBJECT | Object, SlotFirst, 1);
+        }
+        else if (Builder->Jobs && SlotCount <= BVH_JOB_OBJECTS && SlotCount >= BVH_MIN_JOB_OBJECTS &&
+                 Builder->JobCount < BVH_MAX_JOBS)
+        {
+            // the child is set up once the job is done
+            bvh_build_job *Job = Builder->Jobs + Builder->JobCount++;
+            *Job = {};
+            Job->Boxes     = Builder->Boxes;
+            Job->Centroids = Builder->Centroids;
+            Job->Indices   = Builder->Indices;
+            Job->First     = SlotFirst;
+            Job->Count     = SlotCount;
+            Job->Depth     = Depth + 1;
+            Job->Parent    = NodeIndex;
+            Job->Slot      = Slot;
+            BvhSetChild(Node, Slot, BvhRangeBounds(Builder, SlotFirst, SlotCount), BVH_EMPTY, SlotFirst, SlotCount);
+        }
+        else
+        {
+            u32 Child = BvhBuildNode(Builder, SlotFirst, SlotCount, Depth + 1);
+            BvhSetChild(Node, Slot, BvhRangeBounds(Builder, SlotFirst, SlotCount), Child, SlotFirst, SlotCount);
+        }
+    }
+    
+    return NodeIndex;
+}
+
+internal void BvhBuildJob(void *Data)
+{
+    bvh_build_job *Job = (bvh_build_job*)Data;
+    
+    bvh_builder Builder = {};
+    Builder.Boxes        = Job->Boxes;
+    Builder.Centroids    = Job->Centroids;
+    Builder.Indices      = Job->Indices;
+    Builder.Nodes        = Job->Nodes;
+    Builder.NodeCapacity = Job->Count - 1;
+    
+    BvhBuildNode(&Builder, Job->First, Job->Count, Job->Depth);
+    Job->NodeCount = Builder.NodeCount;
+}
+
+// Rebuilds the tree over Boxes[0...Count), Scratch holds the temporary data until it returns
+internal void BvhBuild(bvh *Bvh, const aabb *Boxes, u32 Count, arena *Scratch)
+{
+    Assert(Count <= Bvh->Capacity);
+    Bvh->Count     = Count;
+    Bvh->NodeCount = 0;
+    if (Count == 0) {
+        return;
+    }
+    
+    vec3 *Centroids = PushArray(Scratch, vec3, Count);
+    for (u32 i = 0; i < Count; ++i)
+    {
+        Bvh->Indices[i] = i;
+        Centroids[i]    = (Boxes[i].Min + Boxes[i].Max) * 0.5f;
+    }
+    
+    if (Count == 1)
+    {
+        // a root with a single object
+        Bvh->NodeCount = 1;
+        for (u32 Slot = 0; Slot < 4; ++Slot) {
+            BvhSetChild(Bvh->Nodes, Slot, AabbEmpty(), BVH_EMPTY, 0, 0);
+        }
+        BvhSetChild(Bvh->Nodes, 0, Boxes[0], BVH_OBJECT | 0, 0, 1);
+        return;
+    }
+    
+    bvh_builder Builder = {};
+    Builder.Boxes        = Boxes;
+    Builder.Centroids    = Centroids;
+    Builder.Indices      = Bvh->Indices;
+    Builder.Nodes        = Bvh->Nodes;
+    Builder.NodeCapacity = Max(1u, Bvh->Capacity - 1);
+    Builder.Jobs         = PushArray(Scratch, bvh_build_job, BVH_MAX_JOBS);
+    
+    BvhBuildNode(&Builder, 0, Count, 0);
+    
+    if (Builder.JobCount)
+    {
+        // every subtree of N objects has N - 1 nodes at most
+        u32 NodeTotal = 0;
+        for (u32 i = 0; i < Builder.JobCount; ++i) {
+            NodeTotal += Builder.Jobs[i].Count - 1;
+        }
+        bvh_node *JobNodes = PushArray(Scratch, bvh_node, NodeTotal);
+        for (u32 i = 0; i < Builder.JobCount; ++i)
+        {
+            Builder.Jobs[i].Nodes = JobNodes;
+            JobNodes += Builder.Jobs[i].Count - 1;
+        }
+        
+        job_counter Counter = {};
+        JobRunMany(BvhBuildJob, Builder.Jobs, sizeof(bvh_build_job), Builder.JobCount, &Counter);
+        JobWait(&Counter);
+        
+        // append the subtrees after the top of the tree, in order
+        for (u32 i = 0; i < Builder.JobCount; ++i)
+        {
+            bvh_build_job *Job    = Builder.Jobs + i;
+            u32            Offset = Builder.NodeCount;
+            Assert(Offset + Job->NodeCount <= Builder.NodeCapacity);
+            
+            memcpy(Bvh->Nodes + Offset, Job->Nodes, Job->NodeCount * sizeof(bvh_node));
+            for (u32 n = Offset; n < Offset + Job->NodeCount; ++n)
+            {
+                for (u32 Slot = 0; Slot < 4; ++Slot)
+                {
+                    u32 *Child = Bvh->Nodes[n].Child + Slot;
+                    if (*Child != BVH_EMPTY && !(*Child & BVH_OBJECT)) {
+                        *Child += Offset;
+                    }
+                }
+            }
+            
+            Bvh->Nodes[Job->Parent].Child[Job->Slot] = Offset;
+            Builder.NodeCount += Job->NodeCount;
+        }
+    }
+    
+    Bvh->NodeCount = Builder.NodeCount;
+}
+
+// Updates the bounds after the objects moved, same tree. Boxes as in BvhBuild.
+internal void BvhRefit(bvh *Bvh, const aabb *Boxes)
+{
+    for (u32 n = Bvh->NodeCount; n-- > 0;)
+    {
+        bvh_node *Node = Bvh->Nodes + n;
+        for (u32 Slot = 0; Slot < 4; ++Slot)
+        {
+            u32 Child = Node->Child[Slot];
+            if (Child == BVH_EMPTY) {
+                continue;
+            }
+            
+            aabb Box;
+            if (Child & BVH_OBJECT)
+            {
+                Box = Boxes[Child & ~BVH_OBJECT];
+            }
+            else
+            {
+                // children come after their parents, already refitted. The empty bounds of the
+                // unused children do not change the min and max.
+                bvh_node *ChildNode = Bvh->Nodes + Child;
+                f32 Bounds[6];
+                for (u32 Axis = 0; Axis < 3; ++Axis)
+                {
+                    f32 *ChildMin = ChildNode->Min[Axis];
+                    f32 *ChildMax = ChildNode->Max[Axis];
+                    Bounds[Axis]     = Min(Min(ChildMin[0], ChildMin[1]), Min(ChildMin[2], ChildMin[3]));
+                    Bounds[Axis + 3] = Max(Max(ChildMax[0], ChildMax[1]), Max(ChildMax[2], ChildMax[3]));
+                }
+                Box.Min = V3(Bounds[0], Bounds[1], Bounds[2]);
+                Box.Max = V3(Bounds[3], Bounds[4], Bounds[5]);
+            }
+            
+            BvhSetChild(Node, Slot, Box, Child, Node->First[Slot], Node->Count[Slot]);
+        }
+    }
+}
+
+// Planes of a frustum broadcast for the node tests. Per plane, the corner furthest along the normal
+// (Far) decides if a box touches the inside, the nearest one if the box is completely inside.
+internal bvh_frustum BvhFrustum(const frustum *Frustum)
+{
+    bvh_frustum Res;
+    for (u32 p = 0; p < 6; ++p)
+    {
+        for (u32 i = 0; i < 4; ++i) {
+            Res.Planes[p][i] = F32x4Set1(Frustum->Planes[p][i]);
+        }
+        for (u32 Axis = 0; Axis < 3; ++Axis) {
+            Res.FarIsMax[p][Axis] = Frustum->Planes[p][Axis] >= 0.0f;
+        }
+    }
+    return Res;
+}
+
+// Bit per child of the node: touching the frustum, completely inside it
+inline void BvhFrustumTest(const bvh_frustum *Frustum, const bvh_node *Node, u32 *TouchMask, u32 *InsideMask)
+{
+    f32x4 Touches = F32x4CmpGE(F32x4Zero(), F32x4Zero()); // all set
+    f32x4 Inside  = Touches;
+    for (u32 p = 0; p < 6; ++p)
+    {
+        f32x4 Far  = Frustum->Planes[p][3];
+        f32x4 Near = Frustum->Planes[p][3];
+        for (u32 Axis = 0; Axis < 3; ++Axis)
+        {
+            f32x4 BoxMin = F32x4Load(Node->Min[Axis]);
+            f32x4 BoxMax = F32x4Load(Node->Max[Axis]);
+            b32   IsMax  = Frustum->FarIsMax[p][Axis];
+            Far  = F32x4MulAdd(Frustum->Planes[p][Axis], IsMax ? BoxMax : BoxMin, Far);
+            Near = F32x4MulAdd(Frustum->Planes[p][Axis], IsMax ? BoxMin : BoxMax, Near);
+        }
+        Touches = F32x4And(Touches, F32x4CmpGE(Far,  F32x4Zero()));
+        Inside  = F32x4And(Inside,  F32x4CmpGE(Near, F32x4Zero()));
+    }
+    
+    *TouchMask  = F32x4MoveMask(Touches);
+    *InsideMask = F32x4MoveMask(Inside);
+}
+
+// Objects under Root whose boxes touch the frustum to Visible, returns how many
+internal u32 BvhQueryFrustumNode(const bvh *Bvh, const bvh_frustum *Frustum, u32 Root, u32 *Visible)
+{
+    u32 VisibleCount = 0;
+    u32 Stack[BVH_STACK_SIZE];
+    u32 StackCount = 0;
+    Stack[StackCount++] = Root;
+    
+    while (StackCount)
+    {
+        const bvh_node *Node = Bvh->Nodes + Stack[--StackCount];
+        
+        u32 TouchMask, InsideMask;
+        BvhFrustumTest(Frustum, Node, &TouchMask, &InsideMask);
+        for (u32 Slot = 0; Slot < 4; ++Slot)
+        {
+            if (!(TouchMask & (1 << Slot))) {
+                continue;
+            }
+            
+            u32 Child = Node->Child[Slot];
+            if (Child & BVH_OBJECT)
+            {
+                Visible[VisibleCount++] = Child & ~BVH_OBJECT;
+            }
+            else if (InsideMask & (1 << Slot))
+            {
+                memcpy(Visible + VisibleCount, Bvh->Indices + Node->First[Slot], Node->Count[Slot] * sizeof(u32));
+                VisibleCount += Node->Count[Slot];
+            }
+            else
+            {
+                Assert(StackCount < BVH_STACK_SIZE);
+                Stack[StackCount++] = Child;
+            }
+        }
+    }
+    
+    return VisibleCount;
+}
+
+// Objects whose boxes touch the frustum to Visible (which has to hold Bvh->Count entries), returns
+// how many. The test is conservative: a box outside the frustum but crossing two
+// planes near a corner can still be reported as visible.
+internal u32 BvhQueryFrustum(const bvh *Bvh, const frustum *Frustum, u32 *Visible)
+{
+    if (Bvh->NodeCount == 0) {
+        return 0;
+    }
+    
+    bvh_frustum Planes = BvhFrustum(Frustum);
+    return BvhQueryFrustumNode(Bvh, &Planes, 0, Visible);
+}
+
+internal void BvhQueryJob(void *Data)
+{
+    bvh_query_job *Job = (bvh_query_job*)Data;
+    u32 *Visible = Job->Visible + Job->First;
+    
+    if (Job->Node == BVH_EMPTY)
+    {
+        memcpy(Visible, Job->Bvh->Indices + Job->First, Job->Count * sizeof(u32));
+        Job->VisibleCount = Job->Count;
+    }
+    else
+    {
+        Job->VisibleCount = BvhQueryFrustumNode(Job->Bvh, Job->Frustum, Job->Node, Visible);
+    }
+}
+
+// Same as BvhQueryFrustum, split across the job system. The top of the tree is tested on the calling
+// thread down to subtrees of BVH_QUERY_JOB_OBJECTS, which are queried as jobs. Arena holds the job
+// data. The subtrees come in Indices order, so the order differs from BvhQueryFrustum but does not
+// depend on the scheduling.
+internal u32 BvhQueryFrustumParallel(const bvh *Bvh, const frustum *Frustum, u32 *Visible, arena *Arena)
+{
+    if (Bvh->Count <= BVH_QUERY_JOB_OBJECTS) {
+        return BvhQueryFrustum(Bvh, Frustum, Visible);
+    }
+    
+    bvh_frustum    Planes   = BvhFrustum(Frustum);
+    bvh_query_job* Jobs     = PushArray(Arena, bvh_query_job, BVH_MAX_QUERY_JOBS);
+    u32            JobCount = 0;
+    
+    // NOTE(jdiaz): Every node on the stack can still add 4 jobs, a node is only pushed while that
+    // leaves room for them, the bigger subtrees past that are queried by a single job
+    u32 Stack[BVH_STACK_SIZE];
+    u32 StackCount = 0;
+    Stack[StackCount++] = 0;
+    
+    while (StackCount)
+    {
+        const bvh_node *Node = Bvh->Nodes + Stack[--StackCount];
+        
+        u32 TouchMask, InsideMask;
+        BvhFrustumTest(&Planes, Node, &TouchMask, &InsideMask);
+        for (u32 Slot = 0; Slot < 4; ++Slot)
+        {
+            if (!(TouchMask & (1 << Slot))) {
+                continue;
+            }
+            
+            u32 Child  = Node->Child[Slot];
+            b32 Inside = (Child & BVH_OBJECT) || (InsideMask & (1 << Slot));
+            if (!Inside && Node->Count[Slot] > BVH_QUERY_JOB_OBJECTS &&
+                JobCount + 4 * (StackCount + 2) <= BVH_MAX_QUERY_JOBS)
+            {
+                Assert(StackCount < BVH_STACK_SIZE);
+                Stack[StackCount++] = Child;
+                continue;
+            }
+            
+            // a whole range, copied by the job, or a subtree
+            Assert(JobCount < BVH_MAX_QUERY_JOBS);
+            bvh_query_job *Job = Jobs + JobCount++;
+            *Job = {};
+            Job->Bvh     = Bvh;
+            Job->Frustum = &Planes;
+            Job->Node    = Inside ? BVH_EMPTY : Child;
+            Job->First   = Node->First[Slot];
+            Job->Count   = Node->Count[Slot];
+            Job->Visible = Visible;
+        }
+    }
+    
+    job_counter Counter = {};
+    JobRunMany(BvhQueryJob, Jobs, sizeof(bvh_query_job), JobCount, &Counter);
+    JobWait(&Counter);
+    
+    // the ranges do not overlap, sorted by First the packing only moves results down
+    for (u32 i = 1; i < JobCount; ++i)
+    {
+        bvh_query_job Job = Jobs[i];
+        u32 j = i;
+        for (; j > 0 && Jobs[j - 1].First > Job.First; --j) {
+            Jobs[j] = Jobs[j - 1];
+        }
+        Jobs[j] = Job;
+    }
+    
+    u32 VisibleCount = 0;
+    for (u32 i = 0; i < JobCount; ++i)
+    {
+        bvh_query_job *Job = Jobs + i;
+        Assert(VisibleCount <= Job->First);
+        memmove(Visible + VisibleCount, Visible + Job->First, Job->VisibleCount * sizeof(u32));
+        VisibleCount += Job->VisibleCount;
+    }
+    
+    return VisibleCount;
+}
+
+// Pushes the hit children of a node nearest last (popped first), Keys are the distances
+inline u32 BvhPushSorted(u32 *Stack, f32 *StackKeys, u32 StackCount, const bvh_node *Node, u32 Mask, const f32 *Keys)
+{
+    u32 First = StackCount;
+    for (u32 Slot = 0; Slot < 4; ++Slot)
+    {
+        if (!(Mask & (1 << Slot))) {
+            continue;
+        }
+        
+        Assert(StackCount < BVH_STACK_SIZE);
+        u32 i = StackCount++;
+        for (; i > First && StackKeys[i - 1] < Keys[Slot]; --i)
+        {
+            Stack[i]     = Stack[i - 1];
+            StackKeys[i] = StackKeys[i - 1];
+        }
+        Stack[i]     = Node->Child[Slot];
+        StackKeys[i] = Keys[Slot];
+    }
+    return StackCount;
+}
+
+// Nearest object whose box the ray Origin + t * Direction hits with t in [0, MaxT], BVH_EMPTY when
+// there is none. *HitT is where it enters the box (0 inside it). The test is against the boxes only,
+// pickers that need the exact geometry test it on the result.
+internal u32 BvhRayCast(const bvh *Bvh, const vec3 &Origin, const vec3 &Direction, f32 MaxT, f32 *HitT)
+{
+    u32 Hit  = BVH_EMPTY;
+    f32 Best = MaxT;
+    if (Bvh->NodeCount == 0) {
+        return Hit;
+    }
+    
+    // the near planes of the slabs are the Min side where the direction is positive
+    f32 Dir[3]    = {Direction.x, Direction.y, Direction.z};
+    f32 Start[3]  = {Origin.x, Origin.y, Origin.z};
+    f32x4 InvDir[3];
+    f32x4 Org[3];
+    b32   NearIsMin[3];
+    for (u32 Axis = 0; Axis < 3; ++Axis)
+    {
+        f32 d = Dir[Axis];
+        if (d > -1e-20f && d < 1e-20f) {
+            d = d < 0.0f ? -1e-20f : 1e-20f;
+        }
+        InvDir[Axis]    = F32x4Set1(1.0f / d);
+        Org[Axis]       = F32x4Set1(Start[Axis]);
+        NearIsMin[Axis] = d > 0.0f;
+    }
+    
+    u32 Stack[BVH_STACK_SIZE];
+    f32 StackT[BVH_STACK_SIZE];
+    u32 StackCount = 0;
+    Stack[StackCount]    = 0;
+    StackT[StackCount++] = 0.0f;
+    
+    while (StackCount)
+    {
+        --StackCount;
+        if (StackT[StackCount] > Best) {
+            continue;
+        }
+        const bvh_node *Node = Bvh->Nodes + Stack[StackCount];
+        
+        f32x4 TNear = F32x4Zero();
+        f32x4 TFar  = F32x4Set1(Best);
+        for (u32 Axis = 0; Axis < 3; ++Axis)
+        {
+            f32x4 BoxMin = F32x4Load(Node->Min[Axis]);
+            f32x4 BoxMax = F32x4Load(Node->Max[Axis]);
+            f32x4 t0 = F32x4Mul(F32x4Sub(NearIsMin[Axis] ? BoxMin : BoxMax, Org[Axis]), InvDir[Axis]);
+            f32x4 t1 = F32x4Mul(F32x4Sub(NearIsMin[Axis] ? BoxMax : BoxMin, Org[Axis]), InvDir[Axis]);
+            TNear = F32x4Max(TNear, t0);
+            TFar  = F32x4Min(TFar,  t1);
+        }
+        
+        u32 Mask = F32x4MoveMask(F32x4CmpGE(TFar, TNear));
+        alignas(16) f32 Entry[4];
+        F32x4Store(Entry, TNear);
+        
+        for (u32 Slot = 0; Slot < 4; ++Slot)
+        {
+            u32 Child = Node->Child[Slot];
+            if ((Mask & (1 << Slot)) && (Child & BVH_OBJECT))
+            {
+                Mask &= ~(1 << Slot);
+                if (Entry[Slot] <= Best)
+                {
+                    Best = Entry[Slot];
+                    Hit  = Child & ~BVH_OBJECT;
+                }
+            }
+        }
+        
+        StackCount = BvhPushSorted(Stack, StackT, StackCount, Node, Mask, Entry);
+    }
+    
+    if (Hit != BVH_EMPTY) {
+        *HitT = Best;
+    }
+    return Hit;
+}
+
+// Object with the box nearest to Point (distance 0 inside it) within MaxDistance, BVH_EMPTY when
+// there is none
+internal u32 BvhNearest(const bvh *Bvh, const vec3 &Point, f32 MaxDistance, f32 *Distance)
+{
+    u32 Nearest = BVH_EMPTY;
+    f32 Best    = Min(MaxDistance * MaxDistance, F32_MAX); // squared from here on, empty children are further
+    if (Bvh->NodeCount == 0) {
+        return Nearest;
+    }
+    
+    f32x4 P[3] = {F32x4Set1(Point.x), F32x4Set1(Point.y), F32x4Set1(Point.z)};
+    
+    u32 Stack[BVH_STACK_SIZE];
+    f32 StackDistance[BVH_STACK_SIZE];
+    u32 StackCount = 0;
+    Stack[StackCount]           = 0;
+    StackDistance[StackCount++] = 0.0f;
+    
+    while (StackCount)
+    {
+        --StackCount;
+        if (StackDistance[StackCount] > Best) {
+            continue;
+        }
+        const bvh_node *Node = Bvh->Nodes + Stack[StackCount];
+        
+        // per axis, how far the point is outside the box (0 between the sides)
+        f32x4 Squared = F32x4Zero();
+        for (u32 Axis = 0; Axis < 3; ++Axis)
+        {
+            f32x4 Below   = F32x4Sub(F32x4Load(Node->Min[Axis]), P[Axis]);
+            f32x4 Above   = F32x4Sub(P[Axis], F32x4Load(Node->Max[Axis]));
+            f32x4 Outside = F32x4Max(F32x4Max(Below, Above), F32x4Zero());
+            Squared = F32x4MulAdd(Outside, Outside, Squared);
+        }
+        
+        u32 Mask = F32x4MoveMask(F32x4CmpGE(F32x4Set1(Best), Squared));
+        alignas(16) f32 Keys[4];
+        F32x4Store(Keys, Squared);
+        
+        for (u32 Slot = 0; Slot < 4; ++Slot)
+        {
+            u32 Child = Node->Child[Slot];
+            if ((Mask & (1 << Slot)) && (Child & BVH_OBJECT))
+            {
+                Mask &= ~(1 << Slot);
+                if (Keys[Slot] <= Best)
+                {
+                    Best    = Keys[Slot];
+                    Nearest = Child & ~BVH_OBJECT;
+                }
+            }
+        }
+        
+        StackCount = BvhPushSorted(Stack, StackDistance, StackCount, Node, Mask, Keys);
+    }
+    
+    if (Nearest != BVH_EMPTY) {
+        *Distance = Sqrtf(Best);
+    }
+    return Nearest;
+}
+
+#endif //BVH_H
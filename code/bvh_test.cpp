@@ -0,0 +1,422 @@
+// NOTE(jdiaz): Offline test of the BVH queries (see bvh.h) against brute force over the same boxes:
+// frustum (single threaded and on the job system), ray cast and nearest object, before and after
+// a refit, plus trees too small to have a node per job. The flat SoA culler (culling.h) is checked
+// on the same boxes and on their bounding spheres.
+// Usage: bvh_test [object count], returns 0 when everything matches.
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "platform.h"
+#include "engine_simd.h"
+#include "engine_math.h"
+#include "memory_accounting.h"
+#include "arena.h"
+
+// Platform ///////////////////////////////////////////////////////////////////////////////////////
+
+struct test_semaphore
+{
+    std::mutex              Mutex;
+    std::condition_variable Signal;
+    u32                     Count;
+};
+
+internal void* TestCreateSemaphore()
+{
+    test_semaphore *Semaphore = new test_semaphore;
+    Semaphore->Count = 0;
+    return Semaphore;
+}
+
+internal void TestWaitSemaphore(void *Data)
+{
+    test_semaphore *Semaphore = (test_semaphore*)Data;
+    std::unique_lock<std::mutex> Lock(Semaphore->Mutex);
+    Semaphore->Signal.wait(Lock, [Semaphore] { return Semaphore->Count > 0; });
+    --Semaphore->Count;
+}
+
+internal void TestSignalSemaphore(void *Data, u32 Count)
+{
+    test_semaphore *Semaphore = (test_semaphore*)Data;
+    {
+        std::lock_guard<std::mutex> Lock(Semaphore->Mutex);
+        Semaphore->Count += Count;
+    }
+    Semaphore->Signal.notify_all();
+}
+
+#define PlatformCreateSemaphore TestCreateSemaphore
+#define PlatformWaitSemaphore   TestWaitSemaphore
+#define PlatformSignalSemaphore TestSignalSemaphore
+
+// The test only uses growing arenas, no scratch memory
+u8*  ReserveThreadScratchMemory() { return 0; }
+void ReleaseThreadScratchMemory(u8* Base) {}
+void CommitScratchMemory(u8* Base, u64 Size) {}
+void DecommitScratchMemory(u8* Base, u64 Size) {}
+u8*  AllocateArenaBlock(u64 Size) { return (u8*)calloc(1, Size); }
+void FreeArenaBlock(u8* Base, u64 Size) { free(Base); }
+b32  WriteEntireFile(const char* Path, const void* Data, u64 Size) { return false; }
+
+#include "job_system.h"
+#include "culling.h"
+#include "bvh.h"
+
+#define TEST_WORKERS 4
+#define TEST_RAYS    1000
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal u32 TestRandomState = 12345;
+internal u32 TestFailures;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// [-1, 1)
+internal f32 TestRandom()
+{
+    TestRandomState = TestRandomState * 1664525 + 1013904223;
+    return (f32)(TestRandomState >> 8) / (f32)(1 << 23) - 1.0f;
+}
+
+internal void TestCheck(b32 Condition, const char *What)
+{
+    if (!Condition)
+    {
+        printf("FAILED: %s\n", What);
+        ++TestFailures;
+    }
+}
+
+internal b32 BruteFrustum(const frustum *Frustum, const aabb &Box)
+{
+    const f32 *BoxMin = &Box.Min.x;
+    const f32 *BoxMax = &Box.Max.x;
+    for (u32 p = 0; p < 6; ++p)
+    {
+        const f32 *Plane = Frustum->Planes[p];
+        f32 Far = Plane[3];
+        for (u32 Axis = 0; Axis < 3; ++Axis) {
+            Far += Plane[Axis] * (Plane[Axis] >= 0.0f ? BoxMax[Axis] : BoxMin[Axis]);
+        }
+        if (Far < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Entry t of the ray into the box, -1 when it misses
+internal f32 BruteRay(const aabb &Box, const vec3 &Origin, const vec3 &Direction, f32 MaxT)
+{
+    const f32 *BoxMin = &Box.Min.x;
+    const f32 *BoxMax = &Box.Max.x;
+    const f32 *Org    = &Origin.x;
+    const f32 *Dir    = &Direction.x;
+    f32 Enter = 0.0f;
+    f32 Leave = MaxT;
+    for (u32 Axis = 0; Axis < 3; ++Axis)
+    {
+        f32 InvDir = 1.0f / Dir[Axis];
+        f32 Near   = (BoxMin[Axis] - Org[Axis]) * InvDir;
+        f32 Far    = (BoxMax[Axis] - Org[Axis]) * InvDir;
+        Enter = Max(Enter, Min(Near, Far));
+        Leave = Min(Leave, Max(Near, Far));
+    }
+    return Enter <= Leave ? Enter : -1.0f;
+}
+
+internal f32 BruteDistance(const aabb &Box, const vec3 &Point)
+{
+    vec3 Outside = V3(Max(Max(Box.Min.x - Point.x, Point.x - Box.Max.x), 0.0f),
+                      Max(Max(Box.Min.y - Point.y, Point.y - Box.Max.y), 0.0f),
+                      Max(Max(Box.Min.z - Point.z, Point.z - Box.Max.z), 0.0f));
+    return Sqrtf(Outside.x * Outside.x + Outside.y * Outside.y + Outside.z * Outside.z);
+}
+
+// Visible has every object that touches the frustum once, in any order
+internal b32 SameObjects(u32 *Visible, u32 VisibleCount, const aabb *Boxes, u32 Count, const frustum *Frustum, u8 *Seen)
+{
+    memset(Seen, 0, Count);
+    for (u32 i = 0; i < VisibleCount; ++i)
+    {
+        if (Visible[i] >= Count || Seen[Visible[i]]) {
+            return false;
+        }
+        Seen[Visible[i]] = 1;
+    }
+    
+    u32 Expected = 0;
+    for (u32 i = 0; i < Count; ++i)
+    {
+        b32 Inside = BruteFrustum(Frustum, Boxes[i]);
+        if (Inside != (b32)Seen[i]) {
+            return false;
+        }
+        Expected += Inside;
+    }
+    return Expected == VisibleCount;
+}
+
+internal void TestFrustum(bvh *Bvh, const aabb *Boxes, u32 Count, const frustum *Frustum, arena *Arena, const char *What)
+{
+    temp_memory Temp = BeginTempMemory(Arena);
+    u32 *Visible = PushArray(Arena, u32, Count);
+    u8  *Seen    = PushArray(Arena, u8, Count);
+    
+    char Name[128];
+    u32 VisibleCount = BvhQueryFrustum(Bvh, Frustum, Visible);
+    snprintf(Name, sizeof(Name), "%s: frustum, %u objects of %u", What, VisibleCount, Count);
+    TestCheck(SameObjects(Visible, VisibleCount, Boxes, Count, Frustum, Seen), Name);
+    
+    // in another order, which has to be the same every time
+    u32 *Parallel      = PushArray(Arena, u32, Count);
+    u32  ParallelCount = BvhQueryFrustumParallel(Bvh, Frustum, Parallel, Arena);
+    snprintf(Name, sizeof(Name), "%s: parallel frustum, %u objects of %u", What, ParallelCount, Count);
+    TestCheck(SameObjects(Parallel, ParallelCount, Boxes, Count, Frustum, Seen), Name);
+    
+    u32 RepeatCount = BvhQueryFrustumParallel(Bvh, Frustum, Visible, Arena);
+    snprintf(Name, sizeof(Name), "%s: parallel frustum, same order twice", What);
+    TestCheck(RepeatCount == ParallelCount && memcmp(Parallel, Visible, ParallelCount * sizeof(u32)) == 0, Name);
+    
+    EndTempMemory(Temp);
+}
+
+internal void TestRaysAndNearest(bvh *Bvh, const aabb *Boxes, u32 Count, const char *What)
+{
+    u32 RayFailures     = 0;
+    u32 NearestFailures = 0;
+    for (u32 i = 0; i < TEST_RAYS; ++i)
+    {
+        vec3 Origin    = V3(TestRandom() * 60.0f, TestRandom() * 60.0f, TestRandom() * 10.0f);
+        vec3 Direction = (i % 5) ? V3(TestRandom(), TestRandom(), TestRandom()) : V3(0.0f, 0.0f, -1.0f);
+        
+        f32 HitT = -1.0f;
+        u32 Hit  = BvhRayCast(Bvh, Origin, Direction, 1000.0f, &HitT);
+        f32 Best = F32_MAX;
+        for (u32 b = 0; b < Count; ++b)
+        {
+            f32 t = BruteRay(Boxes[b], Origin, Direction, 1000.0f);
+            if (t >= 0.0f && t < Best) {
+                Best = t;
+            }
+        }
+        // ties between boxes can pick either object, the distance has to match
+        if ((Hit == BVH_EMPTY) != (Best == F32_MAX) ||
+            (Hit != BVH_EMPTY && fabsf(HitT - Best) > 1e-3f * (1.0f + Best))) {
+            ++RayFailures;
+        }
+        
+        vec3 Point    = V3(TestRandom() * 70.0f, TestRandom() * 70.0f, TestRandom() * 20.0f);
+        f32  Distance = -1.0f;
+        u32  Nearest  = BvhNearest(Bvh, Point, F32_MAX, &Distance);
+        f32  BestDistance = F32_MAX;
+        for (u32 b = 0; b < Count; ++b) {
+            BestDistance = Min(BestDistance, BruteDistance(Boxes[b], Point));
+        }
+        if ((Nearest == BVH_EMPTY) != (Count == 0) ||
+            (Nearest != BVH_EMPTY && fabsf(Distance - BestDistance) > 1e-4f * (1.0f + BestDistance))) {
+            ++NearestFailures;
+        }
+    }
+    
+    char Name[128];
+    snprintf(Name, sizeof(Name), "%s: ray cast, %u of %u rays differ", What, RayFailures, TEST_RAYS);
+    TestCheck(RayFailures == 0, Name);
+    snprintf(Name, sizeof(Name), "%s: nearest, %u of %u points differ", What, NearestFailures, TEST_RAYS);
+    TestCheck(NearestFailures == 0, Name);
+}
+
+// Every object exactly once in the leaves, children after their parents
+internal void TestStructure(bvh *Bvh, u32 Count, arena *Arena)
+{
+    temp_memory Temp = BeginTempMemory(Arena);
+    u8 *Seen = PushArray(Arena, u8, Count);
+    memset(Seen, 0, Count);
+    
+    b32 Valid = true;
+    for (u32 n = 0; n < Bvh->NodeCount; ++n)
+    {
+        for (u32 Slot = 0; Slot < 4; ++Slot)
+        {
+            u32 Child = Bvh->Nodes[n].Child[Slot];
+            if (Child == BVH_EMPTY) {
+                continue;
+            }
+            if (Child & BVH_OBJECT)
+            {
+                u32 Object = Child & ~BVH_OBJECT;
+                Valid = Valid && Object < Count && !Seen[Object];
+                if (Object < Count) {
+                    Seen[Object] = 1;
+                }
+            }
+            else
+            {
+                Valid = Valid && Child > n && Child < Bvh->NodeCount;
+            }
+        }
+    }
+    for (u32 i = 0; i < Count; ++i) {
+        Valid = Valid && Seen[i];
+    }
+    
+    TestCheck(Valid, "tree structure");
+    EndTempMemory(Temp);
+}
+
+// CullBoxesParallel / CullSpheresParallel, ascending indices of exactly the volumes brute force finds
+internal void TestFlatCulling(const aabb *Boxes, u32 Count, const frustum *Frustum, arena *Arena, const char *What)
+{
+    temp_memory Temp = BeginTempMemory(Arena);
+    
+    cull_boxes   CullBoxes   = {Count};
+    cull_spheres CullSpheres = {Count};
+    CullBoxes.CenterX   = CullSpheres.CenterX = PushArray(Arena, f32, Count);
+    CullBoxes.CenterY   = CullSpheres.CenterY = PushArray(Arena, f32, Count);
+    CullBoxes.CenterZ   = CullSpheres.CenterZ = PushArray(Arena, f32, Count);
+    CullBoxes.ExtentX   = PushArray(Arena, f32, Count);
+    CullBoxes.ExtentY   = PushArray(Arena, f32, Count);
+    CullBoxes.ExtentZ   = PushArray(Arena, f32, Count);
+    CullSpheres.Radius  = PushArray(Arena, f32, Count);
+    for (u32 i = 0; i < Count; ++i)
+    {
+        vec3 Center = (Boxes[i].Min + Boxes[i].Max) * 0.5f;
+        vec3 Extent = (Boxes[i].Max - Boxes[i].Min) * 0.5f;
+        CullBoxes.CenterX[i]  = Center.x;
+        CullBoxes.CenterY[i]  = Center.y;
+        CullBoxes.CenterZ[i]  = Center.z;
+        CullBoxes.ExtentX[i]  = Extent.x;
+        CullBoxes.ExtentY[i]  = Extent.y;
+        CullBoxes.ExtentZ[i]  = Extent.z;
+        CullSpheres.Radius[i] = Length(Extent);
+    }
+    
+    u32 *Visible = PushArray(Arena, u32, Count);
+    
+    u32 VisibleCount = CullBoxesParallel(Frustum, &CullBoxes, Visible, Arena);
+    b32 Valid        = true;
+    u32 Next         = 0;
+    for (u32 i = 0; i < Count; ++i)
+    {
+        aabb Box = {V3(CullBoxes.CenterX[i] - CullBoxes.ExtentX[i], CullBoxes.CenterY[i] - CullBoxes.ExtentY[i], CullBoxes.CenterZ[i] - CullBoxes.ExtentZ[i]),
+                    V3(CullBoxes.CenterX[i] + CullBoxes.ExtentX[i], CullBoxes.CenterY[i] + CullBoxes.ExtentY[i], CullBoxes.CenterZ[i] + CullBoxes.ExtentZ[i])};
+        if (BruteFrustum(Frustum, Box)) {
+            Valid = Valid && Next < VisibleCount && Visible[Next++] == i;
+        }
+    }
+    
+    char Name[128];
+    snprintf(Name, sizeof(Name), "%s: flat box culling, %u of %u", What, VisibleCount, Count);
+    TestCheck(Valid && Next == VisibleCount, Name);
+    
+    VisibleCount = CullSpheresParallel(Frustum, &CullSpheres, Visible, Arena);
+    Valid        = true;
+    Next         = 0;
+    for (u32 i = 0; i < Count; ++i)
+    {
+        b32 Inside = true;
+        for (u32 p = 0; p < 6; ++p)
+        {
+            const f32 *Plane = Frustum->Planes[p];
+            f32 Distance = Plane[0] * CullSpheres.CenterX[i] + Plane[1] * CullSpheres.CenterY[i] + Plane[2] * CullSpheres.CenterZ[i] + Plane[3];
+            Inside = Inside && Distance >= -CullSpheres.Radius[i];
+        }
+        if (Inside) {
+            Valid = Valid && Next < VisibleCount && Visible[Next++] == i;
+        }
+    }
+    
+    snprintf(Name, sizeof(Name), "%s: flat sphere culling, %u of %u", What, VisibleCount, Count);
+    TestCheck(Valid && Next == VisibleCount, Name);
+    
+    EndTempMemory(Temp);
+}
+
+internal void TestWorker(u32 WorkerIndex)
+{
+    JobWorkerMain(WorkerIndex);
+}
+
+int main(int ArgCount, char **Args)
+{
+    u32 Count = ArgCount > 1 ? (u32)atoi(Args[1]) : 100000;
+    
+    JobSystemInit(TEST_WORKERS);
+    std::thread Workers[TEST_WORKERS - 1];
+    for (u32 i = 1; i < TEST_WORKERS; ++i) {
+        Workers[i - 1] = std::thread(TestWorker, i);
+    }
+    
+    arena Arena   = MakeGrowingArena(MB(1));
+    arena Scratch = MakeGrowingArena(MB(1));
+    
+    // a flat scene with a pile of identical boxes, which no split can separate
+    aabb *Boxes = PushArray(&Arena, aabb, Count);
+    for (u32 i = 0; i < Count; ++i)
+    {
+        vec3 Center = (i % 7) ? V3(TestRandom() * 50.0f, TestRandom() * 50.0f, TestRandom() * 5.0f) : V3(1.0f);
+        vec3 Extent = V3(TestRandom() + 1.0f, TestRandom() + 1.0f, TestRandom() + 1.0f) * 0.3f;
+        Boxes[i] = {Center - Extent, Center + Extent};
+    }
+    
+    mat4 Projection = Perspective(Radians(45.0f), 1.33f, 0.1f, 40.0f);
+    Projection.data[1][1] *= -1.0f;
+    frustum Frustum = FrustumFromViewProj(Projection * LookAt(V3(10.0f, 3.0f, 20.0f), V3(0.0f), V3(0.0f, 1.0f, 0.0f)));
+    
+    bvh Bvh;
+    BvhInit(&Bvh, &Arena, Count);
+    BvhBuild(&Bvh, Boxes, Count, &Scratch);
+    ClearArena(&Scratch);
+    printf("%u objects, %u nodes\n", Count, Bvh.NodeCount);
+    
+    TestStructure(&Bvh, Count, &Scratch);
+    TestFrustum(&Bvh, Boxes, Count, &Frustum, &Scratch, "built");
+    TestRaysAndNearest(&Bvh, Boxes, Count, "built");
+    TestFlatCulling(Boxes, Count, &Frustum, &Scratch, "built");
+    
+    // the same tree has to give the same results for boxes that moved
+    for (u32 i = 0; i < Count; ++i)
+    {
+        vec3 Offset = V3(TestRandom(), TestRandom(), TestRandom());
+        Boxes[i] = {Boxes[i].Min + Offset, Boxes[i].Max + Offset};
+    }
+    BvhRefit(&Bvh, Boxes);
+    TestFrustum(&Bvh, Boxes, Count, &Frustum, &Scratch, "refitted");
+    TestRaysAndNearest(&Bvh, Boxes, Count, "refitted");
+    
+    // the build does not depend on the scheduling
+    BvhBuild(&Bvh, Boxes, Count, &Scratch);
+    u32  NodeCount = Bvh.NodeCount;
+    u32 *Indices   = PushArray(&Scratch, u32, Count);
+    memcpy(Indices, Bvh.Indices, Count * sizeof(u32));
+    BvhBuild(&Bvh, Boxes, Count, &Scratch);
+    TestCheck(Bvh.NodeCount == NodeCount && memcmp(Indices, Bvh.Indices, Count * sizeof(u32)) == 0, "deterministic build");
+    ClearArena(&Scratch);
+    
+    for (u32 SmallCount = 0; SmallCount < 20; ++SmallCount)
+    {
+        BvhBuild(&Bvh, Boxes, SmallCount, &Scratch);
+        ClearArena(&Scratch);
+        TestStructure(&Bvh, SmallCount, &Scratch);
+        TestFrustum(&Bvh, Boxes, SmallCount, &Frustum, &Scratch, "small");
+        TestFlatCulling(Boxes, SmallCount, &Frustum, &Scratch, "small");
+    }
+    
+    JobSystemShutdown();
+    for (u32 i = 1; i < TEST_WORKERS; ++i) {
+        Workers[i - 1].join();
+    }
+    
+    printf(TestFailures ? "%u checks failed\n" : "all checks passed\n", TestFailures);
+    return TestFailures ? 1 : 0;
+}
@@ -0,0 +1,297 @@
+/* date = October 18th 2026 0:50 am */
+
+#ifndef CULLING_H
+#define CULLING_H
+
+// NOTE(jdiaz): Frustum culling of bounding spheres and boxes kept in separate arrays per component,
+// 4 volumes per f32x4 against each of the 6 planes. The result is the compact, ascending list of
+// the indices of the volumes that touch the frustum (the test is conservative: a volume outside
+// the frustum but crossing two planes near a corner can still be reported as visible).
+//
+// CullSpheresParallel / CullBoxesParallel split the volumes into jobs of CULL_JOB_VOLUMES, every job
+// writes its visible indices at the start of its own range of the output and the ranges are packed
+// together once all the jobs are done, so the order does not depend on the scheduling.
+//
+// This is the flat path, every volume is tested. The renderer culls its objects through the BVH
+// (bvh.h), which skips whole subtrees outside the frustum.
+
+#define CULL_JOB_VOLUMES 8192 // multiple of 4
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+// Planes are (a, b, c, d) with the normal pointing inside, a point p is inside when
+// a*p.x + b*p.y + c*p.z + d >= 0. Normalized, so that is the distance to the plane.
+struct frustum
+{
+    f32 Planes[6][4]; // left, right, bottom, top, near, far
+};
+
+struct cull_spheres
+{
+    u32  Count;
+    f32* CenterX;
+    f32* CenterY;
+    f32* CenterZ;
+    f32* Radius;
+};
+
+struct cull_boxes
+{
+    u32  Count;
+    f32* CenterX;
+    f32* CenterY;
+    f32* CenterZ;
+    f32* ExtentX; // half sizes
+    f32* ExtentY;
+    f32* ExtentZ;
+};
+
+struct cull_job
+{
+    const frustum*      Frustum;
+    const cull_spheres* Spheres; // one of the two
+    const cull_boxes*   Boxes;
+    u32                 First;
+    u32                 Count;
+    u32*                Visible; // the whole output, the job writes from Visible + First
+    u32                 VisibleCount;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// Planes of the clip volume of ViewProj (Vulkan clip space: -w <= x, y <= w and 0 <= z <= w)
+internal frustum FrustumFromViewProj(const mat4 &ViewProj)
+{
+    f32 Rows[4][4];
+    for (u32 r = 0; r < 4; ++r)
+    {
+        for (u32 c = 0; c < 4; ++c) {
+            Rows[r][c] = ViewProj.data[c][r];
+        }
+    }
+    
+    frustum Res;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        Res.Planes[0][i] = Rows[3][i] + Rows[0][i];
+        Res.Planes[1][i] = Rows[3][i] - Rows[0][i];
+        Res.Planes[2][i] = Rows[3][i] + Rows[1][i];
+        Res.Planes[3][i] = Rows[3][i] - Rows[1][i];
+        Res.Planes[4][i] = Rows[2][i];
+        Res.Planes[5][i] = Rows[3][i] - Rows[2][i];
+    }
+    
+    for (u32 p = 0; p < 6; ++p)
+    {
+        f32 *Plane = Res.Planes[p];
+        f32 InvLength = 1.0f / Sqrtf(Plane[0]*Plane[0] + Plane[1]*Plane[1] + Plane[2]*Plane[2]);
+        for (u32 i = 0; i < 4; ++i) {
+            Plane[i] *= InvLength;
+        }
+    }
+    
+    return Res;
+}
+
+// Appends Index + i for every set bit i of Mask. Branchless, the 4 slots are written every time,
+// which is fine as the count never gets past Index: the writes stay at or before Index + 3.
+inline u32 CullAppend(u32 *Visible, u32 VisibleCount, u32 Index, u32 Mask)
+{
+    Visible[VisibleCount] = Index + 0; VisibleCount += (Mask >> 0) & 1;
+    Visible[VisibleCount] = Index + 1; VisibleCount += (Mask >> 1) & 1;
+    Visible[VisibleCount] = Index + 2; VisibleCount += (Mask >> 2) & 1;
+    Visible[VisibleCount] = Index + 3; VisibleCount += (Mask >> 3) & 1;
+    return VisibleCount;
+}
+
+// Spheres [First, First + Count), the visible indices go to Visible[0...Count), returns how many
+internal u32 CullSpheres(const frustum *Frustum, const cull_spheres *Spheres, u32 First, u32 Count, u32 *Visible)
+{
+    Assert(First + Count <= Spheres->Count);
+    
+    f32x4 Planes[6][4];
+    for (u32 p = 0; p < 6; ++p)
+    {
+        for (u32 i = 0; i < 4; ++i) {
+            Planes[p][i] = F32x4Set1(Frustum->Planes[p][i]);
+        }
+    }
+    
+    u32 VisibleCount = 0;
+    u32 End          = First + Count;
+    u32 Index        = First;
+    
+    for (; Index + 4 <= End; Index += 4)
+    {
+        f32x4 x = F32x4LoadU(Spheres->CenterX + Index);
+        f32x4 y = F32x4LoadU(Spheres->CenterY + Index);
+        f32x4 z = F32x4LoadU(Spheres->CenterZ + Index);
+        f32x4 MinusRadius = F32x4Sub(F32x4Zero(), F32x4LoadU(Spheres->Radius + Index));
+        
+        f32x4 Inside = F32x4CmpGE(F32x4Zero(), F32x4Zero()); // all set
+        for (u32 p = 0; p < 6; ++p)
+        {
+            f32x4 Distance = F32x4MulAdd(Planes[p][0], x, Planes[p][3]);
+            Distance = F32x4MulAdd(Planes[p][1], y, Distance);
+            Distance = F32x4MulAdd(Planes[p][2], z, Distance);
+            Inside   = F32x4And(Inside, F32x4CmpGE(Distance, MinusRadius));
+        }
+        
+        VisibleCount = CullAppend(Visible, VisibleCount, Index - First, F32x4MoveMask(Inside));
+    }
+    
+    for (; Index < End; ++Index)
+    {
+        b32 Inside = true;
+        for (u32 p = 0; p < 6; ++p)
+        {
+            const f32 *Plane = Frustum->Planes[p];
+            f32 Distance = Plane[0] * Spheres->CenterX[Index] + Plane[1] * Spheres->CenterY[Index] + Plane[2] * Spheres->CenterZ[Index] + Plane[3];
+            Inside = Inside && Distance >= -Spheres->Radius[Index];
+        }
+        Visible[VisibleCount] = Index - First;
+        VisibleCount += Inside;
+    }
+    
+    // Relative to First above so the appends stay inside the chunk, back to absolute indices
+    for (u32 i = 0; i < VisibleCount; ++i) {
+        Visible[i] += First;
+    }
+    return VisibleCount;
+}
+
+// Boxes [First, First + Count), same as CullSpheres. The box reaches |n.x|*ex + |n.y|*ey + |n.z|*ez
+// along the plane normal.
+internal u32 CullBoxes(const frustum *Frustum, const cull_boxes *Boxes, u32 First, u32 Count, u32 *Visible)
+{
+    Assert(First + Count <= Boxes->Count);
+    
+    f32x4 Planes[6][4];
+    f32x4 AbsNormals[6][3];
+    for (u32 p = 0; p < 6; ++p)
+    {
+        for (u32 i = 0; i < 4; ++i) {
+            Planes[p][i] = F32x4Set1(Frustum->Planes[p][i]);
+        }
+        for (u32 i = 0; i < 3; ++i) {
+            AbsNormals[p][i] = F32x4Set1(Frustum->Planes[p][i] < 0.0f ? -Frustum->Planes[p][i] : Frustum->Planes[p][i]);
+        }
+    }
+    
+    u32 VisibleCount = 0;
+    u32 End          = First + Count;
+    u32 Index        = First;
+    
+    for (; Index + 4 <= End; Index += 4)
+    {
+        f32x4 x  = F32x4LoadU(Boxes->CenterX + Index);
+        f32x4 y  = F32x4LoadU(Boxes->CenterY + Index);
+        f32x4 z  = F32x4LoadU(Boxes->CenterZ + Index);
+        f32x4 ex = F32x4LoadU(Boxes->ExtentX + Index);
+        f32x4 ey = F32x4LoadU(Boxes->ExtentY + Index);
+        f32x4 ez = F32x4LoadU(Boxes->ExtentZ + Index);
+        
+        f32x4 Inside = F32x4CmpGE(F32x4Zero(), F32x4Zero()); // all set
+        for (u32 p = 0; p < 6; ++p)
+        {
+            f32x4 Distance = F32x4MulAdd(Planes[p][0], x, Planes[p][3]);
+            Distance = F32x4MulAdd(Planes[p][1], y, Distance);
+            Distance = F32x4MulAdd(Planes[p][2], z, Distance);
+            
+            f32x4 Reach = F32x4Mul(AbsNormals[p][0], ex);
+            Reach = F32x4MulAdd(AbsNormals[p][1], ey, Reach);
+            Reach = F32x4MulAdd(AbsNormals[p][2], ez, Reach);
+            
+            Inside = F32x4And(Inside, F32x4CmpGE(F32x4Add(Distance, Reach), F32x4Zero()));
+        }
+        
+        VisibleCount = CullAppend(Visible, VisibleCount, Index - First, F32x4MoveMask(Inside));
+    }
+    
+    for (; Index < End; ++Index)
+    {
+        b32 Inside = true;
+        for (u32 p = 0; p < 6; ++p)
+        {
+            const f32 *Plane = Frustum->Planes[p];
+            f32 Distance = Plane[0] * Boxes->CenterX[Index] + Plane[1] * Boxes->CenterY[Index] + Plane[2] * Boxes->CenterZ[Index] + Plane[3];
+            f32 Reach    = F32x4First(AbsNormals[p][0]) * Boxes->ExtentX[Index] + F32x4First(AbsNormals[p][1]) * Boxes->ExtentY[Index] + F32x4First(AbsNormals[p][2]) * Boxes->ExtentZ[Index];
+            Inside = Inside && Distance + Reach >= 0.0f;
+        }
+        Visible[VisibleCount] = Index - First;
+        VisibleCount += Inside;
+    }
+    
+    for (u32 i = 0; i < VisibleCount; ++i) {
+        Visible[i] += First;
+    }
+    return VisibleCount;
+}
+
+internal void CullJob(void *Data)
+{
+    cull_job *Job = (cull_job*)Data;
+    u32 *Visible = Job->Visible + Job->First;
+    
+    if (Job->Spheres) {
+        Job->VisibleCount = CullSpheres(Job->Frustum, Job->Spheres, Job->First, Job->Count, Visible);
+    } else {
+        Job->VisibleCount = CullBoxes(Job->Frustum, Job->Boxes, Job->First, Job->Count, Visible);
+    }
+}
+
+// Runs the jobs and packs their results, returns the visible count. Visible has to hold VolumeCount
+// entries, Arena holds the job descriptions until they are done.
+internal u32 CullParallel(const frustum *Frustum, const cull_spheres *Spheres, const cull_boxes *Boxes, u32 VolumeCount, u32 *Visible, arena *Arena)
+{
+    u32 JobCount = (VolumeCount + CULL_JOB_VOLUMES - 1) / CULL_JOB_VOLUMES;
+    if (JobCount == 0) {
+        return 0;
+    }
+    
+    cull_job *CullJobs = PushArray(Arena, cull_job, JobCount);
+    for (u32 i = 0; i < JobCount; ++i)
+    {
+        cull_job *Job = CullJobs + i;
+        Job->Frustum      = Frustum;
+        Job->Spheres      = Spheres;
+        Job->Boxes        = Boxes;
+        Job->First        = i * CULL_JOB_VOLUMES;
+        Job->Count        = Min((u32)CULL_JOB_VOLUMES, VolumeCount - Job->First);
+        Job->Visible      = Visible;
+        Job->VisibleCount = 0;
+    }
+    
+    if (JobCount == 1)
+    {
+        CullJob(CullJobs);
+    }
+    else
+    {
+        job_counter Counter = {};
+        JobRunMany(CullJob, CullJobs, sizeof(cull_job), JobCount, &Counter);
+        JobWait(&Counter);
+    }
+    
+    u32 VisibleCount = CullJobs[0].VisibleCount;
+    for (u32 i = 1; i < JobCount; ++i)
+    {
+        memmove(Visible + VisibleCount, Visible + CullJobs[i].First, CullJobs[i].VisibleCount * sizeof(u32));
+        VisibleCount += CullJobs[i].VisibleCount;
+    }
+    
+    return VisibleCount;
+}
+
+inline u32 CullSpheresParallel(const frustum *Frustum, const cull_spheres *Spheres, u32 *Visible, arena *Arena)
+{
+    return CullParallel(Frustum, Spheres, 0, Spheres->Count, Visible, Arena);
+}
+
+inline u32 CullBoxesParallel(const frustum *Frustum, const cull_boxes *Boxes, u32 *Visible, arena *Arena)
+{
+    return CullParallel(Frustum, 0, Boxes, Boxes->Count, Visible, Arena);
+}
+
+#endif //CULLING_H
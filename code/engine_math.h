@@ -0,0 +1,708 @@
+/* date = October 17th 2026 9:40 am */
+
+#ifndef ENGINE_MATH_H
+#define ENGINE_MATH_H
+
+#include <math.h>
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct vec2
+{
+    f32 x, y;
+};
+
+struct vec3
+{
+    f32 x, y, z;
+};
+
+// NOTE(jdiaz): vec4 and mat4 are 16 byte aligned so they load straight into f32x4 lanes. Matrices
+// are column major like in GLSL, data[Column][Row]. Any shape is a matrix<Columns, Rows>, the
+// generic Matrix* functions below are constexpr and work for all of them, mat4 is specialized for
+// the alignment and gets the SIMD operators.
+template <u32 Columns, u32 Rows>
+struct matrix
+{
+    f32 data[Columns][Rows];
+};
+
+template <>
+struct alignas(16) matrix<4, 4>
+{
+    f32 data[4][4];
+};
+
+typedef matrix<3, 3> mat3;
+typedef matrix<4, 4> mat4;
+
+struct alignas(16) vec4
+{
+    f32 x, y, z, w;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal f32 Floor(f32 Value)
+{
+    f32 Res = ::floorf(Value);
+    return Res;
+}
+
+// NOTE(jdiaz): Fast math kernels, polynomials instead of libm calls. Every function has a scalar
+// version and an F32x4 version that does 4 lanes at once with the same polynomial. Measured max
+// errors against the double precision libm results:
+//
+//   Sinf, Cosf, SinCos   1e-7 absolute for |Rad| < 1000, 5e-7 up to 5e4, larger arguments lose
+//                        precision (the reduction to [-pi/4, pi/4] is no longer exact)
+//   Tanf                 3 ulp away from the poles
+//   RSqrt                4 ulp (hardware estimate + one Newton step), Value > 0
+//   Log2                 1e-7 absolute below 1, 1e-7 relative above (exact for powers of 2),
+//                        Value > 0, 0 and denormals give about -127
+//   Exp2                 2 ulp, Value clamped to [-126, 127]
+//
+// The scalar Sinf, Cosf and Tanf are constexpr as well, so Rotation and Perspective are.
+
+#define MATH_PI_OVER_2_HI  1.5703125f                   // pi/2 in 3 parts, Cody-Waite reduction
+#define MATH_PI_OVER_2_MID 4.837512969970703125e-4f
+#define MATH_PI_OVER_2_LO  7.54978995489188216e-8f
+#define MATH_2_OVER_PI     0.636619772367581343f
+#define MATH_SQRT2         1.41421356237309505f
+#define MATH_LOG2E_MINUS_1 0.44269504088896340736f
+
+// sin(r) and cos(r) for |r| <= pi/4
+internal constexpr f32 SinPoly(f32 r)
+{
+    f32 r2 = r * r;
+    f32 Res = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    return Res;
+}
+
+internal constexpr f32 CosPoly(f32 r)
+{
+    f32 r2 = r * r;
+    f32 Res = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+    return Res;
+}
+
+// Rad = Quadrant * pi/2 + Res, with Res in [-pi/4, pi/4]
+internal constexpr f32 ReduceQuadrant(f32 Rad, i32 &Quadrant)
+{
+    f32 q = Rad * MATH_2_OVER_PI;
+    Quadrant = (i32)(q >= 0.0f ? q + 0.5f : q - 0.5f);
+    f32 Quadrants = (f32)Quadrant;
+    f32 Res = ((Rad - Quadrants * MATH_PI_OVER_2_HI) - Quadrants * MATH_PI_OVER_2_MID) - Quadrants * MATH_PI_OVER_2_LO;
+    return Res;
+}
+
+internal constexpr f32 Sinf(f32 Rad)
+{
+    i32 Quadrant = 0;
+    f32 r   = ReduceQuadrant(Rad, Quadrant);
+    f32 Res = (Quadrant & 1) ? CosPoly(r) : SinPoly(r);
+    return (Quadrant & 2) ? -Res : Res;
+}
+
+internal constexpr f32 Cosf(f32 Rad)
+{
+    i32 Quadrant = 0;
+    f32 r   = ReduceQuadrant(Rad, Quadrant);
+    f32 Res = (Quadrant & 1) ? SinPoly(r) : CosPoly(r);
+    return ((Quadrant + 1) & 2) ? -Res : Res;
+}
+
+internal constexpr f32 Tanf(f32 Rad)
+{
+    i32 Quadrant = 0;
+    f32 r   = ReduceQuadrant(Rad, Quadrant);
+    f32 Sin = SinPoly(r);
+    f32 Cos = CosPoly(r);
+    f32 Res = (Quadrant & 1) ? -Cos / Sin : Sin / Cos;
+    return Res;
+}
+
+internal void SinCos(f32 Rad, f32 *Sin, f32 *Cos)
+{
+    i32 Quadrant = 0;
+    f32 r  = ReduceQuadrant(Rad, Quadrant);
+    f32 s  = SinPoly(r);
+    f32 c  = CosPoly(r);
+    f32 SinRes = (Quadrant & 1) ? c : s;
+    f32 CosRes = (Quadrant & 1) ? s : c;
+    *Sin = (Quadrant & 2) ? -SinRes : SinRes;
+    *Cos = ((Quadrant + 1) & 2) ? -CosRes : CosRes;
+}
+
+inline void F32x4SinCos(f32x4 Rad, f32x4 *Sin, f32x4 *Cos)
+{
+    i32x4 Quadrant  = F32x4RoundToI32(F32x4Mul(Rad, F32x4Set1(MATH_2_OVER_PI)));
+    f32x4 Quadrants = F32x4FromI32(Quadrant);
+    f32x4 r = F32x4Sub(Rad, F32x4Mul(Quadrants, F32x4Set1(MATH_PI_OVER_2_HI)));
+    r = F32x4Sub(r, F32x4Mul(Quadrants, F32x4Set1(MATH_PI_OVER_2_MID)));
+    r = F32x4Sub(r, F32x4Mul(Quadrants, F32x4Set1(MATH_PI_OVER_2_LO)));
+    f32x4 r2 = F32x4Mul(r, r);
+    
+    f32x4 s = F32x4MulAdd(r2, F32x4Set1(-1.9515295891e-4f), F32x4Set1(8.3321608736e-3f));
+    s = F32x4MulAdd(r2, s, F32x4Set1(-1.6666654611e-1f));
+    s = F32x4MulAdd(F32x4Mul(r, r2), s, r);
+    
+    f32x4 c = F32x4MulAdd(r2, F32x4Set1(2.443315711809948e-5f), F32x4Set1(-1.388731625493765e-3f));
+    c = F32x4MulAdd(r2, c, F32x4Set1(4.166664568298827e-2f));
+    c = F32x4MulAdd(F32x4Mul(r2, r2), c, F32x4Sub(F32x4Set1(1.0f), F32x4Mul(F32x4Set1(0.5f), r2)));
+    
+    // odd quadrants swap sin and cos, the sign bits come straight from the quadrant bits
+    f32x4 Swap    = I32x4AsF32x4(I32x4CmpEq(I32x4And(Quadrant, I32x4Set1(1)), I32x4Set1(1)));
+    f32x4 SinSign = I32x4AsF32x4(I32x4ShiftLeft(I32x4And(Quadrant, I32x4Set1(2)), 30));
+    f32x4 CosSign = I32x4AsF32x4(I32x4ShiftLeft(I32x4And(I32x4Add(Quadrant, I32x4Set1(1)), I32x4Set1(2)), 30));
+    *Sin = F32x4Xor(F32x4Select(Swap, c, s), SinSign);
+    *Cos = F32x4Xor(F32x4Select(Swap, s, c), CosSign);
+}
+
+inline f32x4 F32x4Sin(f32x4 Rad)
+{
+    f32x4 Sin, Cos;
+    F32x4SinCos(Rad, &Sin, &Cos);
+    return Sin;
+}
+
+inline f32x4 F32x4Cos(f32x4 Rad)
+{
+    f32x4 Sin, Cos;
+    F32x4SinCos(Rad, &Sin, &Cos);
+    return Cos;
+}
+
+inline f32x4 F32x4RSqrt(f32x4 Value)
+{
+    // one Newton step on the estimate: e * (1.5 - 0.5 * Value * e * e)
+    f32x4 e   = F32x4RSqrtEstimate(Value);
+    f32x4 Res = F32x4Mul(e, F32x4Sub(F32x4Set1(1.5f), F32x4Mul(F32x4Mul(F32x4Set1(0.5f), Value), F32x4Mul(e, e))));
+    return Res;
+}
+
+inline f32x4 F32x4Log2(f32x4 Value)
+{
+    // Value = m * 2^e with m in [sqrt(0.5), sqrt(2)), then log(m) = t - t^2/2 + t^3 * P(t), t = m - 1
+    i32x4 Bits     = F32x4AsI32x4(Value);
+    i32x4 Exponent = I32x4Sub(I32x4And(I32x4ShiftRight(Bits, 23), I32x4Set1(0xFF)), I32x4Set1(127));
+    f32x4 m        = I32x4AsF32x4(I32x4Or(I32x4And(Bits, I32x4Set1(0x007FFFFF)), I32x4Set1(0x3F800000)));
+    
+    f32x4 Big = F32x4CmpGE(m, F32x4Set1(MATH_SQRT2));
+    m        = F32x4Select(Big, F32x4Mul(m, F32x4Set1(0.5f)), m);
+    Exponent = I32x4Sub(Exponent, F32x4AsI32x4(Big)); // the mask is -1
+    
+    f32x4 t = F32x4Sub(m, F32x4Set1(1.0f));
+    f32x4 z = F32x4Mul(t, t);
+    f32x4 p = F32x4Set1(7.0376836292e-2f);
+    p = F32x4MulAdd(p, t, F32x4Set1(-1.1514610310e-1f));
+    p = F32x4MulAdd(p, t, F32x4Set1( 1.1676998740e-1f));
+    p = F32x4MulAdd(p, t, F32x4Set1(-1.2420140846e-1f));
+    p = F32x4MulAdd(p, t, F32x4Set1( 1.4249322787e-1f));
+    p = F32x4MulAdd(p, t, F32x4Set1(-1.6668057665e-1f));
+    p = F32x4MulAdd(p, t, F32x4Set1( 2.0000714765e-1f));
+    p = F32x4MulAdd(p, t, F32x4Set1(-2.4999993993e-1f));
+    p = F32x4MulAdd(p, t, F32x4Set1( 3.3333331174e-1f));
+    f32x4 y = F32x4MulAdd(F32x4Set1(-0.5f), z, F32x4Mul(F32x4Mul(t, z), p));
+    
+    // log2(m) = (y + t) * log2(e), with log2(e) - 1 split out to keep the bits of y + t
+    f32x4 Res = F32x4Mul(F32x4Add(y, t), F32x4Set1(MATH_LOG2E_MINUS_1));
+    Res = F32x4Add(F32x4Add(F32x4Add(Res, y), t), F32x4FromI32(Exponent));
+    return Res;
+}
+
+inline f32x4 F32x4Exp2(f32x4 Value)
+{
+    // 2^Value = 2^n * 2^f, n = round(Value), f in [-0.5, 0.5], 2^f = 1 + f * P(f)
+    Value = F32x4Min(F32x4Max(Value, F32x4Set1(-126.0f)), F32x4Set1(127.0f));
+    i32x4 n = F32x4RoundToI32(Value);
+    f32x4 f = F32x4Sub(Value, F32x4FromI32(n));
+    
+    f32x4 p = F32x4Set1(1.535336188319500e-4f);
+    p = F32x4MulAdd(p, f, F32x4Set1(1.339887440266574e-3f));
+    p = F32x4MulAdd(p, f, F32x4Set1(9.618437357674640e-3f));
+    p = F32x4MulAdd(p, f, F32x4Set1(5.550332471162809e-2f));
+    p = F32x4MulAdd(p, f, F32x4Set1(2.402264791363012e-1f));
+    p = F32x4MulAdd(p, f, F32x4Set1(6.931472028550421e-1f));
+    p = F32x4MulAdd(p, f, F32x4Set1(1.0f));
+    
+    f32x4 Scale = I32x4AsF32x4(I32x4ShiftLeft(I32x4Add(n, I32x4Set1(127)), 23));
+    f32x4 Res   = F32x4Mul(p, Scale);
+    return Res;
+}
+
+// The scalar versions of these run the F32x4 kernel in one lane, there is nothing to gain from a
+// second copy of the bit tricks
+internal f32 RSqrt(f32 Value) { return F32x4First(F32x4RSqrt(F32x4Set1(Value))); }
+internal f32 Log2(f32 Value)  { return F32x4First(F32x4Log2(F32x4Set1(Value))); }
+internal f32 Exp2(f32 Value)  { return F32x4First(F32x4Exp2(F32x4Set1(Value))); }
+
+// sqrtss/sqrtps are single instructions, nothing faster to do here
+internal f32 Sqrtf(f32 a)
+{
+    f32 Res = ::sqrtf(a);
+    return Res;
+}
+
+// NOTE(jdiaz): Compile time square root in double precision for constexpr code (exact, but slow)
+internal constexpr f64 ConstSqrt(f64 Value)
+{
+    if (Value <= 0.0) {
+        return 0.0;
+    }
+    
+    f64 Res = Value > 1.0 ? Value : 1.0;
+    for (u32 i = 0; i < 128; ++i)
+    {
+        f64 Next = 0.5 * (Res + Value / Res);
+        if (Next >= Res) {
+            break;
+        }
+        Res = Next;
+    }
+    return Res;
+}
+
+internal constexpr f32 Radians(f32 Degrees)
+{
+    f32 Res = PI * Degrees / 180.0f;
+    return Res;
+}
+
+internal constexpr vec3 V3()
+{
+    vec3 Res = {0.0f, 0.0f, 0.0f};
+    return Res;
+}
+
+internal constexpr vec3 V3(f32 x)
+{
+    vec3 Res = {x, x, x};
+    return Res;
+}
+
+internal constexpr vec3 V3(f32 x, f32 y, f32 z)
+{
+    vec3 Res = {x, y, z};
+    return Res;
+}
+
+internal constexpr f32 Dot(const vec3 &a, const vec3 &b)
+{
+    f32 Res = a.x * b.x + a.y * b.y + a.z * b.z;
+    return Res;
+}
+
+internal constexpr vec3 Cross(const vec3 &a, const vec3 &b)
+{
+    vec3 Res = {
+        a.y * b.z - b.y * a.z,
+        -(a.x * b.z - b.x * a.z),
+        a.x * b.y - b.x * a.y
+    };
+    return Res;
+}
+
+internal constexpr vec3 operator+ (const vec3 &a, const vec3 &b)
+{
+    vec3 Res = {a.x+b.x, a.y+b.y, a.z+b.z};
+    return Res;
+}
+
+internal constexpr vec3 operator- (const vec3 &a, const vec3 &b)
+{
+    vec3 Res = {a.x-b.x, a.y-b.y, a.z-b.z};
+    return Res;
+}
+
+internal constexpr vec3 operator- (const vec3 &a)
+{
+    vec3 Res = {-a.x, -a.y, -a.z};
+    return Res;
+}
+
+internal constexpr vec3 operator/ (const vec3 &a, f32 b)
+{
+    vec3 Res = {a.x/b, a.y/b, a.z/b};
+    return Res;
+}
+
+internal constexpr vec3 operator* (const vec3 &a, f32 b)
+{
+    vec3 Res = {a.x*b, a.y*b, a.z*b};
+    return Res;
+}
+
+internal f32 Length(const vec3 &a)
+{
+    f32 Res = Sqrtf(Dot(a,a));
+    return Res;
+}
+
+internal vec3 Normalize(const vec3 &a)
+{
+    f32 InvLength = RSqrt(Dot(a, a));
+    vec3 Res = a * InvLength;
+    return Res;
+}
+
+internal constexpr vec3 ConstNormalize(const vec3 &a)
+{
+    f32 InvLength = (f32)(1.0 / ConstSqrt(Dot(a, a)));
+    vec3 Res = a * InvLength;
+    return Res;
+}
+
+internal constexpr vec4 V4(f32 x, f32 y, f32 z, f32 w)
+{
+    vec4 Res = {x, y, z, w};
+    return Res;
+}
+
+internal constexpr vec4 V4(const vec3 &a, f32 w)
+{
+    vec4 Res = {a.x, a.y, a.z, w};
+    return Res;
+}
+
+internal vec4 V4(f32x4 a)
+{
+    vec4 Res;
+    F32x4Store(&Res.x, a);
+    return Res;
+}
+
+internal f32x4 F32x4(const vec4 &a)
+{
+    f32x4 Res = F32x4Load(&a.x);
+    return Res;
+}
+
+internal vec4 operator+ (const vec4 &a, const vec4 &b)
+{
+    vec4 Res = V4(F32x4Add(F32x4(a), F32x4(b)));
+    return Res;
+}
+
+internal vec4 operator- (const vec4 &a, const vec4 &b)
+{
+    vec4 Res = V4(F32x4Sub(F32x4(a), F32x4(b)));
+    return Res;
+}
+
+internal vec4 operator* (const vec4 &a, f32 b)
+{
+    vec4 Res = V4(F32x4Mul(F32x4(a), F32x4Set1(b)));
+    return Res;
+}
+
+internal f32 Dot(const vec4 &a, const vec4 &b)
+{
+    f32 Res = F32x4Sum(F32x4Mul(F32x4(a), F32x4(b)));
+    return Res;
+}
+
+internal constexpr mat4 Identity()
+{
+    mat4 Res = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    return Res;
+}
+
+internal constexpr mat4 Translation(const vec3 &Offset)
+{
+    mat4 Res = {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        Offset.x, Offset.y, Offset.z, 1.0f
+    };
+    return Res;
+}
+
+internal constexpr mat4 Rotation(f32 Angle, const vec3 &Axis)
+{
+    f32 Cos = Cosf(Angle);
+    f32 Ico = 1.0f - Cos;
+    f32 Sin = Sinf(Angle);
+    mat4 Res = {
+        Cos + Axis.x*Axis.x*Ico, Axis.y*Axis.x*Ico + Axis.z*Sin, Axis.z*Axis.x*Ico - Axis.y*Sin, 0.0f,
+        Axis.x*Axis.y*Ico - Axis.z*Sin, Cos + Axis.y*Axis.y*Ico, Axis.z*Axis.y*Ico + Axis.x*Sin, 0.0f,
+        Axis.x*Axis.z*Ico + Axis.y*Sin, Axis.y*Axis.z*Ico - Axis.x*Sin, Cos + Axis.z*Axis.z*Ico, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    return Res;
+}
+
+// Unit quaternion (x, y, z, w) rotating Angle radians around the normalized Axis, same rotation as
+// the Rotation matrix
+internal vec4 Quaternion(f32 Angle, const vec3 &Axis)
+{
+    f32 Sin, Cos;
+    SinCos(0.5f * Angle, &Sin, &Cos);
+    vec4 Res = {Axis.x * Sin, Axis.y * Sin, Axis.z * Sin, Cos};
+    return Res;
+}
+
+internal constexpr mat4 LookAt(const vec3 &Eye, const vec3 &Target, const vec3 &VUV)
+{
+    vec3 Z = ConstNormalize(Eye - Target);
+    vec3 X = ConstNormalize(Cross(VUV, Z));
+    vec3 Y = Cross(Z, X);
+    vec3 W = - V3(Dot(X, Eye), Dot(Y, Eye), Dot(Z, Eye));
+    mat4 Res     = {
+        X.x, Y.x, Z.x, 0.0f,
+        X.y, Y.y, Z.y, 0.0f,
+        X.z, Y.z, Z.z, 0.0f,
+        W.x, W.y, W.z, 1.0f
+    };
+    return Res;
+}
+
+// NOTE(jdiaz): Take into account that in Vulkan the projected Z range differs from OpenGL...
+internal constexpr mat4 Perspective(f32 FovY, f32 Aspect, f32 Near, f32 Far)
+{
+    f32 t = Near * Tanf( FovY * 0.5f );
+    f32 r = Aspect * t;
+    mat4 Res = {
+        Near / r, 0.0f, 0.0f, 0.0f,
+        0.0f, Near / t, 0.0f, 0.0f,
+        0.0f, 0.0f, -(Far+Near)/(Far-Near), -1.0f,
+        0.0f, 0.0f, -2.0f*Far*Near/(Far-Near), 0.0f
+    };
+    return Res;
+}
+
+// Generic (and constexpr) versions, any shape. For mat4 at runtime use the SIMD operators below.
+
+template <u32 N>
+internal constexpr matrix<N, N> MatrixIdentity()
+{
+    matrix<N, N> Res = {};
+    for (u32 i = 0; i < N; ++i) {
+        Res.data[i][i] = 1.0f;
+    }
+    return Res;
+}
+
+// (Rows x N) * (N x Columns)
+template <u32 N, u32 Rows, u32 Columns>
+internal constexpr matrix<Columns, Rows> MatrixMul(const matrix<N, Rows> &a, const matrix<Columns, N> &b)
+{
+    matrix<Columns, Rows> Res = {};
+    for (u32 c = 0; c < Columns; ++c)
+    {
+        for (u32 r = 0; r < Rows; ++r)
+        {
+            f32 Sum = 0.0f;
+            for (u32 k = 0; k < N; ++k) {
+                Sum += a.data[k][r] * b.data[c][k];
+            }
+            Res.data[c][r] = Sum;
+        }
+    }
+    return Res;
+}
+
+template <u32 Columns, u32 Rows>
+internal constexpr matrix<Rows, Columns> MatrixTranspose(const matrix<Columns, Rows> &a)
+{
+    matrix<Rows, Columns> Res = {};
+    for (u32 c = 0; c < Columns; ++c)
+    {
+        for (u32 r = 0; r < Rows; ++r) {
+            Res.data[r][c] = a.data[c][r];
+        }
+    }
+    return Res;
+}
+
+// Upper left 3x3 (rotation and scale of a transform)
+internal constexpr mat3 Mat3(const mat4 &a)
+{
+    mat3 Res = {};
+    for (u32 c = 0; c < 3; ++c)
+    {
+        for (u32 r = 0; r < 3; ++r) {
+            Res.data[c][r] = a.data[c][r];
+        }
+    }
+    return Res;
+}
+
+// a * Column, one column of the result
+inline f32x4 Mat4MulColumn(f32x4 a0, f32x4 a1, f32x4 a2, f32x4 a3, f32x4 Column)
+{
+    f32x4 Res = F32x4Mul(a0, F32x4SplatLane(Column, 0));
+    Res = F32x4MulAdd(a1, F32x4SplatLane(Column, 1), Res);
+    Res = F32x4MulAdd(a2, F32x4SplatLane(Column, 2), Res);
+    Res = F32x4MulAdd(a3, F32x4SplatLane(Column, 3), Res);
+    return Res;
+}
+
+internal vec4 operator* (const mat4 &a, const vec4 &b)
+{
+    f32x4 Res = Mat4MulColumn(F32x4Load(a.data[0]), F32x4Load(a.data[1]),
+                              F32x4Load(a.data[2]), F32x4Load(a.data[3]), F32x4(b));
+    return V4(Res);
+}
+
+internal mat4 operator* (const mat4 &a, const mat4 &b)
+{
+    f32x4 a0 = F32x4Load(a.data[0]);
+    f32x4 a1 = F32x4Load(a.data[1]);
+    f32x4 a2 = F32x4Load(a.data[2]);
+    f32x4 a3 = F32x4Load(a.data[3]);
+    
+    mat4 Res;
+    F32x4Store(Res.data[0], Mat4MulColumn(a0, a1, a2, a3, F32x4Load(b.data[0])));
+    F32x4Store(Res.data[1], Mat4MulColumn(a0, a1, a2, a3, F32x4Load(b.data[1])));
+    F32x4Store(Res.data[2], Mat4MulColumn(a0, a1, a2, a3, F32x4Load(b.data[2])));
+    F32x4Store(Res.data[3], Mat4MulColumn(a0, a1, a2, a3, F32x4Load(b.data[3])));
+    return Res;
+}
+
+internal mat4 Transpose(const mat4 &a)
+{
+    f32x4 c0 = F32x4Load(a.data[0]);
+    f32x4 c1 = F32x4Load(a.data[1]);
+    f32x4 c2 = F32x4Load(a.data[2]);
+    f32x4 c3 = F32x4Load(a.data[3]);
+    F32x4Transpose(c0, c1, c2, c3);
+    
+    mat4 Res;
+    F32x4Store(Res.data[0], c0);
+    F32x4Store(Res.data[1], c1);
+    F32x4Store(Res.data[2], c2);
+    F32x4Store(Res.data[3], c3);
+    return Res;
+}
+
+// NOTE(jdiaz): General inverse. The SSE version works on the four 2x2 blocks of the matrix,
+//   M = | A B |   inverse(M) = 1/|M| * | |D|A - B(D#C)    ... |    (# is the adjugate)
+//       | C D |                        |      ...         ... |
+// with |M| = |A||D| + |B||C| - tr((A#B)(D#C)), every 2x2 block lives in one register. inverse(M^T)
+// is inverse(M)^T so it does not matter whether the columns are read as rows. The other targets
+// use the cofactor expansion. A singular matrix gives infinities/NaNs, check Determinant first
+// when that can happen.
+#if ENGINE_SIMD_SSE
+
+#define Mat4Swizzle(a, x, y, z, w)       _mm_shuffle_ps((a), (a), _MM_SHUFFLE(w, z, y, x))
+#define Mat4Shuffle(a, b, x, y, z, w)    _mm_shuffle_ps((a), (b), _MM_SHUFFLE(w, z, y, x))
+
+// 2x2 blocks stored as (m00 m01 m10 m11)
+inline f32x4 Mat2Mul(f32x4 a, f32x4 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, Mat4Swizzle(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(Mat4Swizzle(a, 1, 0, 3, 2), Mat4Swizzle(b, 2, 1, 2, 1)));
+}
+
+// adjugate(a) * b
+inline f32x4 Mat2AdjMul(f32x4 a, f32x4 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(Mat4Swizzle(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(Mat4Swizzle(a, 1, 1, 2, 2), Mat4Swizzle(b, 2, 3, 0, 1)));
+}
+
+// a * adjugate(b)
+inline f32x4 Mat2MulAdj(f32x4 a, f32x4 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, Mat4Swizzle(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(Mat4Swizzle(a, 1, 0, 3, 2), Mat4Swizzle(b, 2, 1, 2, 1)));
+}
+
+internal mat4 Inverse(const mat4 &m)
+{
+    f32x4 r0 = F32x4Load(m.data[0]);
+    f32x4 r1 = F32x4Load(m.data[1]);
+    f32x4 r2 = F32x4Load(m.data[2]);
+    f32x4 r3 = F32x4Load(m.data[3]);
+    
+    f32x4 A = _mm_movelh_ps(r0, r1);
+    f32x4 B = _mm_movehl_ps(r1, r0);
+    f32x4 C = _mm_movelh_ps(r2, r3);
+    f32x4 D = _mm_movehl_ps(r3, r2);
+    
+    // |A| |B| |C| |D|
+    f32x4 DetSub = _mm_sub_ps(_mm_mul_ps(Mat4Shuffle(r0, r2, 0, 2, 0, 2), Mat4Shuffle(r1, r3, 1, 3, 1, 3)),
+                              _mm_mul_ps(Mat4Shuffle(r0, r2, 1, 3, 1, 3), Mat4Shuffle(r1, r3, 0, 2, 0, 2)));
+    f32x4 DetA = Mat4Swizzle(DetSub, 0, 0, 0, 0);
+    f32x4 DetB = Mat4Swizzle(DetSub, 1, 1, 1, 1);
+    f32x4 DetC = Mat4Swizzle(DetSub, 2, 2, 2, 2);
+    f32x4 DetD = Mat4Swizzle(DetSub, 3, 3, 3, 3);
+    
+    f32x4 D_C = Mat2AdjMul(D, C);
+    f32x4 A_B = Mat2AdjMul(A, B);
+    f32x4 X_  = _mm_sub_ps(_mm_mul_ps(DetD, A), Mat2Mul(B, D_C));
+    f32x4 W_  = _mm_sub_ps(_mm_mul_ps(DetA, D), Mat2Mul(C, A_B));
+    f32x4 Y_  = _mm_sub_ps(_mm_mul_ps(DetB, C), Mat2MulAdj(D, A_B));
+    f32x4 Z_  = _mm_sub_ps(_mm_mul_ps(DetC, B), Mat2MulAdj(A, D_C));
+    
+    f32x4 Trace = _mm_mul_ps(A_B, Mat4Swizzle(D_C, 0, 2, 1, 3));
+    f32x4 Det = _mm_add_ps(_mm_mul_ps(DetA, DetD), _mm_mul_ps(DetB, DetC));
+    Det = _mm_sub_ps(Det, _mm_set1_ps(F32x4Sum(Trace)));
+    
+    f32x4 InvDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), Det);
+    X_ = _mm_mul_ps(X_, InvDet);
+    Y_ = _mm_mul_ps(Y_, InvDet);
+    Z_ = _mm_mul_ps(Z_, InvDet);
+    W_ = _mm_mul_ps(W_, InvDet);
+    
+    // adjugate of the blocks and back to rows in the same shuffle
+    mat4 Res;
+    F32x4Store(Res.data[0], Mat4Shuffle(X_, Y_, 3, 1, 3, 1));
+    F32x4Store(Res.data[1], Mat4Shuffle(X_, Y_, 2, 0, 2, 0));
+    F32x4Store(Res.data[2], Mat4Shuffle(Z_, W_, 3, 1, 3, 1));
+    F32x4Store(Res.data[3], Mat4Shuffle(Z_, W_, 2, 0, 2, 0));
+    return Res;
+}
+
+#else
+
+internal mat4 Inverse(const mat4 &m)
+{
+    const f32 (*a)[4] = m.data;
+    
+    // 2x2 determinants of the first two and the last two columns
+    f32 s0 = a[0][0]*a[1][1] - a[1][0]*a[0][1];
+    f32 s1 = a[0][0]*a[1][2] - a[1][0]*a[0][2];
+    f32 s2 = a[0][0]*a[1][3] - a[1][0]*a[0][3];
+    f32 s3 = a[0][1]*a[1][2] - a[1][1]*a[0][2];
+    f32 s4 = a[0][1]*a[1][3] - a[1][1]*a[0][3];
+    f32 s5 = a[0][2]*a[1][3] - a[1][2]*a[0][3];
+    f32 c5 = a[2][2]*a[3][3] - a[3][2]*a[2][3];
+    f32 c4 = a[2][1]*a[3][3] - a[3][1]*a[2][3];
+    f32 c3 = a[2][1]*a[3][2] - a[3][1]*a[2][2];
+    f32 c2 = a[2][0]*a[3][3] - a[3][0]*a[2][3];
+    f32 c1 = a[2][0]*a[3][2] - a[3][0]*a[2][2];
+    f32 c0 = a[2][0]*a[3][1] - a[3][0]*a[2][1];
+    
+    f32 InvDet = 1.0f / (s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0);
+    
+    mat4 Res;
+    Res.data[0][0] = ( a[1][1]*c5 - a[1][2]*c4 + a[1][3]*c3) * InvDet;
+    Res.data[0][1] = (-a[0][1]*c5 + a[0][2]*c4 - a[0][3]*c3) * InvDet;
+    Res.data[0][2] = ( a[3][1]*s5 - a[3][2]*s4 + a[3][3]*s3) * InvDet;
+    Res.data[0][3] = (-a[2][1]*s5 + a[2][2]*s4 - a[2][3]*s3) * InvDet;
+    Res.data[1][0] = (-a[1][0]*c5 + a[1][2]*c2 - a[1][3]*c1) * InvDet;
+    Res.data[1][1] = ( a[0][0]*c5 - a[0][2]*c2 + a[0][3]*c1) * InvDet;
+    Res.data[1][2] = (-a[3][0]*s5 + a[3][2]*s2 - a[3][3]*s1) * InvDet;
+    Res.data[1][3] = ( a[2][0]*s5 - a[2][2]*s2 + a[2][3]*s1) * InvDet;
+    Res.data[2][0] = ( a[1][0]*c4 - a[1][1]*c2 + a[1][3]*c0) * InvDet;
+    Res.data[2][1] = (-a[0][0]*c4 + a[0][1]*c2 - a[0][3]*c0) * InvDet;
+    Res.data[2][2] = ( a[3][0]*s4 - a[3][1]*s2 + a[3][3]*s0) * InvDet;
+    Res.data[2][3] = (-a[2][0]*s4 + a[2][1]*s2 - a[2][3]*s0) * InvDet;
+    Res.data[3][0] = (-a[1][0]*c3 + a[1][1]*c1 - a[1][2]*c0) * InvDet;
+    Res.data[3][1] = ( a[0][0]*c3 - a[0][1]*c1 + a[0][2]*c0) * InvDet;
+    Res.data[3][2] = (-a[3][0]*s3 + a[3][1]*s1 - a[3][2]*s0) * InvDet;
+    Res.data[3][3] = ( a[2][0]*s3 - a[2][1]*s1 + a[2][2]*s0) * InvDet;
+    return Res;
+}
+
+#endif
+
+#endif //ENGINE_MATH_H
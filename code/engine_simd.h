@@ -0,0 +1,249 @@
+/* date = October 17th 2026 11:10 pm */
+
+#ifndef ENGINE_SIMD_H
+#define ENGINE_SIMD_H
+
+// NOTE(jdiaz): 4 wide f32 lanes. SSE2 on x86/x64 (always there on x64, so no extra compiler flags),
+// NEON on ARM64 and plain C everywhere else (or with ENGINE_SIMD_SCALAR defined, handy to check the
+// SIMD paths against). Only what the math needs, everything is inlined into the callers.
+
+#if !defined(ENGINE_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define ENGINE_SIMD_SSE 1
+#include <emmintrin.h>
+#elif !defined(ENGINE_SIMD_SCALAR) && (defined(__aarch64__) || defined(_M_ARM64))
+#define ENGINE_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#include <math.h>
+#endif
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+// i32x4 is only there for the bit tricks of the math kernels (exponents, quadrants, masks)
+#if ENGINE_SIMD_SSE
+typedef __m128  f32x4;
+typedef __m128i i32x4;
+#elif ENGINE_SIMD_NEON
+typedef float32x4_t f32x4;
+typedef int32x4_t   i32x4;
+#else
+struct f32x4
+{
+    f32 e[4];
+};
+
+struct i32x4
+{
+    i32 e[4];
+};
+#endif
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: Load/Store need 16 byte aligned pointers, the U versions do not. Masks are lanes with
+// every bit set or clear, like SSE. RSqrtEstimate is good to 12 bits or better on every backend.
+
+inline f32 F32FromBits(u32 Bits)                         { f32 Res; memcpy(&Res, &Bits, sizeof(Res)); return Res; }
+inline u32 F32ToBits(f32 Lane)                           { u32 Res; memcpy(&Res, &Lane, sizeof(Res)); return Res; }
+
+#if ENGINE_SIMD_SSE
+
+inline f32x4 F32x4Zero()                                 { return _mm_setzero_ps(); }
+inline f32x4 F32x4Set1(f32 a)                            { return _mm_set1_ps(a); }
+inline f32x4 F32x4Set(f32 a, f32 b, f32 c, f32 d)        { return _mm_setr_ps(a, b, c, d); }
+inline f32x4 F32x4Load(const f32 *a)                     { return _mm_load_ps(a); }
+inline f32x4 F32x4LoadU(const f32 *a)                    { return _mm_loadu_ps(a); }
+inline void  F32x4Store(f32 *Dest, f32x4 a)              { _mm_store_ps(Dest, a); }
+inline void  F32x4StoreU(f32 *Dest, f32x4 a)             { _mm_storeu_ps(Dest, a); }
+inline f32x4 F32x4Add(f32x4 a, f32x4 b)                  { return _mm_add_ps(a, b); }
+inline f32x4 F32x4Sub(f32x4 a, f32x4 b)                  { return _mm_sub_ps(a, b); }
+inline f32x4 F32x4Mul(f32x4 a, f32x4 b)                  { return _mm_mul_ps(a, b); }
+inline f32x4 F32x4Div(f32x4 a, f32x4 b)                  { return _mm_div_ps(a, b); }
+inline f32x4 F32x4MulAdd(f32x4 a, f32x4 b, f32x4 c)      { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+inline f32x4 F32x4Min(f32x4 a, f32x4 b)                  { return _mm_min_ps(a, b); }
+inline f32x4 F32x4Max(f32x4 a, f32x4 b)                  { return _mm_max_ps(a, b); }
+inline f32   F32x4First(f32x4 a)                         { return _mm_cvtss_f32(a); }
+inline f32x4 F32x4CmpGE(f32x4 a, f32x4 b)                { return _mm_cmpge_ps(a, b); }
+inline f32x4 F32x4And(f32x4 a, f32x4 b)                  { return _mm_and_ps(a, b); }
+inline f32x4 F32x4Or(f32x4 a, f32x4 b)                   { return _mm_or_ps(a, b); }
+inline u32   F32x4MoveMask(f32x4 a)                      { return (u32)_mm_movemask_ps(a); }
+inline f32x4 F32x4Xor(f32x4 a, f32x4 b)                  { return _mm_xor_ps(a, b); }
+inline f32x4 F32x4Select(f32x4 Mask, f32x4 a, f32x4 b)   { return _mm_or_ps(_mm_and_ps(Mask, a), _mm_andnot_ps(Mask, b)); }
+inline f32x4 F32x4Sqrt(f32x4 a)                          { return _mm_sqrt_ps(a); }
+inline f32x4 F32x4RSqrtEstimate(f32x4 a)                 { return _mm_rsqrt_ps(a); }
+
+inline i32x4 I32x4Set1(i32 a)                            { return _mm_set1_epi32(a); }
+inline i32x4 I32x4Add(i32x4 a, i32x4 b)                  { return _mm_add_epi32(a, b); }
+inline i32x4 I32x4Sub(i32x4 a, i32x4 b)                  { return _mm_sub_epi32(a, b); }
+inline i32x4 I32x4And(i32x4 a, i32x4 b)                  { return _mm_and_si128(a, b); }
+inline i32x4 I32x4Or(i32x4 a, i32x4 b)                   { return _mm_or_si128(a, b); }
+inline i32x4 I32x4CmpEq(i32x4 a, i32x4 b)                { return _mm_cmpeq_epi32(a, b); }
+inline i32x4 I32x4CmpGT(i32x4 a, i32x4 b)                { return _mm_cmpgt_epi32(a, b); }
+inline void  I32x4Store(i32 *Dest, i32x4 a)              { _mm_store_si128((__m128i*)Dest, a); }
+inline i32x4 F32x4RoundToI32(f32x4 a)                    { return _mm_cvtps_epi32(a); } // to nearest
+inline f32x4 F32x4FromI32(i32x4 a)                       { return _mm_cvtepi32_ps(a); }
+inline i32x4 F32x4AsI32x4(f32x4 a)                       { return _mm_castps_si128(a); } // same bits
+inline f32x4 I32x4AsF32x4(i32x4 a)                       { return _mm_castsi128_ps(a); }
+
+// Lane and Bits have to be constants, ShiftRight is logical
+#define F32x4SplatLane(a, Lane)   _mm_shuffle_ps((a), (a), _MM_SHUFFLE(Lane, Lane, Lane, Lane))
+#define I32x4ShiftLeft(a, Bits)   _mm_slli_epi32((a), (Bits))
+#define I32x4ShiftRight(a, Bits)  _mm_srli_epi32((a), (Bits))
+
+inline void F32x4Transpose(f32x4 &a, f32x4 &b, f32x4 &c, f32x4 &d)
+{
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+inline f32 F32x4Sum(f32x4 a)
+{
+    f32x4 Pairs = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    f32x4 Total = _mm_add_ss(Pairs, _mm_shuffle_ps(Pairs, Pairs, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(Total);
+}
+
+#elif ENGINE_SIMD_NEON
+
+inline f32x4 F32x4Zero()                                 { return vdupq_n_f32(0.0f); }
+inline f32x4 F32x4Set1(f32 a)                            { return vdupq_n_f32(a); }
+inline f32x4 F32x4Set(f32 a, f32 b, f32 c, f32 d)        { f32 e[4] = {a, b, c, d}; return vld1q_f32(e); }
+inline f32x4 F32x4Load(const f32 *a)                     { return vld1q_f32(a); }
+inline f32x4 F32x4LoadU(const f32 *a)                    { return vld1q_f32(a); }
+inline void  F32x4Store(f32 *Dest, f32x4 a)              { vst1q_f32(Dest, a); }
+inline void  F32x4StoreU(f32 *Dest, f32x4 a)             { vst1q_f32(Dest, a); }
+inline f32x4 F32x4Add(f32x4 a, f32x4 b)                  { return vaddq_f32(a, b); }
+inline f32x4 F32x4Sub(f32x4 a, f32x4 b)                  { return vsubq_f32(a, b); }
+inline f32x4 F32x4Mul(f32x4 a, f32x4 b)                  { return vmulq_f32(a, b); }
+inline f32x4 F32x4Div(f32x4 a, f32x4 b)                  { return vdivq_f32(a, b); }
+inline f32x4 F32x4MulAdd(f32x4 a, f32x4 b, f32x4 c)      { return vmlaq_f32(c, a, b); }
+inline f32x4 F32x4Min(f32x4 a, f32x4 b)                  { return vminq_f32(a, b); }
+inline f32x4 F32x4Max(f32x4 a, f32x4 b)                  { return vmaxq_f32(a, b); }
+inline f32   F32x4First(f32x4 a)                         { return vgetq_lane_f32(a, 0); }
+inline f32x4 F32x4CmpGE(f32x4 a, f32x4 b)                { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+inline f32x4 F32x4And(f32x4 a, f32x4 b)                  { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline f32x4 F32x4Or(f32x4 a, f32x4 b)                   { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+
+inline f32x4 F32x4Xor(f32x4 a, f32x4 b)                  { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline f32x4 F32x4Select(f32x4 Mask, f32x4 a, f32x4 b)   { return vbslq_f32(vreinterpretq_u32_f32(Mask), a, b); }
+inline f32x4 F32x4Sqrt(f32x4 a)                          { return vsqrtq_f32(a); }
+
+inline u32 F32x4MoveMask(f32x4 a)
+{
+    const int32_t Shifts[4] = {0, 1, 2, 3};
+    uint32_t Bits = vaddvq_u32(vshlq_u32(vshrq_n_u32(vreinterpretq_u32_f32(a), 31), vld1q_s32(Shifts)));
+    return Bits;
+}
+
+// vrsqrte is only good to 8 bits, one step more to match rsqrtps
+inline f32x4 F32x4RSqrtEstimate(f32x4 a)
+{
+    f32x4 Res = vrsqrteq_f32(a);
+    Res = vmulq_f32(Res, vrsqrtsq_f32(vmulq_f32(a, Res), Res));
+    return Res;
+}
+
+inline i32x4 I32x4Set1(i32 a)                            { return vdupq_n_s32(a); }
+inline i32x4 I32x4Add(i32x4 a, i32x4 b)                  { return vaddq_s32(a, b); }
+inline i32x4 I32x4Sub(i32x4 a, i32x4 b)                  { return vsubq_s32(a, b); }
+inline i32x4 I32x4And(i32x4 a, i32x4 b)                  { return vandq_s32(a, b); }
+inline i32x4 I32x4Or(i32x4 a, i32x4 b)                   { return vorrq_s32(a, b); }
+inline i32x4 I32x4CmpEq(i32x4 a, i32x4 b)                { return vreinterpretq_s32_u32(vceqq_s32(a, b)); }
+inline i32x4 I32x4CmpGT(i32x4 a, i32x4 b)                { return vreinterpretq_s32_u32(vcgtq_s32(a, b)); }
+inline void  I32x4Store(i32 *Dest, i32x4 a)              { vst1q_s32(Dest, a); }
+inline i32x4 F32x4RoundToI32(f32x4 a)                    { return vcvtnq_s32_f32(a); }
+inline f32x4 F32x4FromI32(i32x4 a)                       { return vcvtq_f32_s32(a); }
+inline i32x4 F32x4AsI32x4(f32x4 a)                       { return vreinterpretq_s32_f32(a); }
+inline f32x4 I32x4AsF32x4(i32x4 a)                       { return vreinterpretq_f32_s32(a); }
+
+#define F32x4SplatLane(a, Lane)   vdupq_laneq_f32((a), Lane)
+#define I32x4ShiftLeft(a, Bits)   vshlq_n_s32((a), (Bits))
+#define I32x4ShiftRight(a, Bits)  vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), (Bits)))
+
+inline void F32x4Transpose(f32x4 &a, f32x4 &b, f32x4 &c, f32x4 &d)
+{
+    float32x4x2_t ab = vtrnq_f32(a, b); // a0 b0 a2 b2 | a1 b1 a3 b3
+    float32x4x2_t cd = vtrnq_f32(c, d);
+    a = vcombine_f32(vget_low_f32(ab.val[0]),  vget_low_f32(cd.val[0]));
+    b = vcombine_f32(vget_low_f32(ab.val[1]),  vget_low_f32(cd.val[1]));
+    c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+inline f32 F32x4Sum(f32x4 a)
+{
+    return vaddvq_f32(a);
+}
+
+#else
+
+#define F32x4Lanes(Expr) f32x4 Res; for (u32 i = 0; i < 4; ++i) { Res.e[i] = (Expr); } return Res
+#define I32x4Lanes(Expr) i32x4 Res; for (u32 i = 0; i < 4; ++i) { Res.e[i] = (Expr); } return Res
+
+inline f32x4 F32x4Zero()                                 { F32x4Lanes(0.0f); }
+inline f32x4 F32x4Set1(f32 a)                            { F32x4Lanes(a); }
+inline f32x4 F32x4Set(f32 a, f32 b, f32 c, f32 d)        { f32x4 Res = {{a, b, c, d}}; return Res; }
+inline f32x4 F32x4Load(const f32 *a)                     { F32x4Lanes(a[i]); }
+inline f32x4 F32x4LoadU(const f32 *a)                    { F32x4Lanes(a[i]); }
+inline void  F32x4Store(f32 *Dest, f32x4 a)              { for (u32 i = 0; i < 4; ++i) Dest[i] = a.e[i]; }
+inline void  F32x4StoreU(f32 *Dest, f32x4 a)             { for (u32 i = 0; i < 4; ++i) Dest[i] = a.e[i]; }
+inline f32x4 F32x4Add(f32x4 a, f32x4 b)                  { F32x4Lanes(a.e[i] + b.e[i]); }
+inline f32x4 F32x4Sub(f32x4 a, f32x4 b)                  { F32x4Lanes(a.e[i] - b.e[i]); }
+inline f32x4 F32x4Mul(f32x4 a, f32x4 b)                  { F32x4Lanes(a.e[i] * b.e[i]); }
+inline f32x4 F32x4Div(f32x4 a, f32x4 b)                  { F32x4Lanes(a.e[i] / b.e[i]); }
+inline f32x4 F32x4MulAdd(f32x4 a, f32x4 b, f32x4 c)      { F32x4Lanes(a.e[i] * b.e[i] + c.e[i]); }
+inline f32x4 F32x4Min(f32x4 a, f32x4 b)                  { F32x4Lanes(Min(a.e[i], b.e[i])); }
+inline f32x4 F32x4Max(f32x4 a, f32x4 b)                  { F32x4Lanes(Max(a.e[i], b.e[i])); }
+inline f32   F32x4First(f32x4 a)                         { return a.e[0]; }
+inline f32x4 F32x4CmpGE(f32x4 a, f32x4 b)                { F32x4Lanes(F32FromBits(a.e[i] >= b.e[i] ? (u32)U32_MAX : 0u)); }
+inline f32x4 F32x4And(f32x4 a, f32x4 b)                  { F32x4Lanes(F32FromBits(F32ToBits(a.e[i]) & F32ToBits(b.e[i]))); }
+inline f32x4 F32x4Or(f32x4 a, f32x4 b)                   { F32x4Lanes(F32FromBits(F32ToBits(a.e[i]) | F32ToBits(b.e[i]))); }
+inline f32x4 F32x4Xor(f32x4 a, f32x4 b)                  { F32x4Lanes(F32FromBits(F32ToBits(a.e[i]) ^ F32ToBits(b.e[i]))); }
+inline f32x4 F32x4Select(f32x4 Mask, f32x4 a, f32x4 b)   { F32x4Lanes(F32ToBits(Mask.e[i]) ? a.e[i] : b.e[i]); }
+inline f32x4 F32x4Sqrt(f32x4 a)                          { F32x4Lanes(sqrtf(a.e[i])); }
+inline f32x4 F32x4RSqrtEstimate(f32x4 a)                 { F32x4Lanes(1.0f / sqrtf(a.e[i])); }
+
+inline i32x4 I32x4Set1(i32 a)                            { I32x4Lanes(a); }
+inline i32x4 I32x4Add(i32x4 a, i32x4 b)                  { I32x4Lanes((i32)((u32)a.e[i] + (u32)b.e[i])); }
+inline i32x4 I32x4Sub(i32x4 a, i32x4 b)                  { I32x4Lanes((i32)((u32)a.e[i] - (u32)b.e[i])); }
+inline i32x4 I32x4And(i32x4 a, i32x4 b)                  { I32x4Lanes(a.e[i] & b.e[i]); }
+inline i32x4 I32x4Or(i32x4 a, i32x4 b)                   { I32x4Lanes(a.e[i] | b.e[i]); }
+inline i32x4 I32x4CmpEq(i32x4 a, i32x4 b)                { I32x4Lanes(a.e[i] == b.e[i] ? -1 : 0); }
+inline i32x4 I32x4CmpGT(i32x4 a, i32x4 b)                { I32x4Lanes(a.e[i] > b.e[i] ? -1 : 0); }
+inline void  I32x4Store(i32 *Dest, i32x4 a)              { for (u32 i = 0; i < 4; ++i) Dest[i] = a.e[i]; }
+inline i32x4 F32x4RoundToI32(f32x4 a)                    { I32x4Lanes((i32)nearbyintf(a.e[i])); }
+inline f32x4 F32x4FromI32(i32x4 a)                       { F32x4Lanes((f32)a.e[i]); }
+inline i32x4 F32x4AsI32x4(f32x4 a)                       { I32x4Lanes((i32)F32ToBits(a.e[i])); }
+inline f32x4 I32x4AsF32x4(i32x4 a)                       { F32x4Lanes(F32FromBits((u32)a.e[i])); }
+
+inline i32x4 I32x4ShiftLeft(i32x4 a, u32 Bits)           { I32x4Lanes((i32)((u32)a.e[i] << Bits)); }
+inline i32x4 I32x4ShiftRight(i32x4 a, u32 Bits)          { I32x4Lanes((i32)((u32)a.e[i] >> Bits)); }
+
+inline u32 F32x4MoveMask(f32x4 a)
+{
+    u32 Res = 0;
+    for (u32 i = 0; i < 4; ++i) {
+        Res |= (F32ToBits(a.e[i]) >> 31) << i;
+    }
+    return Res;
+}
+
+#define F32x4SplatLane(a, Lane) F32x4Set1((a).e[Lane])
+
+inline void F32x4Transpose(f32x4 &a, f32x4 &b, f32x4 &c, f32x4 &d)
+{
+    f32x4 Rows[4] = {a, b, c, d};
+    a = F32x4Set(Rows[0].e[0], Rows[1].e[0], Rows[2].e[0], Rows[3].e[0]);
+    b = F32x4Set(Rows[0].e[1], Rows[1].e[1], Rows[2].e[1], Rows[3].e[1]);
+    c = F32x4Set(Rows[0].e[2], Rows[1].e[2], Rows[2].e[2], Rows[3].e[2]);
+    d = F32x4Set(Rows[0].e[3], Rows[1].e[3], Rows[2].e[3], Rows[3].e[3]);
+}
+
+inline f32 F32x4Sum(f32x4 a)
+{
+    return (a.e[0] + a.e[1]) + (a.e[2] + a.e[3]);
+}
+
+#endif
+
+#endif //ENGINE_SIMD_H
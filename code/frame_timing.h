@@ -0,0 +1,237 @@
+/* date = October 17th 2026 12:20 pm */
+
+#ifndef FRAME_TIMING_H
+#define FRAME_TIMING_H
+
+// NOTE(jdiaz): CPU frame timing. The platform layer provides the clock (PlatformGetTicks and
+// PlatformGetTickFrequency), the renderer closes each phase of the frame with FrameTimingEndPhase
+// and the last FRAME_TIMING_HISTORY frames are kept in a ring buffer to compute rolling stats.
+//
+// The frame limiter paces the loop to a target frame rate. Sleeping alone is too coarse (the
+// scheduler wakes us up late) and spinning alone burns a core, so it sleeps (PlatformSleep, in
+// microseconds) until shortly before the deadline and spins the rest. The spin window follows the
+// recent sleep overshoot.
+
+#define FRAME_TIMING_HISTORY 512 // must be a power of two
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+enum frame_phase
+{
+    FramePhase_FenceWait,
+    FramePhase_Acquire,
+    FramePhase_UBOUpdate,
+    FramePhase_Submit,
+    FramePhase_Present,
+    FramePhase_Count,
+    FramePhase_Frame = FramePhase_Count, // whole frame, begin to begin
+};
+
+struct frame_timing_record
+{
+    u64 PhaseTicks[FramePhase_Count + 1];
+};
+
+struct frame_timing
+{
+    u64 TickFrequency;
+    u64 FrameBeginTick;
+    u64 PhaseBeginTick;
+    u64 FrameCount;
+    f32 DeltaSeconds;
+    
+    frame_timing_record Records[FRAME_TIMING_HISTORY];
+};
+
+struct frame_limiter
+{
+    u64 TickFrequency;
+    u64 TargetTicks;   // 0 when the frame rate is not capped
+    u64 NextFrameTick;
+    u64 SpinTicks;     // how long before the deadline sleeping stops
+};
+
+struct frame_stats
+{
+    // microseconds
+    u32 Avg;
+    u32 P50;
+    u32 P95;
+    u32 P99;
+    u32 Max;
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal const char* FramePhaseNames[] =
+{
+    "fence wait",
+    "acquire",
+    "ubo update",
+    "submit",
+    "present",
+    "frame",
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal void FrameTimingInit(frame_timing *Timing)
+{
+    *Timing = {};
+    Timing->TickFrequency  = PlatformGetTickFrequency();
+    Timing->FrameBeginTick = PlatformGetTicks();
+    Timing->PhaseBeginTick = Timing->FrameBeginTick;
+}
+
+// Closes the previous frame and returns its duration, used to advance the simulation.
+internal f32 FrameTimingBeginFrame(frame_timing *Timing)
+{
+    u64 Now = PlatformGetTicks();
+    u64 FrameTicks = Now - Timing->FrameBeginTick;
+    
+    if (Timing->FrameCount > 0)
+    {
+        frame_timing_record *Record = Timing->Records + ((Timing->FrameCount - 1) & (FRAME_TIMING_HISTORY - 1));
+        Record->PhaseTicks[FramePhase_Frame] = FrameTicks;
+        Timing->DeltaSeconds = (f32)FrameTicks / (f32)Timing->TickFrequency;
+    }
+    
+    frame_timing_record *Record = Timing->Records + (Timing->FrameCount & (FRAME_TIMING_HISTORY - 1));
+    *Record = {};
+    
+    Timing->FrameCount++;
+    Timing->FrameBeginTick = Now;
+    Timing->PhaseBeginTick = Now;
+    
+    return Timing->DeltaSeconds;
+}
+
+// After the loop slept without drawing since IdleBeginTick: the idle time is taken out of the
+// current frame, so it does not show up in the frame stats nor in the next DeltaSeconds.
+internal void FrameTimingResume(frame_timing *Timing, u64 IdleBeginTick)
+{
+    u64 IdleTicks = PlatformGetTicks() - IdleBeginTick;
+    Timing->FrameBeginTick += IdleTicks;
+    Timing->PhaseBeginTick += IdleTicks;
+}
+
+internal void FrameTimingEndPhase(frame_timing *Timing, frame_phase Phase)
+{
+    Assert(Timing->FrameCount > 0 && Phase < FramePhase_Count);
+    
+    u64 Now = PlatformGetTicks();
+    frame_timing_record *Record = Timing->Records + ((Timing->FrameCount - 1) & (FRAME_TIMING_HISTORY - 1));
+    Record->PhaseTicks[Phase] += Now - Timing->PhaseBeginTick;
+    Timing->PhaseBeginTick = Now;
+}
+
+internal frame_stats FrameTimingComputeStats(frame_timing *Timing, frame_phase Phase)
+{
+    frame_stats Stats = {};
+    
+    // NOTE(jdiaz): Only completed frames, the current one has no frame time yet
+    u64 CompletedFrameCount = Timing->FrameCount > 0 ? Timing->FrameCount - 1 : 0;
+    u32 Count = (u32)Min(CompletedFrameCount, (u64)FRAME_TIMING_HISTORY);
+    if (Count == 0) {
+        return Stats;
+    }
+    
+    u32 Samples[FRAME_TIMING_HISTORY];
+    u64 Sum = 0;
+    
+    for (u32 i = 0; i < Count; ++i)
+    {
+        u64 Frame  = Timing->FrameCount - 2 - i;
+        u64 Ticks  = Timing->Records[ Frame & (FRAME_TIMING_HISTORY - 1) ].PhaseTicks[Phase];
+        u32 Micros = (u32)(Ticks * 1000000 / Timing->TickFrequency);
+        Sum += Micros;
+        
+        // insertion sort, the history is small and this only runs when reporting
+        u32 j = i;
+        for (; j > 0 && Samples[j - 1] > Micros; --j) {
+            Samples[j] = Samples[j - 1];
+        }
+        Samples[j] = Micros;
+    }
+    
+    Stats.Avg = (u32)(Sum / Count);
+    Stats.P50 = Samples[ (Count - 1) * 50 / 100 ];
+    Stats.P95 = Samples[ (Count - 1) * 95 / 100 ];
+    Stats.P99 = Samples[ (Count - 1) * 99 / 100 ];
+    Stats.Max = Samples[ Count - 1 ];
+    return Stats;
+}
+
+internal void FrameTimingReport(frame_timing *Timing)
+{
+    u64 CompletedFrameCount = Timing->FrameCount > 0 ? Timing->FrameCount - 1 : 0;
+    LOG("Frame timing over the last %u frames (us):", (u32)Min(CompletedFrameCount, (u64)FRAME_TIMING_HISTORY));
+    
+    for (u32 Phase = 0; Phase <= FramePhase_Count; ++Phase)
+    {
+        frame_stats Stats = FrameTimingComputeStats(Timing, (frame_phase)Phase);
+        LOG("  %s: avg %u p50 %u p95 %u p99 %u max %u", FramePhaseNames[Phase],
+            Stats.Avg, Stats.P50, Stats.P95, Stats.P99, Stats.Max);
+    }
+}
+
+internal void FrameLimiterInit(frame_limiter *Limiter, u32 TargetFPS)
+{
+    *Limiter = {};
+    Limiter->TickFrequency = PlatformGetTickFrequency();
+    Limiter->TargetTicks   = TargetFPS ? Limiter->TickFrequency / TargetFPS : 0;
+    Limiter->NextFrameTick = PlatformGetTicks() + Limiter->TargetTicks;
+    Limiter->SpinTicks     = Limiter->TickFrequency / 1000; // 1ms until the first measure
+}
+
+// After the loop slept without drawing, the next frame is due a full frame from now
+internal void FrameLimiterResume(frame_limiter *Limiter)
+{
+    Limiter->NextFrameTick = PlatformGetTicks() + Limiter->TargetTicks;
+}
+
+// Blocks until the next frame is due
+internal void FrameLimiterWait(frame_limiter *Limiter)
+{
+    if (Limiter->TargetTicks == 0) {
+        return;
+    }
+    
+    u64 Now = PlatformGetTicks();
+    
+    if (Now + Limiter->SpinTicks < Limiter->NextFrameTick)
+    {
+        u64 SleepTicks = Limiter->NextFrameTick - Limiter->SpinTicks - Now;
+        u64 SleepBegin = Now;
+        PlatformSleep((u32)(SleepTicks * 1000000 / Limiter->TickFrequency));
+        Now = PlatformGetTicks();
+        
+        // Grow the spin window fast when the sleep overshoots more than it and shrink it slowly,
+        // but never spin more than a quarter of the frame for the odd multi-millisecond hiccup
+        u64 Slept     = Now - SleepBegin;
+        u64 Overshoot = (Slept > SleepTicks) ? Slept - SleepTicks : 0;
+        u64 Wanted    = Overshoot + Limiter->TickFrequency / 10000; // 100us of margin
+        if (Wanted > Limiter->SpinTicks) {
+            Limiter->SpinTicks += (Wanted - Limiter->SpinTicks) / 2;
+        } else {
+            Limiter->SpinTicks -= (Limiter->SpinTicks - Wanted) / 16;
+        }
+        Limiter->SpinTicks = Min(Limiter->SpinTicks, Limiter->TargetTicks / 4);
+    }
+    
+    while (Now < Limiter->NextFrameTick)
+    {
+        CpuPause();
+        Now = PlatformGetTicks();
+    }
+    
+    // Keep the cadence when a frame is a bit late, but never try to catch up on missed frames
+    Limiter->NextFrameTick += Limiter->TargetTicks;
+    if (Limiter->NextFrameTick <= Now) {
+        Limiter->NextFrameTick = Now + Limiter->TargetTicks;
+    }
+}
+
+#endif //FRAME_TIMING_H
@@ -0,0 +1,245 @@
+/* date = October 17th 2026 2:45 pm */
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+// NOTE(jdiaz): Work-stealing job system. Every worker owns a Chase-Lev deque: it pushes and pops
+// jobs at the bottom, while idle workers steal from the top of the others. Jobs can be tied to a
+// job_counter, JobWait runs pending jobs while the counter is not zero (so waiting inside a job
+// never deadlocks, and the waiting thread keeps helping instead of blocking).
+//
+// The thread calling JobSystemInit becomes worker 0. The platform layer creates the rest of the
+// worker threads, which run JobWorkerMain, and provides PlatformCreateSemaphore,
+// PlatformWaitSemaphore and PlatformSignalSemaphore to park idle workers.
+
+#define JOB_MAX_WORKERS    64
+#define JOB_DEQUE_SIZE     4096 // jobs per worker, must be a power of two
+#define JOB_SPIN_COUNT     256  // empty lookups before an idle worker goes to sleep
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+typedef void job_function(void *Data);
+
+struct job_counter
+{
+    volatile u32 Value;
+};
+
+struct job
+{
+    job_function* Function;
+    void*         Data;
+    job_counter*  Counter;
+};
+
+// NOTE(jdiaz): Top is written by thieves and Bottom only by the owner, keep them apart
+struct job_deque
+{
+    alignas(64) volatile u32 Top;
+    alignas(64) volatile u32 Bottom;
+    alignas(64) job          Jobs[JOB_DEQUE_SIZE];
+};
+
+struct job_system
+{
+    u32          WorkerCount;
+    volatile b32 Running;
+    volatile u32 QueuedCount;   // jobs pushed and not yet taken by any worker
+    volatile u32 SleepingCount;
+    void*        WakeSemaphore;
+    job_deque    Deques[JOB_MAX_WORKERS];
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal job_system Jobs;
+
+internal thread_local u32 JobWorkerIndex = U32_MAX;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// Owner only
+internal b32 JobDequePush(job_deque *Deque, const job &Job)
+{
+    u32 Bottom = Deque->Bottom;
+    u32 Top    = AtomicLoadAcquire(&Deque->Top);
+    
+    if (Bottom - Top >= JOB_DEQUE_SIZE) {
+        return false;
+    }
+    
+    Deque->Jobs[ Bottom & (JOB_DEQUE_SIZE - 1) ] = Job;
+    AtomicStoreRelease(&Deque->Bottom, Bottom + 1);
+    return true;
+}
+
+// Owner only
+internal b32 JobDequePop(job_deque *Deque, job *Job)
+{
+    u32 Bottom = Deque->Bottom - 1;
+    Deque->Bottom = Bottom;
+    AtomicFullBarrier();
+    u32 Top = Deque->Top;
+    
+    if ((i32)(Bottom - Top) < 0)
+    {
+        // empty
+        Deque->Bottom = Top;
+        return false;
+    }
+    
+    *Job = Deque->Jobs[ Bottom & (JOB_DEQUE_SIZE - 1) ];
+    
+    if (Bottom != Top) {
+        return true;
+    }
+    
+    // Last job, race against the thieves for it
+    b32 Res = AtomicCompareExchange(&Deque->Top, Top, Top + 1) == Top;
+    Deque->Bottom = Top + 1;
+    return Res;
+}
+
+// Any thread
+internal b32 JobDequeSteal(job_deque *Deque, job *Job)
+{
+    u32 Top = AtomicLoadAcquire(&Deque->Top);
+    AtomicFullBarrier();
+    u32 Bottom = AtomicLoadAcquire(&Deque->Bottom);
+    
+    if ((i32)(Bottom - Top) <= 0) {
+        return false;
+    }
+    
+    *Job = Deque->Jobs[ Top & (JOB_DEQUE_SIZE - 1) ];
+    return AtomicCompareExchange(&Deque->Top, Top, Top + 1) == Top;
+}
+
+internal void JobSystemInit(u32 WorkerCount)
+{
+    Assert(WorkerCount > 0);
+    
+    Jobs.WorkerCount   = Min(WorkerCount, (u32)JOB_MAX_WORKERS);
+    Jobs.Running       = true;
+    Jobs.WakeSemaphore = PlatformCreateSemaphore();
+    JobWorkerIndex     = 0;
+}
+
+// Wakes up the workers and lets them leave JobWorkerMain, the platform joins the threads after
+internal void JobSystemShutdown()
+{
+    Jobs.Running = false;
+    PlatformSignalSemaphore(Jobs.WakeSemaphore, Jobs.WorkerCount);
+}
+
+internal void JobExecute(const job &Job)
+{
+    Job.Function(Job.Data);
+    
+    if (Job.Counter) {
+        AtomicDecrement(&Job.Counter->Value);
+    }
+}
+
+internal b32 JobGetNext(u32 WorkerIndex, job *Job)
+{
+    b32 Found = JobDequePop(Jobs.Deques + WorkerIndex, Job);
+    
+    for (u32 i = 1; i < Jobs.WorkerCount && !Found; ++i)
+    {
+        u32 VictimIndex = (WorkerIndex + i) % Jobs.WorkerCount;
+        Found = JobDequeSteal(Jobs.Deques + VictimIndex, Job);
+    }
+    
+    if (Found) {
+        AtomicDecrement(&Jobs.QueuedCount);
+    }
+    return Found;
+}
+
+// Queues a job on the calling worker. Counter (optional) is incremented now and decremented once
+// the job has run.
+internal void JobRun(job_function *Function, void *Data, job_counter *Counter)
+{
+    Assert(JobWorkerIndex < Jobs.WorkerCount);
+    
+    job Job = { Function, Data, Counter };
+    
+    if (Counter) {
+        AtomicIncrement(&Counter->Value);
+    }
+    
+    if (!JobDequePush(Jobs.Deques + JobWorkerIndex, Job))
+    {
+        // the deque is full, no point in queueing more work than that
+        JobExecute(Job);
+        return;
+    }
+    
+    // NOTE(jdiaz): Both sides use full barriers (queued count here, sleeping count in the worker
+    // loop), so either the worker sees the new job or we see the sleeping worker
+    AtomicIncrement(&Jobs.QueuedCount);
+    if (AtomicAdd(&Jobs.SleepingCount, 0) > 0) {
+        PlatformSignalSemaphore(Jobs.WakeSemaphore, 1);
+    }
+}
+
+// Runs Function for every element of an array, one job per element
+internal void JobRunMany(job_function *Function, void *DataArray, u32 DataStride, u32 Count, job_counter *Counter)
+{
+    for (u32 i = 0; i < Count; ++i)
+    {
+        JobRun(Function, (u8*)DataArray + i * DataStride, Counter);
+    }
+}
+
+// Helps with the queued jobs until all the jobs tied to Counter have run
+internal void JobWait(job_counter *Counter)
+{
+    Assert(JobWorkerIndex < Jobs.WorkerCount);
+    
+    while (AtomicLoadAcquire(&Counter->Value) > 0)
+    {
+        job Job;
+        if (JobGetNext(JobWorkerIndex, &Job)) {
+            JobExecute(Job);
+        } else {
+            CpuPause();
+        }
+    }
+}
+
+internal void JobWorkerMain(u32 WorkerIndex)
+{
+    Assert(WorkerIndex > 0 && WorkerIndex < Jobs.WorkerCount);
+    JobWorkerIndex = WorkerIndex;
+    
+    u32 IdleCount = 0;
+    
+    while (Jobs.Running)
+    {
+        job Job;
+        if (JobGetNext(WorkerIndex, &Job))
+        {
+            JobExecute(Job);
+            IdleCount = 0;
+        }
+        else if (++IdleCount < JOB_SPIN_COUNT)
+        {
+            CpuPause();
+        }
+        else
+        {
+            AtomicIncrement(&Jobs.SleepingCount);
+            if (AtomicAdd(&Jobs.QueuedCount, 0) == 0 && Jobs.Running) {
+                PlatformWaitSemaphore(Jobs.WakeSemaphore);
+            }
+            AtomicDecrement(&Jobs.SleepingCount);
+            IdleCount = 0;
+        }
+    }
+}
+
+#endif //JOB_SYSTEM_H
@@ -0,0 +1,411 @@
+// NOTE(jdiaz): io_uring backend for async_io.h. The ring is set up with the raw syscalls so there
+// is no dependency on liburing. Kernels without io_uring (or sandboxes that block it) fall back to
+// plain blocking reads done at submit time, which still complete through the same queue.
+
+#define LINUX_ASYNC_IO_WAIT_NS 1000000 // completion waits wake up this often, see AsyncIOGetCompletions
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct linux_async_io_slot
+{
+    async_read* Read;
+    int         File;
+    u64         Offset;
+    u32         NextFree;
+};
+
+struct linux_async_io
+{
+    int RingFd;
+    b32 WaitTimeout; // the completion wait takes a timeout (IORING_FEAT_EXT_ARG, 5.11+)
+    
+    // Submission queue
+    u8*           SQRing;
+    u64           SQRingSize;
+    u32*          SQHead;
+    u32*          SQTail;
+    u32*          SQMask;
+    u32*          SQArray;
+    io_uring_sqe* SQEs;
+    u64           SQEsSize;
+    u32           SQPending;
+    
+    // Completion queue
+    u8*           CQRing;
+    u64           CQRingSize;
+    u32*          CQHead;
+    u32*          CQTail;
+    u32*          CQMask;
+    io_uring_cqe* CQEs;
+    
+    // Fallback when io_uring is not available: slots finished at submit time
+    u32* Finished;
+    u32  FinishedHead;
+    u32  FinishedTail;
+    
+    linux_async_io_slot* Slots;
+    u32                  SlotCount;
+    u32                  FirstFreeSlot;
+    u32                  InFlight;
+    
+    arena           Memory; // slots and the finished list
+    pthread_mutex_t Lock;
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal linux_async_io AsyncIO;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal int LinuxIOUringSetup(u32 Entries, io_uring_params *Params)
+{
+    return (int)syscall(__NR_io_uring_setup, Entries, Params);
+}
+
+internal int LinuxIOUringEnter(int RingFd, u32 ToSubmit, u32 MinComplete, u32 Flags)
+{
+    return (int)syscall(__NR_io_uring_enter, RingFd, ToSubmit, MinComplete, Flags, NULL, 0);
+}
+
+// Waits for at least one completion or the timeout, without submitting anything
+internal int LinuxIOUringWait(int RingFd, u64 TimeoutNs)
+{
+    __kernel_timespec Timeout = {};
+    Timeout.tv_sec  = TimeoutNs / 1000000000;
+    Timeout.tv_nsec = TimeoutNs % 1000000000;
+    
+    io_uring_getevents_arg Arg = {};
+    Arg.ts = (u64)&Timeout;
+    
+    return (int)syscall(__NR_io_uring_enter, RingFd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &Arg, sizeof(Arg));
+}
+
+internal b32 LinuxIOUringMap(u32 QueueDepth)
+{
+    io_uring_params Params = {};
+    AsyncIO.RingFd = LinuxIOUringSetup(QueueDepth, &Params);
+    if (AsyncIO.RingFd < 0) {
+        return false;
+    }
+    
+    AsyncIO.SQRingSize = Params.sq_off.array + Params.sq_entries * sizeof(u32);
+    AsyncIO.CQRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+    AsyncIO.SQEsSize   = Params.sq_entries * sizeof(io_uring_sqe);
+    
+    b32 SingleMap = (Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    AsyncIO.WaitTimeout = (Params.features & IORING_FEAT_EXT_ARG) != 0;
+    if (SingleMap)
+    {
+        AsyncIO.SQRingSize = Max(AsyncIO.SQRingSize, AsyncIO.CQRingSize);
+        AsyncIO.CQRingSize = AsyncIO.SQRingSize;
+    }
+    
+    void* SQRing = mmap(NULL, AsyncIO.SQRingSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, AsyncIO.RingFd, IORING_OFF_SQ_RING);
+    void* CQRing = SingleMap ? SQRing :
+        mmap(NULL, AsyncIO.CQRingSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, AsyncIO.RingFd, IORING_OFF_CQ_RING);
+    void* SQEs   = mmap(NULL, AsyncIO.SQEsSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, AsyncIO.RingFd, IORING_OFF_SQES);
+    
+    if (SQRing == MAP_FAILED || CQRing == MAP_FAILED || SQEs == MAP_FAILED)
+    {
+        if (SQRing != MAP_FAILED) munmap(SQRing, AsyncIO.SQRingSize);
+        if (CQRing != MAP_FAILED && !SingleMap) munmap(CQRing, AsyncIO.CQRingSize);
+        if (SQEs != MAP_FAILED) munmap(SQEs, AsyncIO.SQEsSize);
+        close(AsyncIO.RingFd);
+        AsyncIO.RingFd = -1;
+        return false;
+    }
+    
+    AsyncIO.SQRing  = (u8*)SQRing;
+    AsyncIO.SQHead  = (u32*)(AsyncIO.SQRing + Params.sq_off.head);
+    AsyncIO.SQTail  = (u32*)(AsyncIO.SQRing + Params.sq_off.tail);
+    AsyncIO.SQMask  = (u32*)(AsyncIO.SQRing + Params.sq_off.ring_mask);
+    AsyncIO.SQArray = (u32*)(AsyncIO.SQRing + Params.sq_off.array);
+    AsyncIO.SQEs    = (io_uring_sqe*)SQEs;
+    
+    AsyncIO.CQRing  = (u8*)CQRing;
+    AsyncIO.CQHead  = (u32*)(AsyncIO.CQRing + Params.cq_off.head);
+    AsyncIO.CQTail  = (u32*)(AsyncIO.CQRing + Params.cq_off.tail);
+    AsyncIO.CQMask  = (u32*)(AsyncIO.CQRing + Params.cq_off.ring_mask);
+    AsyncIO.CQEs    = (io_uring_cqe*)(AsyncIO.CQRing + Params.cq_off.cqes);
+    
+    return true;
+}
+
+internal void AsyncIOInit(u32 QueueDepth)
+{
+    AsyncIO = {};
+    AsyncIO.Memory.Tag = MemoryTag_AsyncIO;
+    AsyncIO.RingFd = -1;
+    pthread_mutex_init(&AsyncIO.Lock, NULL);
+    
+    if (!LinuxIOUringMap(QueueDepth))
+    {
+        LOG("io_uring is not available, file reads will be synchronous");
+    }
+    
+    // NOTE(jdiaz): Never more reads in flight than completion entries, so the CQ cannot overflow
+    AsyncIO.SlotCount = QueueDepth;
+    AsyncIO.Slots     = PushArray(&AsyncIO.Memory, linux_async_io_slot, QueueDepth, ArenaPush_Zero);
+    AsyncIO.Finished  = PushArray(&AsyncIO.Memory, u32, QueueDepth, ArenaPush_Zero);
+    
+    for (u32 i = 0; i < QueueDepth; ++i)
+    {
+        AsyncIO.Slots[i].NextFree = i + 1;
+    }
+    AsyncIO.FirstFreeSlot = 0;
+}
+
+internal void AsyncIOShutdown()
+{
+    Assert(AsyncIO.InFlight == 0);
+    
+    if (AsyncIO.RingFd >= 0)
+    {
+        munmap(AsyncIO.SQEs, AsyncIO.SQEsSize);
+        if (AsyncIO.CQRing != AsyncIO.SQRing) {
+            munmap(AsyncIO.CQRing, AsyncIO.CQRingSize);
+        }
+        munmap(AsyncIO.SQRing, AsyncIO.SQRingSize);
+        close(AsyncIO.RingFd);
+    }
+    
+    ClearArena(&AsyncIO.Memory);
+    pthread_mutex_destroy(&AsyncIO.Lock);
+    AsyncIO = {};
+}
+
+internal void LinuxQueueRead(u32 SlotIndex)
+{
+    linux_async_io_slot *Slot = AsyncIO.Slots + SlotIndex;
+    async_read *Read = Slot->Read;
+    
+    if (AsyncIO.RingFd < 0)
+    {
+        while (Slot->Offset < Read->ByteCount)
+        {
+            ssize_t ReadByteCount = pread(Slot->File, Read->Bytes + Slot->Offset, Read->ByteCount - Slot->Offset, Slot->Offset);
+            if (ReadByteCount <= 0) break;
+            Slot->Offset += ReadByteCount;
+        }
+        AsyncIO.Finished[ AsyncIO.FinishedTail++ % AsyncIO.SlotCount ] = SlotIndex;
+        return;
+    }
+    
+    u32 Tail  = *AsyncIO.SQTail;
+    u32 Index = Tail & *AsyncIO.SQMask;
+    
+    io_uring_sqe *SQE = AsyncIO.SQEs + Index;
+    memset(SQE, 0, sizeof(*SQE));
+    SQE->opcode    = IORING_OP_READ;
+    SQE->fd        = Slot->File;
+    SQE->addr      = (u64)(Read->Bytes + Slot->Offset);
+    SQE->len       = (u32)(Read->ByteCount - Slot->Offset);
+    SQE->off       = Slot->Offset;
+    SQE->user_data = SlotIndex;
+    
+    AsyncIO.SQArray[Index] = Index;
+    __atomic_store_n(AsyncIO.SQTail, Tail + 1, __ATOMIC_RELEASE);
+    AsyncIO.SQPending++;
+}
+
+internal b32 AsyncIOSubmitRead(async_read *Read, arena *Arena)
+{
+    Read->Bytes     = 0;
+    Read->ByteCount = 0;
+    Read->Completed = false;
+    Read->Succeeded = false;
+    
+    int File = open(Read->FilePath, O_RDONLY);
+    if (File == -1) {
+        return false;
+    }
+    
+    struct stat FileStat;
+    if (fstat(File, &FileStat) != 0)
+    {
+        close(File);
+        return false;
+    }
+    
+    pthread_mutex_lock(&AsyncIO.Lock);
+    
+    if (AsyncIO.InFlight == AsyncIO.SlotCount)
+    {
+        pthread_mutex_unlock(&AsyncIO.Lock);
+        close(File);
+        return false;
+    }
+    
+    // NOTE(jdiaz): 16 byte aligned so SPIR-V and pixel data can be consumed in place
+    Read->ByteCount = FileStat.st_size;
+    Read->Bytes     = PushSize(Arena, Read->ByteCount + 1, 16);
+    Read->Bytes[ Read->ByteCount ] = 0;
+    
+    u32 SlotIndex = AsyncIO.FirstFreeSlot;
+    linux_async_io_slot *Slot = AsyncIO.Slots + SlotIndex;
+    AsyncIO.FirstFreeSlot = Slot->NextFree;
+    AsyncIO.InFlight++;
+    
+    Slot->Read   = Read;
+    Slot->File   = File;
+    Slot->Offset = 0;
+    
+    LinuxQueueRead(SlotIndex);
+    
+    pthread_mutex_unlock(&AsyncIO.Lock);
+    
+    return true;
+}
+
+internal void LinuxFlushLocked()
+{
+    if (AsyncIO.SQPending > 0)
+    {
+        int Submitted = LinuxIOUringEnter(AsyncIO.RingFd, AsyncIO.SQPending, 0, 0);
+        if (Submitted > 0) {
+            AsyncIO.SQPending -= Submitted;
+        }
+    }
+}
+
+internal void AsyncIOFlush()
+{
+    pthread_mutex_lock(&AsyncIO.Lock);
+    LinuxFlushLocked();
+    pthread_mutex_unlock(&AsyncIO.Lock);
+}
+
+internal async_read* LinuxFinishRead(u32 SlotIndex, b32 Succeeded)
+{
+    linux_async_io_slot *Slot = AsyncIO.Slots + SlotIndex;
+    async_read *Read = Slot->Read;
+    
+    close(Slot->File);
+    Slot->Read     = 0;
+    Slot->NextFree = AsyncIO.FirstFreeSlot;
+    AsyncIO.FirstFreeSlot = SlotIndex;
+    AsyncIO.InFlight--;
+    
+    Read->Succeeded = Succeeded && Slot->Offset == Read->ByteCount;
+    __atomic_store_n(&Read->Completed, true, __ATOMIC_RELEASE);
+    return Read;
+}
+
+internal u32 AsyncIOGetCompletions(async_read **Completions, u32 MaxCount, b32 Wait)
+{
+    u32 Count = 0;
+    
+    pthread_mutex_lock(&AsyncIO.Lock);
+    
+    if (AsyncIO.RingFd < 0)
+    {
+        while (Count < MaxCount && AsyncIO.FinishedHead != AsyncIO.FinishedTail)
+        {
+            u32 SlotIndex = AsyncIO.Finished[ AsyncIO.FinishedHead++ % AsyncIO.SlotCount ];
+            Completions[Count++] = LinuxFinishRead(SlotIndex, true);
+        }
+        
+        pthread_mutex_unlock(&AsyncIO.Lock);
+        return Count;
+    }
+    
+    while (Count == 0 && AsyncIO.InFlight > 0)
+    {
+        u32 Head = *AsyncIO.CQHead;
+        u32 Tail = __atomic_load_n(AsyncIO.CQTail, __ATOMIC_ACQUIRE);
+        
+        if (Head == Tail)
+        {
+            if (!Wait) {
+                LinuxFlushLocked();
+                break;
+            }
+            
+            // NOTE(jdiaz): The queued reads are submitted under the lock and the wait is done without
+            // it, so the other threads keep submitting and collecting meanwhile. Any of them can take
+            // the completion this thread wakes up for, or the last one in flight, so like on Win32
+            // the wait never blocks for long and the loop checks again. Older kernels cannot time
+            // out the wait and keep the lock during it.
+            int Res;
+            int Error;
+            if (AsyncIO.WaitTimeout)
+            {
+                LinuxFlushLocked();
+                pthread_mutex_unlock(&AsyncIO.Lock);
+                Res   = LinuxIOUringWait(AsyncIO.RingFd, LINUX_ASYNC_IO_WAIT_NS);
+                Error = errno;
+                pthread_mutex_lock(&AsyncIO.Lock);
+            }
+            else
+            {
+                Res   = LinuxIOUringEnter(AsyncIO.RingFd, AsyncIO.SQPending, 1, IORING_ENTER_GETEVENTS);
+                Error = errno;
+                if (Res > 0) {
+                    AsyncIO.SQPending -= Min((u32)Res, AsyncIO.SQPending);
+                }
+            }
+            
+            if (Res < 0 && Error != EINTR && Error != EAGAIN && Error != EBUSY && Error != ETIME) {
+                ExitWithError("io_uring_enter failed");
+            }
+            continue;
+        }
+        
+        while (Head != Tail && Count < MaxCount)
+        {
+            io_uring_cqe *CQE = AsyncIO.CQEs + (Head & *AsyncIO.CQMask);
+            u32 SlotIndex = (u32)CQE->user_data;
+            i32 Res       = CQE->res;
+            Head++;
+            
+            linux_async_io_slot *Slot = AsyncIO.Slots + SlotIndex;
+            async_read *Read = Slot->Read;
+            
+            if (Res == -EINVAL || Res == -EOPNOTSUPP)
+            {
+                // NOTE(jdiaz): IORING_OP_READ is 5.6+, older rings can be created but reject it
+                while (Slot->Offset < Read->ByteCount)
+                {
+                    ssize_t ReadByteCount = pread(Slot->File, Read->Bytes + Slot->Offset, Read->ByteCount - Slot->Offset, Slot->Offset);
+                    if (ReadByteCount <= 0) break;
+                    Slot->Offset += ReadByteCount;
+                }
+                Completions[Count++] = LinuxFinishRead(SlotIndex, true);
+            }
+            else if (Res == -EAGAIN || Res == -EINTR)
+            {
+                LinuxQueueRead(SlotIndex);
+            }
+            else if (Res > 0 && Slot->Offset + Res < Read->ByteCount)
+            {
+                // Short read, queue the remainder
+                Slot->Offset += Res;
+                LinuxQueueRead(SlotIndex);
+            }
+            else
+            {
+                if (Res > 0) {
+                    Slot->Offset += Res;
+                }
+                Completions[Count++] = LinuxFinishRead(SlotIndex, Res >= 0);
+            }
+        }
+        
+        __atomic_store_n(AsyncIO.CQHead, Head, __ATOMIC_RELEASE);
+    }
+    
+    LinuxFlushLocked();
+    
+    pthread_mutex_unlock(&AsyncIO.Lock);
+    
+    return Count;
+}
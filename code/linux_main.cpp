@@ -0,0 +1,547 @@
+// NOTE(jdiaz): Headless Linux platform layer. There is no window: the renderer presents into a
+// VK_EXT_headless_surface, which is supported by the software drivers (lavapipe, SwiftShader), so
+// the same VulkanInit / VulkanDrawFrame path used on Win32 can run on machines without a display.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <vulkan/vulkan.h>
+
+#include "platform.h"
+#include "engine_simd.h"
+#include "engine_math.h"
+#include "memory_accounting.h"
+#include "arena.h"
+
+#include "stbi_arena.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#define PLATFORM_VULKAN_SURFACE_EXTENSION_NAME VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME
+
+#define DEFAULT_FRAME_COUNT 1000
+
+#define LOG_FLUSH_INTERVAL_MS 10
+
+#define LINUX_HUGE_PAGE_SIZE MB(2)
+
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct application
+{
+    volatile b32       Running;
+    scratch_memory     ScratchMemory;
+    arena_block_region BlockRegion; // --large-pages, growing arena blocks
+    pthread_t          LogThread;
+    volatile b32       LogThreadRunning;
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal application App;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal u64 LinuxGetTicks()
+{
+    struct timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return (u64)Time.tv_sec * 1000000000ull + Time.tv_nsec;
+}
+
+internal u64 LinuxGetTickFrequency()
+{
+    return 1000000000ull;
+}
+
+internal void LinuxLogOutput(const char *Text)
+{
+    fputs(Text, stderr);
+}
+
+// Can oversleep, see FrameLimiterWait
+internal void LinuxSleep(u32 Microseconds)
+{
+    timespec Duration;
+    Duration.tv_sec  = Microseconds / 1000000;
+    Duration.tv_nsec = (Microseconds % 1000000) * 1000;
+    while (nanosleep(&Duration, &Duration) != 0 && errno == EINTR);
+}
+
+#define PlatformGetTicks         LinuxGetTicks
+#define PlatformGetTickFrequency LinuxGetTickFrequency
+#define PlatformLogOutput        LinuxLogOutput
+#define PlatformSleep            LinuxSleep
+
+#include "logger.h"
+
+// Formats and outputs the log records in the background, so LOG never waits on stderr
+internal void* LinuxLogThread(void *Parameter)
+{
+    while ( App.LogThreadRunning )
+    {
+        usleep(LOG_FLUSH_INTERVAL_MS * 1000);
+        LogFlush();
+    }
+    return NULL;
+}
+
+u8* ReserveThreadScratchMemory()
+{
+    return ScratchMemoryAcquireSlot(&App.ScratchMemory);
+}
+
+// NOTE(jdiaz): Also called for the main thread from the thread_local destructors after main
+// returns, when the reservation is already unmapped
+void ReleaseThreadScratchMemory(u8* Base)
+{
+    if (App.ScratchMemory.Buffer) {
+        ScratchMemoryReleaseSlot(&App.ScratchMemory, Base);
+    }
+}
+
+void CommitScratchMemory(u8* Base, u64 Size)
+{
+    Assert(Base >= App.ScratchMemory.Buffer && Base + Size <= App.ScratchMemory.Buffer + App.ScratchMemory.Size);
+    int Error = mprotect(Base, Size, PROT_READ|PROT_WRITE);
+    Assert(Error == 0);
+}
+
+void DecommitScratchMemory(u8* Base, u64 Size)
+{
+    if (App.ScratchMemory.Buffer)
+    {
+        Assert(Base >= App.ScratchMemory.Buffer && Base + Size <= App.ScratchMemory.Buffer + App.ScratchMemory.Size);
+        madvise(Base, Size, MADV_DONTNEED);
+        mprotect(Base, Size, PROT_NONE);
+    }
+}
+
+u8* AllocateArenaBlock(u64 Size)
+{
+    u8* Res = BlockRegionAllocate(&App.BlockRegion, Size);
+    if (!Res)
+    {
+        void* Mapping = mmap(NULL, Size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        Res = Mapping != MAP_FAILED ? (u8*)Mapping : NULL;
+    }
+    return Res;
+}
+
+void FreeArenaBlock(u8* Base, u64 Size)
+{
+    if (!BlockRegionFree(&App.BlockRegion, Base, Size)) {
+        munmap(Base, Size);
+    }
+}
+
+b32 WriteEntireFile(const char *FilePath, const void *Bytes, u64 ByteCount)
+{
+    int File = open(FilePath, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (File == -1) {
+        return false;
+    }
+    
+    b32 Res = write(File, Bytes, ByteCount) == (ssize_t)ByteCount;
+    
+    close(File);
+    return Res;
+}
+
+internal b32 LinuxTransparentHugePagesEnabled()
+{
+    b32 Res = false;
+    
+    // "always [madvise] never", the current mode is the one between brackets
+    int File = open("/sys/kernel/mm/transparent_hugepage/enabled", O_RDONLY);
+    if (File != -1)
+    {
+        char Mode[128] = {};
+        if (read(File, Mode, sizeof(Mode) - 1) > 0) {
+            Res = strstr(Mode, "[never]") == NULL;
+        }
+        close(File);
+    }
+    
+    return Res;
+}
+
+// Maps Size bytes (PROT_NONE reservations are committed later with mprotect). With UseLargePages
+// it tries explicit huge pages first (only for committed memory, they need a preallocated
+// hugetlbfs pool) and then transparent huge pages, which also work for lazy commits.
+internal u8* LinuxAllocateMemory(u64 Size, int Protection, b32 UseLargePages, memory_backing *Backing)
+{
+    *Backing = MemoryBacking_SmallPages;
+    
+    if (UseLargePages && Protection != PROT_NONE)
+    {
+        u64 LargeSize = (Size + LINUX_HUGE_PAGE_SIZE - 1) & ~(LINUX_HUGE_PAGE_SIZE - 1);
+        void* Res = mmap(NULL, LargeSize, Protection, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if (Res != MAP_FAILED)
+        {
+            *Backing = MemoryBacking_LargePages;
+            return (u8*)Res;
+        }
+    }
+    
+    int Flags = MAP_PRIVATE|MAP_ANONYMOUS | (Protection == PROT_NONE ? MAP_NORESERVE : 0);
+    
+    if (UseLargePages && LinuxTransparentHugePagesEnabled())
+    {
+        // Map an extra huge page and trim it, so the block starts at a huge page boundary
+        u8* Mapping = (u8*)mmap(NULL, Size + LINUX_HUGE_PAGE_SIZE, Protection, Flags, -1, 0);
+        if (Mapping != MAP_FAILED)
+        {
+            u8* Res = (u8*)(((u64)Mapping + LINUX_HUGE_PAGE_SIZE - 1) & ~(LINUX_HUGE_PAGE_SIZE - 1));
+            u64 Prefix = Res - Mapping;
+            if (Prefix > 0) {
+                munmap(Mapping, Prefix);
+            }
+            munmap(Res + Size, LINUX_HUGE_PAGE_SIZE - Prefix);
+            
+            // NOTE(jdiaz): The mapping is fine without the advice, it just stays on 4KB pages
+            if (madvise(Res, Size, MADV_HUGEPAGE) == 0) {
+                *Backing = MemoryBacking_TransparentHugePages;
+            } else {
+                LOG("madvise(MADV_HUGEPAGE) failed (errno %d), falling back to 4KB pages", errno);
+            }
+            return Res;
+        }
+    }
+    
+    if (UseLargePages && *Backing == MemoryBacking_SmallPages) {
+        LOG("Huge pages are not available (no hugetlbfs pool, transparent huge pages disabled), falling back to 4KB pages");
+    }
+    
+    void* Res = mmap(NULL, Size, Protection, Flags, -1, 0);
+    return Res != MAP_FAILED ? (u8*)Res : NULL;
+}
+
+internal void LinuxErrorMessage(int Type, const char * Message)
+{
+    const char *Caption = (Type == PlatformError_Fatal) ? "Application error" : "Application warning";
+    
+    // get the pending log out before the message
+    LogFlush();
+    
+    fprintf(stderr, "%s: %s\n", Caption, Message);
+    
+    if (Type == PlatformError_Fatal)
+    {
+        exit(1);
+    }
+}
+
+#define ExitWithError(msg) LinuxErrorMessage(PlatformError_Fatal, msg)
+
+internal void LinuxDebugFreeMemory(u8* Bytes)
+{
+    free(Bytes);
+}
+
+internal read_file_result LinuxDebugReadFile(const char *FilePath)
+{
+    read_file_result Res = {};
+    
+    int File = open(FilePath, O_RDONLY);
+    if (File != -1)
+    {
+        struct stat FileStat;
+        if (fstat(File, &FileStat) == 0)
+        {
+            u8* Bytes = (u8*)malloc(FileStat.st_size + 1);
+            
+            if (Bytes)
+            {
+                ssize_t ReadByteCount = read(File, Bytes, FileStat.st_size);
+                if (ReadByteCount == FileStat.st_size)
+                {
+                    Bytes[ FileStat.st_size ] = 0;
+                    Res.Bytes     = Bytes;
+                    Res.ByteCount = FileStat.st_size;
+                }
+                else
+                {
+                    LinuxDebugFreeMemory(Bytes);
+                }
+            }
+        }
+        
+        close(File);
+    }
+    
+    return Res;
+}
+
+internal mapped_file LinuxMapFile(const char *FilePath)
+{
+    mapped_file Res = {};
+    
+    int File = open(FilePath, O_RDONLY);
+    if (File != -1)
+    {
+        struct stat FileStat;
+        if (fstat(File, &FileStat) == 0 && FileStat.st_size > 0)
+        {
+            // the mapping keeps the file referenced, so the descriptor can be closed right away
+            void* Bytes = mmap(NULL, FileStat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+            if (Bytes != MAP_FAILED)
+            {
+                // assets are consumed right after mapping them, start reading ahead now
+                madvise(Bytes, FileStat.st_size, MADV_WILLNEED);
+                
+                Res.Bytes     = (u8*)Bytes;
+                Res.ByteCount = FileStat.st_size;
+            }
+        }
+        
+        close(File);
+    }
+    
+    return Res;
+}
+
+internal void LinuxUnmapFile(mapped_file *File)
+{
+    if (File->Bytes)
+    {
+        munmap(File->Bytes, File->ByteCount);
+    }
+    
+    File->Bytes     = 0;
+    File->ByteCount = 0;
+}
+
+internal VkResult LinuxCreateVulkanSurface(VkInstance Instance, const VkAllocationCallbacks *Allocator, VkSurfaceKHR *Surface)
+{
+    // NOTE(jdiaz): Not exported by every loader, so it is always fetched through the instance
+    PFN_vkCreateHeadlessSurfaceEXT CreateHeadlessSurface =
+        (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(Instance, "vkCreateHeadlessSurfaceEXT");
+    if (!CreateHeadlessSurface) {
+        return VK_ERROR_EXTENSION_NOT_PRESENT;
+    }
+    
+    VkHeadlessSurfaceCreateInfoEXT SurfaceCreateInfo = {};
+    SurfaceCreateInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+    
+    VkResult Res = CreateHeadlessSurface(Instance, &SurfaceCreateInfo, Allocator, Surface);
+    return Res;
+}
+
+internal void* LinuxCreateSemaphore()
+{
+    sem_t *Semaphore = (sem_t*)malloc(sizeof(sem_t));
+    Assert(Semaphore);
+    sem_init(Semaphore, 0, 0);
+    return Semaphore;
+}
+
+internal void LinuxWaitSemaphore(void *Semaphore)
+{
+    while (sem_wait((sem_t*)Semaphore) != 0 && errno == EINTR);
+}
+
+internal void LinuxSignalSemaphore(void *Semaphore, u32 Count)
+{
+    for (u32 i = 0; i < Count; ++i)
+    {
+        sem_post((sem_t*)Semaphore);
+    }
+}
+
+#define PlatformReadFile            LinuxDebugReadFile
+#define PlatformFreeFileMemory      LinuxDebugFreeMemory
+#define PlatformMapFile             LinuxMapFile
+#define PlatformUnmapFile           LinuxUnmapFile
+#define PlatformCreateVulkanSurface LinuxCreateVulkanSurface
+#define PlatformCreateSemaphore     LinuxCreateSemaphore
+#define PlatformWaitSemaphore       LinuxWaitSemaphore
+#define PlatformSignalSemaphore     LinuxSignalSemaphore
+
+#include "async_io.h"
+#include "linux_async_io.cpp"
+#include "frame_timing.h"
+#include "job_system.h"
+#include "transform.h"
+#include "transform_hierarchy.h"
+#include "culling.h"
+#include "bvh.h"
+#include "vertex_packing.h"
+#include "pak.h"
+#include "pool.h"
+
+#include "vulkan_renderer.cpp"
+
+internal void* LinuxJobWorkerThread(void *Parameter)
+{
+    JobWorkerMain((u32)(u64)Parameter);
+    return 0;
+}
+
+internal void LinuxSignalHandler(int Signal)
+{
+    App.Running = false;
+}
+
+int main(int ArgCount, char **Args)
+{
+    // Command line
+    
+    u32 FrameCount   = DEFAULT_FRAME_COUNT;
+    u32 WindowWidth  = DEFAULT_WINDOW_WIDTH;
+    u32 WindowHeight = DEFAULT_WINDOW_HEIGHT;
+    u32 TargetFPS    = 0;
+    b32 UseLargePages = false;
+    const char* MemoryDumpPath = NULL;
+    u32 ObjectCount  = 1;
+    
+    for (int i = 1; i < ArgCount; ++i)
+    {
+        if (StringsAreEqual(Args[i], "--frames") && i + 1 < ArgCount) {
+            FrameCount = atoi(Args[++i]);
+        }
+        else if (StringsAreEqual(Args[i], "--width") && i + 1 < ArgCount) {
+            WindowWidth = atoi(Args[++i]);
+        }
+        else if (StringsAreEqual(Args[i], "--height") && i + 1 < ArgCount) {
+            WindowHeight = atoi(Args[++i]);
+        }
+        else if (StringsAreEqual(Args[i], "--fps") && i + 1 < ArgCount) {
+            TargetFPS = atoi(Args[++i]);
+        }
+        else if (StringsAreEqual(Args[i], "--large-pages")) {
+            UseLargePages = true;
+        }
+        else if (StringsAreEqual(Args[i], "--memory-dump") && i + 1 < ArgCount) {
+            MemoryDumpPath = Args[++i];
+        }
+        else if (StringsAreEqual(Args[i], "--objects") && i + 1 < ArgCount) {
+            ObjectCount = atoi(Args[++i]);
+        }
+        else {
+            fprintf(stderr, "Usage: %s [--frames N] [--width W] [--height H] [--fps N] [--large-pages] [--memory-dump FILE] [--objects N]\n", Args[0]);
+            return 1;
+        }
+    }
+    
+    App.Running = true;
+    
+    LogInit();
+    
+    App.LogThreadRunning = true;
+    pthread_create(&App.LogThread, NULL, LinuxLogThread, NULL);
+    
+    signal(SIGINT,  LinuxSignalHandler);
+    signal(SIGTERM, LinuxSignalHandler);
+    
+    // Memory initialization
+    
+    // NOTE(jdiaz): With huge pages the growing arena blocks are carved from one region, there is
+    // nothing to gain from it with 4KB pages, they are taken from the OS one by one then
+    memory_backing BlockBacking = MemoryBacking_SmallPages;
+    if (UseLargePages)
+    {
+        u8* Region = LinuxAllocateMemory(ARENA_BLOCK_REGION_SIZE, PROT_READ|PROT_WRITE, UseLargePages, &BlockBacking);
+        if (Region && BlockBacking != MemoryBacking_SmallPages)
+        {
+            App.BlockRegion.Buffer = Region;
+            App.BlockRegion.Size   = ARENA_BLOCK_REGION_SIZE;
+        }
+        else if (Region)
+        {
+            munmap(Region, ARENA_BLOCK_REGION_SIZE);
+        }
+    }
+    
+    memory_backing ScratchBacking;
+    App.ScratchMemory.Size = SCRATCH_MAX_THREADS * SCRATCH_THREAD_RESERVE;
+    App.ScratchMemory.Buffer = LinuxAllocateMemory(App.ScratchMemory.Size, PROT_NONE, UseLargePages, &ScratchBacking);
+    Assert(App.ScratchMemory.Buffer);
+    
+    if (App.BlockRegion.Buffer) {
+        LOG("Arena blocks: %u MB region, %s", (u32)(App.BlockRegion.Size / MB(1)), MemoryBackingNames[BlockBacking]);
+    } else {
+        LOG("Arena blocks: %s", MemoryBackingNames[MemoryBacking_SmallPages]);
+    }
+    LOG("Scratch: %u MB reserved, %s", (u32)(App.ScratchMemory.Size / MB(1)), MemoryBackingNames[ScratchBacking]);
+    
+    // Job system, the main thread is worker 0, one more worker per remaining core
+    
+    pthread_t JobThreads[JOB_MAX_WORKERS];
+    JobSystemInit((u32)Max(sysconf(_SC_NPROCESSORS_ONLN), 1L));
+    for (u32 i = 1; i < Jobs.WorkerCount; ++i)
+    {
+        if (pthread_create(JobThreads + i, NULL, LinuxJobWorkerThread, (void*)(u64)i) != 0) {
+            ExitWithError("Could not create a job worker thread");
+        }
+    }
+    LOG("Job system: %u workers", Jobs.WorkerCount);
+    
+    AsyncIOInit(ASYNC_IO_DEFAULT_QUEUE_DEPTH);
+    
+    vulkan_context VkCtx = {};
+    VulkanInit(&VkCtx, WindowWidth, WindowHeight, ObjectCount);
+    
+    frame_timing FrameTiming;
+    FrameTimingInit(&FrameTiming);
+    
+    frame_limiter FrameLimiter;
+    FrameLimiterInit(&FrameLimiter, TargetFPS);
+    if (TargetFPS) {
+        LOG("Frame rate capped at %u fps", TargetFPS);
+    }
+    
+    // Application loop
+    for (u32 Frame = 0; Frame < FrameCount && App.Running; ++Frame)
+    {
+        FrameTimingBeginFrame(&FrameTiming);
+        
+        // Vulkan: Drawing
+        VulkanDrawFrame(&VkCtx, &FrameTiming, false);
+        
+        FrameLimiterWait(&FrameLimiter);
+    }
+    
+    // closes the last frame so it is part of the stats
+    FrameTimingBeginFrame(&FrameTiming);
+    FrameTimingReport(&FrameTiming);
+    
+    if (MemoryDumpPath && !MemoryDumpToFile(MemoryDumpPath)) {
+        LOG("Could not write the memory dump to %s", MemoryDumpPath);
+    }
+    
+    VulkanCleanup(&VkCtx);
+    
+    AsyncIOShutdown();
+    
+    JobSystemShutdown();
+    for (u32 i = 1; i < Jobs.WorkerCount; ++i)
+    {
+        pthread_join(JobThreads[i], NULL);
+    }
+    
+    munmap(App.ScratchMemory.Buffer, App.ScratchMemory.Size);
+    App.ScratchMemory.Buffer = NULL;
+    if (App.BlockRegion.Buffer) {
+        munmap(App.BlockRegion.Buffer, App.BlockRegion.Size);
+    }
+    
+    App.LogThreadRunning = false;
+    pthread_join(App.LogThread, NULL);
+    LogFlush();
+    
+    return 0;
+}
@@ -0,0 +1,440 @@
+/* date = October 17th 2026 1:30 pm */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// NOTE(jdiaz): Binary logger. LOG does not format anything: it appends a record with the format
+// string pointer, a timestamp and the raw arguments to a ring owned by the calling thread (one
+// producer and one consumer per ring, so there are no locks on the hot path). LogFlush merges the
+// rings by timestamp, formats the records and hands the text to PlatformLogOutput. It is called
+// periodically by a consumer thread in the platform layer, on fatal errors and at shutdown.
+//
+// The format string must outlive the record (use literals). String arguments are copied into the
+// record, up to LOG_MAX_STRING bytes. When a ring is full new records are dropped and counted.
+//
+// The platform layer provides PlatformGetTicks, PlatformGetTickFrequency and PlatformLogOutput.
+
+#define LOG_MAX_THREADS 128 // rings are only touched by the threads that log
+#define LOG_RING_SIZE   KB(64) // bytes per thread, must be a power of two
+#define LOG_MAX_ARGS    8
+#define LOG_MAX_STRING  512
+#define LOG_RECORD_ALIGNMENT 32
+
+#define LOG(format, ...) LogWrite(format, ##__VA_ARGS__)
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+enum log_arg_type
+{
+    LogArg_Int,
+    LogArg_UInt,
+    LogArg_Float,
+    LogArg_String,
+    LogArg_Pointer,
+};
+
+// Followed by one u64 per argument. String arguments store their length in that u64, followed by
+// the bytes (NUL terminated and padded to 8 bytes).
+struct log_record
+{
+    const char* Format; // 0 for the padding record that skips the end of the ring
+    u64         Ticks;
+    u32         Size;   // whole record, multiple of LOG_RECORD_ALIGNMENT
+    u32         ArgCount;
+    u8          ArgTypes[LOG_MAX_ARGS];
+};
+
+// NOTE(jdiaz): The producer and consumer indices live in different cache lines
+struct log_ring
+{
+    alignas(64) volatile u32 Tail;         // written by the owner thread (byte offsets, wrap around at 4GB)
+    volatile u32             DroppedCount; // written by the owner thread
+    alignas(64) volatile u32 Head;         // written by the consumer
+    u32                      ReportedDroppedCount;
+    alignas(64) u8           Buffer[LOG_RING_SIZE];
+};
+
+struct log_state
+{
+    u64          StartTicks;
+    u64          TickFrequency;
+    volatile u32 RingCount;
+    volatile u32 ConsumerLock;
+    log_ring     Rings[LOG_MAX_THREADS];
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal log_state Log;
+
+internal thread_local log_ring *LogThreadRing;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal void LogInit()
+{
+    Log.StartTicks    = PlatformGetTicks();
+    Log.TickFrequency = PlatformGetTickFrequency();
+}
+
+inline log_ring *LogGetThreadRing()
+{
+    if (!LogThreadRing)
+    {
+        u32 RingIndex = AtomicIncrement(&Log.RingCount) - 1;
+        Assert(RingIndex < LOG_MAX_THREADS);
+        LogThreadRing = Log.Rings + RingIndex;
+    }
+    return LogThreadRing;
+}
+
+inline u32 LogAlign(u32 Size, u32 Alignment)
+{
+    return (Size + Alignment - 1) & ~(Alignment - 1);
+}
+
+inline u32 LogStringLength(const char *String)
+{
+    u32 Length = 0;
+    while (String[Length] && Length < LOG_MAX_STRING) {
+        Length++;
+    }
+    return Length;
+}
+
+inline void LogPackValue(log_record *Record, u8 **Cursor, log_arg_type Type, u64 Value)
+{
+    Record->ArgTypes[ Record->ArgCount++ ] = (u8)Type;
+    *(u64*)*Cursor = Value;
+    *Cursor += sizeof(u64);
+}
+
+// Argument packing, one overload per argument category
+
+#define LOG_SCALAR_ARG(Type, ArgType, StoredType) \
+inline u32  LogArgSize(Type) { return sizeof(u64); } \
+inline void LogPackArg(log_record *Record, u8 **Cursor, Type Value) \
+{ \
+StoredType Stored = (StoredType)Value; \
+u64 Bits; \
+memcpy(&Bits, &Stored, sizeof(Bits)); \
+LogPackValue(Record, Cursor, ArgType, Bits); \
+}
+
+LOG_SCALAR_ARG(char,               LogArg_Int,   i64)
+LOG_SCALAR_ARG(signed char,        LogArg_Int,   i64)
+LOG_SCALAR_ARG(short,              LogArg_Int,   i64)
+LOG_SCALAR_ARG(int,                LogArg_Int,   i64)
+LOG_SCALAR_ARG(long,               LogArg_Int,   i64)
+LOG_SCALAR_ARG(long long,          LogArg_Int,   i64)
+LOG_SCALAR_ARG(bool,               LogArg_UInt,  u64)
+LOG_SCALAR_ARG(unsigned char,      LogArg_UInt,  u64)
+LOG_SCALAR_ARG(unsigned short,     LogArg_UInt,  u64)
+LOG_SCALAR_ARG(unsigned int,       LogArg_UInt,  u64)
+LOG_SCALAR_ARG(unsigned long,      LogArg_UInt,  u64)
+LOG_SCALAR_ARG(unsigned long long, LogArg_UInt,  u64)
+LOG_SCALAR_ARG(float,              LogArg_Float, f64)
+LOG_SCALAR_ARG(double,             LogArg_Float, f64)
+
+template<typename T>
+inline u32 LogArgSize(T*) { return sizeof(u64); }
+
+template<typename T>
+inline void LogPackArg(log_record *Record, u8 **Cursor, T* Value)
+{
+    LogPackValue(Record, Cursor, LogArg_Pointer, (u64)Value);
+}
+
+inline u32 LogArgSize(const char *String)
+{
+    u32 Length = String ? LogStringLength(String) : 0;
+    return sizeof(u64) + LogAlign(Length + 1, sizeof(u64));
+}
+
+inline void LogPackArg(log_record *Record, u8 **Cursor, const char *String)
+{
+    u32 Length = String ? LogStringLength(String) : 0;
+    LogPackValue(Record, Cursor, LogArg_String, Length);
+    if (Length) {
+        memcpy(*Cursor, String, Length);
+    }
+    (*Cursor)[Length] = 0;
+    *Cursor += LogAlign(Length + 1, sizeof(u64));
+}
+
+inline u32  LogArgSize(char *String) { return LogArgSize((const char*)String); }
+inline void LogPackArg(log_record *Record, u8 **Cursor, char *String) { LogPackArg(Record, Cursor, (const char*)String); }
+
+inline u32  LogArgsSize() { return 0; }
+inline void LogPackArgs(log_record *Record, u8 **Cursor) {}
+
+template<typename T, typename... Ts>
+inline u32 LogArgsSize(T First, Ts... Rest)
+{
+    return LogArgSize(First) + LogArgsSize(Rest...);
+}
+
+template<typename T, typename... Ts>
+inline void LogPackArgs(log_record *Record, u8 **Cursor, T First, Ts... Rest)
+{
+    LogPackArg(Record, Cursor, First);
+    LogPackArgs(Record, Cursor, Rest...);
+}
+
+template<typename... Ts>
+inline void LogWrite(const char *Format, Ts... Args)
+{
+    static_assert(sizeof...(Ts) <= LOG_MAX_ARGS, "Too many arguments for LOG");
+    
+    log_ring *Ring = LogGetThreadRing();
+    
+    u32 Size    = LogAlign(sizeof(log_record) + LogArgsSize(Args...), LOG_RECORD_ALIGNMENT);
+    u32 Tail    = Ring->Tail;
+    u32 Offset  = Tail & (LOG_RING_SIZE - 1);
+    u32 Padding = (Offset + Size > LOG_RING_SIZE) ? LOG_RING_SIZE - Offset : 0;
+    u32 Used    = Tail - AtomicLoadAcquire(&Ring->Head);
+    
+    if (Size > LOG_RING_SIZE / 2 || Used + Padding + Size > LOG_RING_SIZE)
+    {
+        Ring->DroppedCount++;
+        return;
+    }
+    
+    if (Padding)
+    {
+        log_record *PaddingRecord = (log_record*)(Ring->Buffer + Offset);
+        PaddingRecord->Format = 0;
+        PaddingRecord->Size   = Padding;
+        Tail  += Padding;
+        Offset = 0;
+    }
+    
+    log_record *Record = (log_record*)(Ring->Buffer + Offset);
+    Record->Format   = Format;
+    Record->Ticks    = PlatformGetTicks();
+    Record->Size     = Size;
+    Record->ArgCount = 0;
+    
+    u8 *Cursor = (u8*)(Record + 1);
+    LogPackArgs(Record, &Cursor, Args...);
+    
+    AtomicStoreRelease(&Ring->Tail, Tail + Size);
+}
+
+// Consumer side //////////////////////////////////////////////////////////////////////////////////
+
+internal b32 LogCharIsOneOf(char C, const char *Set)
+{
+    for (; *Set; ++Set) {
+        if (C == *Set) return true;
+    }
+    return false;
+}
+
+// Formats Record into Dest (always NUL terminated), returns the length written
+internal u32 LogFormatRecord(log_record *Record, char *Dest, u32 DestSize)
+{
+    u32 Length = 0;
+    
+#define LOG_APPEND(...) \
+{ \
+int Written = snprintf(Dest + Length, DestSize - Length, __VA_ARGS__); \
+if (Written > 0) Length = Min(Length + (u32)Written, DestSize - 1); \
+}
+    
+    u64 Ticks  = Record->Ticks - Log.StartTicks;
+    u64 Millis = Log.TickFrequency ? Ticks * 1000 / Log.TickFrequency : 0;
+    LOG_APPEND("[%5u.%03u] ", (u32)(Millis / 1000), (u32)(Millis % 1000));
+    
+    const char *Format = Record->Format;
+    u8 *ArgCursor = (u8*)(Record + 1);
+    u32 ArgIndex  = 0;
+    
+    while (*Format && Length < DestSize - 1)
+    {
+        if (Format[0] != '%') {
+            Dest[Length++] = *Format++;
+            continue;
+        }
+        if (Format[1] == '%') {
+            Dest[Length++] = '%';
+            Format += 2;
+            continue;
+        }
+        
+        // Rebuild the conversion with our own length modifiers, the arguments are 64 bit wide
+        char Spec[32];
+        u32 SpecLength = 0;
+        Spec[SpecLength++] = *Format++;
+        while (*Format && LogCharIsOneOf(*Format, "-+ #0123456789.") && SpecLength < 24) {
+            Spec[SpecLength++] = *Format++;
+        }
+        while (*Format && LogCharIsOneOf(*Format, "hlLzjtI")) {
+            if (Format[0] == 'I' && LogCharIsOneOf(Format[1], "36")) Format += 2;
+            Format++;
+        }
+        char Conversion = *Format;
+        if (Conversion) {
+            Format++;
+        }
+        
+        if (ArgIndex >= Record->ArgCount) {
+            break;
+        }
+        
+        u8  Type  = Record->ArgTypes[ArgIndex++];
+        u64 Value = *(u64*)ArgCursor;
+        ArgCursor += sizeof(u64);
+        
+        switch (Type)
+        {
+            case LogArg_String:
+            {
+                const char *String = (const char*)ArgCursor;
+                ArgCursor += LogAlign((u32)Value + 1, sizeof(u64));
+                Spec[SpecLength++] = 's';
+                Spec[SpecLength]   = 0;
+                LOG_APPEND(Spec, String);
+            } break;
+            
+            case LogArg_Float:
+            {
+                f64 Float;
+                memcpy(&Float, &Value, sizeof(Float));
+                Spec[SpecLength++] = LogCharIsOneOf(Conversion, "fFeEgGaA") ? Conversion : 'g';
+                Spec[SpecLength]   = 0;
+                LOG_APPEND(Spec, Float);
+            } break;
+            
+            case LogArg_Pointer:
+            if (Conversion == 'p')
+            {
+                Spec[SpecLength++] = 'p';
+                Spec[SpecLength]   = 0;
+                LOG_APPEND(Spec, (void*)Value);
+                break;
+            }
+            // fallthrough, printed as an integer
+            
+            default:
+            {
+                if (Conversion == 'c')
+                {
+                    Spec[SpecLength++] = 'c';
+                    Spec[SpecLength]   = 0;
+                    LOG_APPEND(Spec, (int)Value);
+                    break;
+                }
+                
+                b32 Signed = LogCharIsOneOf(Conversion, "di") ||
+                    (Type == LogArg_Int && !LogCharIsOneOf(Conversion, "uxXo"));
+                Spec[SpecLength++] = 'l';
+                Spec[SpecLength++] = 'l';
+                Spec[SpecLength++] = LogCharIsOneOf(Conversion, "diuxXo") ? Conversion : (Signed ? 'd' : 'u');
+                Spec[SpecLength]   = 0;
+                
+                if (Signed) {
+                    LOG_APPEND(Spec, (long long)Value);
+                } else {
+                    LOG_APPEND(Spec, (unsigned long long)Value);
+                }
+            } break;
+        }
+    }
+    
+#undef LOG_APPEND
+    
+    Dest[Length] = 0;
+    return Length;
+}
+
+// Returns the oldest record of the ring, skipping the padding at the end of the ring
+internal log_record *LogPeekRecord(log_ring *Ring)
+{
+    u32 Tail = AtomicLoadAcquire(&Ring->Tail);
+    
+    while (Ring->Head != Tail)
+    {
+        log_record *Record = (log_record*)(Ring->Buffer + (Ring->Head & (LOG_RING_SIZE - 1)));
+        if (Record->Format) {
+            return Record;
+        }
+        AtomicStoreRelease(&Ring->Head, Ring->Head + Record->Size);
+    }
+    
+    return 0;
+}
+
+internal void LogFlush()
+{
+    // One consumer at a time (consumer thread, fatal errors and shutdown)
+    while (AtomicCompareExchange(&Log.ConsumerLock, 0, 1) != 0) {}
+    
+    char Text[4096];
+    u32  TextLength = 0;
+    
+    for (;;)
+    {
+        // Oldest record among all the threads
+        log_ring   *OldestRing   = 0;
+        log_record *OldestRecord = 0;
+        
+        u32 RingCount = Min(AtomicLoadAcquire(&Log.RingCount), (u32)LOG_MAX_THREADS);
+        for (u32 i = 0; i < RingCount; ++i)
+        {
+            log_ring *Ring = Log.Rings + i;
+            log_record *Record = LogPeekRecord(Ring);
+            if (Record && (!OldestRecord || Record->Ticks < OldestRecord->Ticks))
+            {
+                OldestRing   = Ring;
+                OldestRecord = Record;
+            }
+        }
+        
+        if (!OldestRecord) {
+            break;
+        }
+        
+        char Line[LOG_MAX_STRING + 256];
+        u32 LineLength = LogFormatRecord(OldestRecord, Line, sizeof(Line) - 1);
+        Line[LineLength++] = '\n';
+        
+        AtomicStoreRelease(&OldestRing->Head, OldestRing->Head + OldestRecord->Size);
+        
+        // Batch the lines, so the output does not cost a system call per record
+        if (TextLength + LineLength + 1 > sizeof(Text))
+        {
+            Text[TextLength] = 0;
+            PlatformLogOutput(Text);
+            TextLength = 0;
+        }
+        memcpy(Text + TextLength, Line, LineLength);
+        TextLength += LineLength;
+    }
+    
+    u32 RingCount = Min(AtomicLoadAcquire(&Log.RingCount), (u32)LOG_MAX_THREADS);
+    for (u32 i = 0; i < RingCount; ++i)
+    {
+        log_ring *Ring = Log.Rings + i;
+        u32 DroppedCount = Ring->DroppedCount;
+        if (DroppedCount != Ring->ReportedDroppedCount && TextLength + 64 < sizeof(Text))
+        {
+            int Written = snprintf(Text + TextLength, sizeof(Text) - TextLength, "[log] %u records dropped (thread %u)\n",
+                                   DroppedCount - Ring->ReportedDroppedCount, i);
+            TextLength += Max(Written, 0);
+            Ring->ReportedDroppedCount = DroppedCount;
+        }
+    }
+    
+    if (TextLength > 0)
+    {
+        Text[TextLength] = 0;
+        PlatformLogOutput(Text);
+    }
+    
+    AtomicStoreRelease(&Log.ConsumerLock, 0);
+}
+
+#endif //LOGGER_H
@@ -0,0 +1,232 @@
+/* date = October 17th 2026 10:05 pm */
+
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+// NOTE(jdiaz): Memory accounting. Every allocation that takes memory from the OS or from a GPU heap
+// is counted under a memory_tag: current bytes, peak bytes and allocation count, for the CPU and
+// for the GPU separately, plus per GPU heap totals against the heap sizes reported by the device.
+// Everything is updated with atomics, so it can be queried (MemoryGetStats...) at any time from any
+// thread, and MemoryDumpToFile writes a text snapshot of all of it.
+//
+// What gets counted where:
+//   CPU  growing arenas count their blocks under the arena Tag (also the ones carved from the large
+//        page block region), the scratch reservation counts the pages as they are committed.
+//   GPU  VulkanAllocateMemory / VulkanFreeMemory (vulkan_allocator.h) count every VkDeviceMemory.
+// MemoryTag_ImageDecode lives inside scratch memory, it is reported but not added to the totals.
+
+#define MEMORY_MAX_GPU_HEAPS 16 // VK_MAX_MEMORY_HEAPS
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+enum memory_tag
+{
+    MemoryTag_Untagged,
+    MemoryTag_Scratch,
+    MemoryTag_ImageDecode,
+    MemoryTag_AsyncIO,
+    MemoryTag_Resources,
+    MemoryTag_Scene,
+    MemoryTag_DriverHost,
+    MemoryTag_Textures,
+    MemoryTag_Meshes,
+    MemoryTag_Staging,
+    MemoryTag_Uniforms,
+    MemoryTag_RenderTargets,
+    
+    MemoryTag_Count
+};
+
+struct memory_stats
+{
+    volatile u64 Current;
+    volatile u64 Peak;
+    volatile u64 Count;      // live allocations
+    volatile u64 TotalCount; // allocations since startup
+};
+
+struct memory_gpu_heap
+{
+    u64          Size;
+    b32          DeviceLocal;
+    memory_stats Stats;
+};
+
+struct memory_accounting
+{
+    memory_stats    CPU[MemoryTag_Count];
+    memory_stats    GPU[MemoryTag_Count];
+    u32             GPUHeapCount;
+    memory_gpu_heap GPUHeaps[MEMORY_MAX_GPU_HEAPS];
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal memory_accounting MemoryAccounting;
+
+internal const char* MemoryTagNames[MemoryTag_Count] = {
+    "untagged", "scratch", "image decode", "async io", "resource tables", "scene", "driver host",
+    "textures", "meshes", "staging", "uniforms", "render targets",
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: Implemented by the platform layer
+b32 WriteEntireFile(const char *FilePath, const void *Bytes, u64 ByteCount);
+
+inline void MemoryStatsUpdatePeak(memory_stats *Stats, u64 Current)
+{
+    u64 Peak = Stats->Peak;
+    while (Current > Peak)
+    {
+        u64 Found = AtomicCompareExchange64(&Stats->Peak, Peak, Current);
+        if (Found == Peak) {
+            break;
+        }
+        Peak = Found;
+    }
+}
+
+inline void MemoryStatsAdd(memory_stats *Stats, u64 Size)
+{
+    AtomicAdd64(&Stats->Count, 1);
+    AtomicAdd64(&Stats->TotalCount, 1);
+    MemoryStatsUpdatePeak(Stats, AtomicAdd64(&Stats->Current, Size));
+}
+
+inline void MemoryStatsRemove(memory_stats *Stats, u64 Size)
+{
+    AtomicAdd64(&Stats->Count, (u64)-1);
+    AtomicAdd64(&Stats->Current, (u64)0 - Size);
+}
+
+// A live allocation that changed size in place, the counts stay
+inline void MemoryStatsResize(memory_stats *Stats, u64 OldSize, u64 NewSize)
+{
+    MemoryStatsUpdatePeak(Stats, AtomicAdd64(&Stats->Current, NewSize - OldSize));
+}
+
+inline void MemoryTrackAlloc(u32 Tag, u64 Size)
+{
+    Assert(Tag < MemoryTag_Count);
+    MemoryStatsAdd(MemoryAccounting.CPU + Tag, Size);
+}
+
+inline void MemoryTrackFree(u32 Tag, u64 Size)
+{
+    Assert(Tag < MemoryTag_Count);
+    MemoryStatsRemove(MemoryAccounting.CPU + Tag, Size);
+}
+
+// Heaps as reported by the device (VkPhysicalDeviceMemoryProperties::memoryHeaps)
+inline void MemorySetGPUHeap(u32 HeapIndex, u64 Size, b32 DeviceLocal)
+{
+    Assert(HeapIndex < MEMORY_MAX_GPU_HEAPS);
+    MemoryAccounting.GPUHeaps[HeapIndex].Size        = Size;
+    MemoryAccounting.GPUHeaps[HeapIndex].DeviceLocal = DeviceLocal;
+    MemoryAccounting.GPUHeapCount = Max(MemoryAccounting.GPUHeapCount, HeapIndex + 1);
+}
+
+inline void MemoryTrackGPUAlloc(u32 Tag, u32 HeapIndex, u64 Size)
+{
+    Assert(Tag < MemoryTag_Count && HeapIndex < MemoryAccounting.GPUHeapCount);
+    MemoryStatsAdd(MemoryAccounting.GPU + Tag, Size);
+    MemoryStatsAdd(&MemoryAccounting.GPUHeaps[HeapIndex].Stats, Size);
+}
+
+inline void MemoryTrackGPUFree(u32 Tag, u32 HeapIndex, u64 Size)
+{
+    Assert(Tag < MemoryTag_Count && HeapIndex < MemoryAccounting.GPUHeapCount);
+    MemoryStatsRemove(MemoryAccounting.GPU + Tag, Size);
+    MemoryStatsRemove(&MemoryAccounting.GPUHeaps[HeapIndex].Stats, Size);
+}
+
+// Queries, a snapshot of the counters (each one is exact, they are not read all at once)
+
+inline memory_stats MemoryGetStats(memory_stats *Source)
+{
+    memory_stats Res;
+    Res.Current    = Source->Current;
+    Res.Peak       = Source->Peak;
+    Res.Count      = Source->Count;
+    Res.TotalCount = Source->TotalCount;
+    return Res;
+}
+
+inline memory_stats MemoryGetCPUStats(u32 Tag) { return MemoryGetStats(MemoryAccounting.CPU + Tag); }
+inline memory_stats MemoryGetGPUStats(u32 Tag) { return MemoryGetStats(MemoryAccounting.GPU + Tag); }
+inline memory_stats MemoryGetGPUHeapStats(u32 HeapIndex) { return MemoryGetStats(&MemoryAccounting.GPUHeaps[HeapIndex].Stats); }
+
+inline u64 MemoryGetCPUTotal()
+{
+    u64 Res = 0;
+    for (u32 Tag = 0; Tag < MemoryTag_Count; ++Tag)
+    {
+        if (Tag != MemoryTag_ImageDecode) {
+            Res += MemoryAccounting.CPU[Tag].Current;
+        }
+    }
+    return Res;
+}
+
+#define MemoryDumpPrint(...) \
+if (Length < Size) { \
+int Written = snprintf(Text + Length, Size - Length, __VA_ARGS__); \
+Length += Written > 0 ? (u64)Written : 0; \
+}
+
+internal u64 MemoryFormatStats(char *Text, u64 Size, const char *Name, memory_stats Stats)
+{
+    u64 Length = 0;
+    MemoryDumpPrint("  %-16s %12.3f MB  peak %12.3f MB  %8llu live  %10llu total\n", Name,
+                    Stats.Current / (f64)MB(1), Stats.Peak / (f64)MB(1), Stats.Count, Stats.TotalCount);
+    return Min(Length, Size);
+}
+
+// Text snapshot of every counter, Text has to hold a few KB
+internal u64 MemoryFormatSnapshot(char *Text, u64 Size)
+{
+    u64 Length = 0;
+    
+    MemoryDumpPrint("CPU (%.3f MB)\n", MemoryGetCPUTotal() / (f64)MB(1));
+    for (u32 Tag = 0; Tag < MemoryTag_Count; ++Tag)
+    {
+        memory_stats Stats = MemoryGetCPUStats(Tag);
+        if (Stats.TotalCount) {
+            Length += MemoryFormatStats(Text + Length, Size - Length, MemoryTagNames[Tag], Stats);
+        }
+    }
+    
+    MemoryDumpPrint("\nGPU\n");
+    for (u32 Tag = 0; Tag < MemoryTag_Count; ++Tag)
+    {
+        memory_stats Stats = MemoryGetGPUStats(Tag);
+        if (Stats.TotalCount) {
+            Length += MemoryFormatStats(Text + Length, Size - Length, MemoryTagNames[Tag], Stats);
+        }
+    }
+    
+    MemoryDumpPrint("\nGPU heaps\n");
+    for (u32 i = 0; i < MemoryAccounting.GPUHeapCount; ++i)
+    {
+        memory_gpu_heap *Heap = MemoryAccounting.GPUHeaps + i;
+        memory_stats Stats = MemoryGetGPUHeapStats(i);
+        MemoryDumpPrint("  heap %u%-9s %12.3f MB  peak %12.3f MB  of %10.3f MB (%.1f%% peak)\n",
+                        i, Heap->DeviceLocal ? " (local)" : "",
+                        Stats.Current / (f64)MB(1), Stats.Peak / (f64)MB(1), Heap->Size / (f64)MB(1),
+                        Heap->Size ? 100.0 * Stats.Peak / Heap->Size : 0.0);
+    }
+    
+    return Min(Length, Size);
+}
+
+internal b32 MemoryDumpToFile(const char *FilePath)
+{
+    char Text[KB(8)];
+    u64 Length = MemoryFormatSnapshot(Text, sizeof(Text));
+    return WriteEntireFile(FilePath, Text, Length);
+}
+
+#endif //MEMORY_ACCOUNTING_H
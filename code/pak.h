@@ -0,0 +1,166 @@
+/* date = October 17th 2026 4:10 pm */
+
+#ifndef PAK_H
+#define PAK_H
+
+// NOTE(jdiaz): Packed asset archive. A single file holding every asset, built offline by
+// pak_builder.cpp and memory mapped at runtime, so loading an asset is a lookup in the table of
+// contents instead of an open/read/close per file.
+//
+// Layout (little endian):
+//   pak_header
+//   pak_entry[EntryCount]   sorted by NameHash (ties by name), binary searched
+//   names                   NameSize bytes, NUL terminated names
+//   payloads                each one starts at a PAK_ALIGNMENT boundary
+//
+// Payloads are aligned so they can be consumed in place from the mapping (SPIR-V needs 4 bytes,
+// SIMD loads 16) and do not share cache lines.
+
+#define PAK_MAGIC     0x314B4150 // "PAK1"
+#define PAK_VERSION   1
+#define PAK_ALIGNMENT 64
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct pak_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 EntryCount;
+    u32 NameSize;
+    u64 EntriesOffset;
+    u64 NamesOffset;
+};
+
+struct pak_entry
+{
+    u64 NameHash;
+    u64 Offset;
+    u64 Size;
+    u32 NameOffset;
+    u32 NameLength;
+};
+
+struct pak
+{
+    mapped_file File;
+    pak_entry*  Entries;
+    u32         EntryCount;
+    const char* Names;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// FNV-1a
+inline u64 PakHashName(const char *Name, u32 Length)
+{
+    u64 Hash = 0xcbf29ce484222325ull;
+    for (u32 i = 0; i < Length; ++i)
+    {
+        Hash ^= (u8)Name[i];
+        Hash *= 0x100000001b3ull;
+    }
+    return Hash;
+}
+
+// TOC order, by hash first and by name for the (unlikely) collisions
+inline i32 PakCompareEntry(u64 HashA, const char *NameA, u32 LengthA, u64 HashB, const char *NameB, u32 LengthB)
+{
+    if (HashA != HashB) {
+        return HashA < HashB ? -1 : 1;
+    }
+    
+    u32 Length = Min(LengthA, LengthB);
+    for (u32 i = 0; i < Length; ++i)
+    {
+        if (NameA[i] != NameB[i]) {
+            return (u8)NameA[i] < (u8)NameB[i] ? -1 : 1;
+        }
+    }
+    return (LengthA == LengthB) ? 0 : (LengthA < LengthB ? -1 : 1);
+}
+
+#if !defined(PAK_BUILDER)
+
+// Maps the archive and validates the table of contents, the payloads are only touched on use
+internal b32 PakOpen(pak *Pak, const char *FilePath)
+{
+    *Pak = {};
+    
+    mapped_file File = PlatformMapFile(FilePath);
+    if (!File.Bytes) {
+        return false;
+    }
+    
+    pak_header *Header = (pak_header*)File.Bytes;
+    
+    b32 Valid = File.ByteCount >= sizeof(pak_header) &&
+        Header->Magic   == PAK_MAGIC &&
+        Header->Version == PAK_VERSION &&
+        Header->EntriesOffset + (u64)Header->EntryCount * sizeof(pak_entry) <= File.ByteCount &&
+        Header->NamesOffset + Header->NameSize <= File.ByteCount;
+    
+    pak_entry *Entries = (pak_entry*)(File.Bytes + Header->EntriesOffset);
+    for (u32 i = 0; Valid && i < Header->EntryCount; ++i)
+    {
+        Valid = Entries[i].Offset + Entries[i].Size <= File.ByteCount &&
+            (u64)Entries[i].NameOffset + Entries[i].NameLength < Header->NameSize;
+    }
+    
+    if (!Valid)
+    {
+        PlatformUnmapFile(&File);
+        return false;
+    }
+    
+    Pak->File       = File;
+    Pak->Entries    = Entries;
+    Pak->EntryCount = Header->EntryCount;
+    Pak->Names      = (const char*)(File.Bytes + Header->NamesOffset);
+    return true;
+}
+
+internal void PakClose(pak *Pak)
+{
+    PlatformUnmapFile(&Pak->File);
+    *Pak = {};
+}
+
+// Returns the payload straight from the mapping (valid until PakClose), or a zeroed result
+internal read_file_result PakFind(pak *Pak, const char *Name)
+{
+    read_file_result Res = {};
+    
+    u32 Length = (u32)strlen(Name);
+    u64 Hash   = PakHashName(Name, Length);
+    
+    u32 Lo = 0;
+    u32 Hi = Pak->EntryCount;
+    while (Lo < Hi)
+    {
+        u32 Mid = Lo + (Hi - Lo) / 2;
+        pak_entry *Entry = Pak->Entries + Mid;
+        
+        i32 Cmp = PakCompareEntry(Hash, Name, Length, Entry->NameHash, Pak->Names + Entry->NameOffset, Entry->NameLength);
+        if (Cmp == 0)
+        {
+            Assert(Entry->Size < U32_MAX);
+            Res.Bytes     = Pak->File.Bytes + Entry->Offset;
+            Res.ByteCount = (u32)Entry->Size;
+            break;
+        }
+        
+        if (Cmp < 0) {
+            Hi = Mid;
+        } else {
+            Lo = Mid + 1;
+        }
+    }
+    
+    return Res;
+}
+
+#endif // !PAK_BUILDER
+
+#endif //PAK_H
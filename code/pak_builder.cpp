@@ -0,0 +1,182 @@
+// NOTE(jdiaz): Offline tool that packs loose asset files into a pak archive (see pak.h).
+// Usage: pak_builder <output.pak> <file>...
+// Every file is stored under its file name without the directory, which is the name used to
+// look it up at runtime.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+
+#define PAK_BUILDER
+#include "pak.h"
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct pak_input
+{
+    const char* Path;
+    const char* Name;
+    u32         NameLength;
+    u64         NameHash;
+    u8*         Bytes;
+    u64         Size;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal const char* PakBuilderFileName(const char *Path)
+{
+    const char* Name = Path;
+    for (const char* C = Path; *C; ++C)
+    {
+        if (*C == '/' || *C == '\\') {
+            Name = C + 1;
+        }
+    }
+    return Name;
+}
+
+internal b32 PakBuilderReadFile(pak_input *Input)
+{
+    FILE* File = fopen(Input->Path, "rb");
+    if (!File) {
+        return false;
+    }
+    
+    fseek(File, 0, SEEK_END);
+    Input->Size  = (u64)ftell(File);
+    fseek(File, 0, SEEK_SET);
+    
+    Input->Bytes = (u8*)malloc(Input->Size + 1);
+    b32 Res = Input->Bytes && fread(Input->Bytes, 1, Input->Size, File) == Input->Size;
+    
+    fclose(File);
+    return Res;
+}
+
+internal int PakBuilderCompareInputs(const void *A, const void *B)
+{
+    const pak_input* InputA = (const pak_input*)A;
+    const pak_input* InputB = (const pak_input*)B;
+    return PakCompareEntry(InputA->NameHash, InputA->Name, InputA->NameLength,
+                           InputB->NameHash, InputB->Name, InputB->NameLength);
+}
+
+internal u64 PakBuilderWritePadding(FILE *File, u64 Offset)
+{
+    local_persist u8 Zeros[PAK_ALIGNMENT] = {};
+    
+    u64 Padding = (PAK_ALIGNMENT - (Offset & (PAK_ALIGNMENT - 1))) & (PAK_ALIGNMENT - 1);
+    fwrite(Zeros, 1, Padding, File);
+    return Offset + Padding;
+}
+
+int main(int ArgCount, char **Args)
+{
+    if (ArgCount < 3)
+    {
+        fprintf(stderr, "Usage: %s <output.pak> <file>...\n", Args[0]);
+        return 1;
+    }
+    
+    const char* OutputPath = Args[1];
+    u32 InputCount = ArgCount - 2;
+    pak_input* Inputs = (pak_input*)calloc(InputCount, sizeof(pak_input));
+    
+    u32 NameSize = 0;
+    
+    for (u32 i = 0; i < InputCount; ++i)
+    {
+        pak_input *Input = Inputs + i;
+        Input->Path       = Args[i + 2];
+        Input->Name       = PakBuilderFileName(Input->Path);
+        Input->NameLength = (u32)strlen(Input->Name);
+        Input->NameHash   = PakHashName(Input->Name, Input->NameLength);
+        
+        if (!PakBuilderReadFile(Input))
+        {
+            fprintf(stderr, "Could not read %s\n", Input->Path);
+            return 1;
+        }
+        
+        NameSize += Input->NameLength + 1;
+    }
+    
+    qsort(Inputs, InputCount, sizeof(pak_input), PakBuilderCompareInputs);
+    
+    for (u32 i = 1; i < InputCount; ++i)
+    {
+        if (PakBuilderCompareInputs(Inputs + i - 1, Inputs + i) == 0)
+        {
+            fprintf(stderr, "%s and %s are both stored as %s\n", Inputs[i - 1].Path, Inputs[i].Path, Inputs[i].Name);
+            return 1;
+        }
+    }
+    
+    // Table of contents
+    
+    pak_header Header = {};
+    Header.Magic         = PAK_MAGIC;
+    Header.Version       = PAK_VERSION;
+    Header.EntryCount    = InputCount;
+    Header.NameSize      = NameSize;
+    Header.EntriesOffset = sizeof(pak_header);
+    Header.NamesOffset   = Header.EntriesOffset + InputCount * sizeof(pak_entry);
+    
+    pak_entry* Entries = (pak_entry*)calloc(InputCount, sizeof(pak_entry));
+    
+    u32 NameOffset = 0;
+    u64 Offset     = Header.NamesOffset + NameSize;
+    
+    for (u32 i = 0; i < InputCount; ++i)
+    {
+        Offset = (Offset + PAK_ALIGNMENT - 1) & ~(u64)(PAK_ALIGNMENT - 1);
+        
+        Entries[i].NameHash   = Inputs[i].NameHash;
+        Entries[i].Offset     = Offset;
+        Entries[i].Size       = Inputs[i].Size;
+        Entries[i].NameOffset = NameOffset;
+        Entries[i].NameLength = Inputs[i].NameLength;
+        
+        Offset     += Inputs[i].Size;
+        NameOffset += Inputs[i].NameLength + 1;
+    }
+    
+    // Write
+    
+    FILE* File = fopen(OutputPath, "wb");
+    if (!File)
+    {
+        fprintf(stderr, "Could not create %s\n", OutputPath);
+        return 1;
+    }
+    
+    fwrite(&Header, sizeof(Header), 1, File);
+    fwrite(Entries, sizeof(pak_entry), InputCount, File);
+    for (u32 i = 0; i < InputCount; ++i)
+    {
+        fwrite(Inputs[i].Name, 1, Inputs[i].NameLength + 1, File);
+    }
+    
+    Offset = Header.NamesOffset + NameSize;
+    for (u32 i = 0; i < InputCount; ++i)
+    {
+        Offset = PakBuilderWritePadding(File, Offset);
+        Assert(Offset == Entries[i].Offset);
+        
+        fwrite(Inputs[i].Bytes, 1, Inputs[i].Size, File);
+        Offset += Inputs[i].Size;
+    }
+    
+    if (ferror(File) || fclose(File) != 0)
+    {
+        fprintf(stderr, "Could not write %s\n", OutputPath);
+        return 1;
+    }
+    
+    printf("%s: %u files, %llu bytes\n", OutputPath, InputCount, Offset);
+    return 0;
+}
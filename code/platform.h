@@ -3,17 +3,19 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include <stddef.h> // offsetof
+
 typedef char                   i8;
 typedef short int              i16;
-typedef long int               i32;
+typedef int                    i32;
 typedef long long int          i64;
 
 typedef unsigned char          u8;
 typedef unsigned short int     u16;
-typedef unsigned long  int     u32;
+typedef unsigned int           u32;
 typedef unsigned long long int u64;
 
-typedef unsigned long  int     b32;
+typedef unsigned int           b32;
 
 typedef float                  f32;
 typedef double                 f64;
@@ -21,6 +23,7 @@ typedef double                 f64;
 #define U8_MAX                 255
 #define U16_MAX                65535
 #define U32_MAX                4294967295
+#define F32_MAX                3.402823466e+38f
 
 #define LO_WORD(val) (0xFFFF &  val     )
 #define HI_WORD(val) (0xFFFF & (val>>16))
@@ -29,27 +32,27 @@ typedef double                 f64;
 
 #define Assert(test) if (!(test)) *((volatile int*)0) = 0
 
-#if 1 // Pre C++11 way of compile time asserts
+#if __cplusplus < 201103L && !defined(_MSC_VER) // Pre C++11 way of compile time asserts
 #define CTAssert3(Expr, Line) struct CTAssert_____##Line {int Foo[(Expr) ? 1 : - 1];};
 #define CTAssert2(Expr, Line) CTAssert3(Expr, Line)
-#define CTAssert (Expr) CTAssert2(Expr, __LINE__)
+#define CTAssert(Expr) CTAssert2(Expr, __LINE__)
 #else
-#define CTAssert (Expr) static_assert(Expr, "Assertion failed: "#Expr)
+#define CTAssert(Expr) static_assert(Expr, "Assertion failed: " #Expr)
 #endif
 
 #define NotImplemented Assert(!"Not implemented")
 
-#define KB(n) (  (n)*1024)
+#define KB(n) ((u64)(n)*1024)
 #define MB(n) (KB(n)*1024)
 #define GB(n) (MB(n)*1024)
 #define TB(n) (GB(n)*1024)
 
 #define ArrayCount(Array) (sizeof(Array) / sizeof((Array)[0]))
 
-#define OffsetOf(Type, Member) ((u32)&(((Type*)0)->Member))
+#define OffsetOf(Type, Member) ((u32)offsetof(Type, Member)) // usable in CTAssert
 
-#define Max(a, b) (((a)>(b))?(a):(a))
-#define Min(a, b) (((a)<(b))?(a):(a))
+#define Max(a, b) (((a)>(b))?(a):(b))
+#define Min(a, b) (((a)<(b))?(a):(b))
 
 #define internal static
 
@@ -57,4 +60,153 @@ typedef double                 f64;
 
 #define PI 3.14159265359
 
+// NOTE(jdiaz): Minimal atomics. The MSVC versions rely on x86/x64 ordering (plain loads and stores
+// already have acquire/release semantics there), so only the compiler has to be kept in check.
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+inline u32 AtomicLoadAcquire(volatile u32 *Value)
+{
+    u32 Res = *Value;
+    _ReadWriteBarrier();
+    return Res;
+}
+
+inline void AtomicStoreRelease(volatile u32 *Value, u32 NewValue)
+{
+    _ReadWriteBarrier();
+    *Value = NewValue;
+}
+
+// Returns the value after the increment
+inline u32 AtomicIncrement(volatile u32 *Value)
+{
+    return (u32)_InterlockedIncrement((volatile long*)Value);
+}
+
+// Returns the value after the decrement
+inline u32 AtomicDecrement(volatile u32 *Value)
+{
+    return (u32)_InterlockedDecrement((volatile long*)Value);
+}
+
+// Returns the value after the addition
+inline u32 AtomicAdd(volatile u32 *Value, u32 Addend)
+{
+    return (u32)_InterlockedExchangeAdd((volatile long*)Value, (long)Addend) + Addend;
+}
+
+// Returns the value found in Value before the exchange
+inline u32 AtomicCompareExchange(volatile u32 *Value, u32 Expected, u32 NewValue)
+{
+    return (u32)_InterlockedCompareExchange((volatile long*)Value, (long)NewValue, (long)Expected);
+}
+
+// Returns the value after the addition
+inline u64 AtomicAdd64(volatile u64 *Value, u64 Addend)
+{
+    return (u64)_InterlockedExchangeAdd64((volatile __int64*)Value, (__int64)Addend) + Addend;
+}
+
+// Returns the value found in Value before the exchange
+inline u64 AtomicCompareExchange64(volatile u64 *Value, u64 Expected, u64 NewValue)
+{
+    return (u64)_InterlockedCompareExchange64((volatile __int64*)Value, (__int64)NewValue, (__int64)Expected);
+}
+
+inline void AtomicFullBarrier()
+{
+    _mm_mfence();
+}
+
+inline void CpuPause()
+{
+    _mm_pause();
+}
+#else
+inline u32 AtomicLoadAcquire(volatile u32 *Value)
+{
+    return __atomic_load_n(Value, __ATOMIC_ACQUIRE);
+}
+
+inline void AtomicStoreRelease(volatile u32 *Value, u32 NewValue)
+{
+    __atomic_store_n(Value, NewValue, __ATOMIC_RELEASE);
+}
+
+inline u32 AtomicIncrement(volatile u32 *Value)
+{
+    return __atomic_add_fetch(Value, 1, __ATOMIC_SEQ_CST);
+}
+
+inline u32 AtomicDecrement(volatile u32 *Value)
+{
+    return __atomic_sub_fetch(Value, 1, __ATOMIC_SEQ_CST);
+}
+
+inline u32 AtomicAdd(volatile u32 *Value, u32 Addend)
+{
+    return __atomic_add_fetch(Value, Addend, __ATOMIC_SEQ_CST);
+}
+
+inline u32 AtomicCompareExchange(volatile u32 *Value, u32 Expected, u32 NewValue)
+{
+    __atomic_compare_exchange_n(Value, &Expected, NewValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return Expected;
+}
+
+inline u64 AtomicAdd64(volatile u64 *Value, u64 Addend)
+{
+    return __atomic_add_fetch(Value, Addend, __ATOMIC_SEQ_CST);
+}
+
+inline u64 AtomicCompareExchange64(volatile u64 *Value, u64 Expected, u64 NewValue)
+{
+    __atomic_compare_exchange_n(Value, &Expected, NewValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return Expected;
+}
+
+inline void AtomicFullBarrier()
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+inline void CpuPause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+#endif
+
+enum { PlatformError_Fatal, PlatformError_Warning };
+
+// Pages backing the big memory blocks (arena and scratch reservation)
+enum memory_backing
+{
+    MemoryBacking_SmallPages,
+    MemoryBacking_LargePages,           // MEM_LARGE_PAGES / MAP_HUGETLB
+    MemoryBacking_TransparentHugePages, // MADV_HUGEPAGE, huge pages when the kernel can provide them
+};
+
+internal const char* MemoryBackingNames[] =
+{
+    "4KB pages",
+    "large pages",
+    "transparent huge pages",
+};
+
+struct read_file_result
+{
+    u8* Bytes;
+    u32 ByteCount;
+};
+
+// NOTE(jdiaz): Read-only view of a whole file, backed by the OS page cache (no heap copy)
+struct mapped_file
+{
+    u8* Bytes;
+    u64 ByteCount;
+};
+
 #endif //PLATFORM_H
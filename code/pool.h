@@ -0,0 +1,406 @@
+/* date = October 17th 2026 7:05 pm */
+
+#ifndef POOL_H
+#define POOL_H
+
+// NOTE(jdiaz): Fixed size pool allocator for objects created and destroyed at runtime. Slots are
+// carved from an arena in batches and recycled through an intrusive free list (the link is stored
+// in the free slot itself), so PoolAlloc and PoolFree are O(1) and the memory never fragments.
+// Slots are cache line aligned and sized, two objects never share a line.
+//
+// Pool_ThreadSafe pools can be used from any thread: every thread keeps a small cache of free
+// slots and only takes the pool lock to move POOL_THREAD_CACHE_SIZE / 2 slots at once between its
+// cache and the shared free list, or to carve a new batch from the arena (which then has to be
+// used by the pool only).
+//
+// Threads get their cache index the first time they touch a thread safe pool and give it back when
+// they exit (the driver creates and destroys threads all the time), the slots left in their caches
+// go back to the shared lists first. Past POOL_MAX_THREADS live threads the new ones have no cache
+// and take the lock on every alloc and free.
+//
+// With POOL_DEBUG free slots are poisoned, PoolAlloc checks the poison is intact (catches writes
+// after free) and PoolFree checks the slot is not already free. It touches the whole slot on every
+// alloc and free, so it is off unless the build defines POOL_DEBUG=1 (see scripts/build.*).
+//
+// GPU resources (textures, mesh buffers...) do not use pools, their slots are recycled by the
+// generational handle tables in vulkan_resources.h, which keep the hot handles packed.
+
+#if !defined(POOL_DEBUG)
+#define POOL_DEBUG 0
+#endif
+
+#define POOL_SLOT_ALIGNMENT    64
+#define POOL_MAX_THREADS       128
+#define POOL_MAX_SHARED_POOLS  32     // live thread safe pools
+#define POOL_NO_THREAD_CACHE   (U32_MAX - 1)
+#define POOL_THREAD_CACHE_SIZE 32
+#define POOL_POISON_BYTE       0xDD
+#define POOL_FREE_MAGIC        0xF4EEF4EEF4EEF4EEull
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+enum pool_flags
+{
+    Pool_ThreadSafe = 0x1,
+    Pool_NoZero     = 0x2, // PoolAlloc leaves the slot as it was
+};
+
+struct pool_free_slot
+{
+    pool_free_slot* Next;
+#if POOL_DEBUG
+    u64             Magic;
+#endif
+};
+
+struct pool_thread_cache
+{
+    alignas(64) pool_free_slot* FreeList;
+    u32                         Count;
+};
+
+struct pool
+{
+    arena*          Arena;    // where batches are carved from
+    u64             SlotSize;
+    u32             SlotsPerBatch;
+    u32             Flags;
+    
+    volatile u32    Lock;
+    pool_free_slot* FreeList; // shared list, under Lock for thread safe pools
+    
+    // Stats
+    volatile u32    LiveCount;
+    u32             SlotCount;
+    
+    pool_thread_cache* ThreadCaches; // POOL_MAX_THREADS, thread safe pools only
+};
+
+struct pool_thread
+{
+    u32 Index = U32_MAX; // in the ThreadCaches, POOL_NO_THREAD_CACHE when all were taken
+    
+    ~pool_thread(); // drains the caches and gives the index back when the thread exits
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal volatile u32 PoolThreadIndexUsed[POOL_MAX_THREADS];
+internal thread_local pool_thread PoolThread;
+
+// Thread safe pools, so exiting threads can drain their caches
+internal volatile u32 PoolSharedLock;
+internal pool*        PoolShared[POOL_MAX_SHARED_POOLS];
+internal u32          PoolSharedCount;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+inline void PoolSharedLockAcquire()
+{
+    while (AtomicCompareExchange(&PoolSharedLock, 0, 1) != 0)
+    {
+        CpuPause();
+    }
+}
+
+inline void PoolSharedLockRelease()
+{
+    AtomicStoreRelease(&PoolSharedLock, 0);
+}
+
+internal void PoolInit(pool *Pool, arena *Arena, u64 Size, u32 SlotsPerBatch, u32 Flags)
+{
+    Assert(Size > 0 && SlotsPerBatch > 0);
+    
+    *Pool = {};
+    Pool->Arena         = Arena;
+    Pool->SlotSize      = (Max(Size, sizeof(pool_free_slot)) + POOL_SLOT_ALIGNMENT - 1) & ~(u64)(POOL_SLOT_ALIGNMENT - 1);
+    Pool->SlotsPerBatch = SlotsPerBatch;
+    Pool->Flags         = Flags;
+    
+    if (Flags & Pool_ThreadSafe)
+    {
+        Pool->ThreadCaches = PushArray(Arena, pool_thread_cache, POOL_MAX_THREADS, ArenaPush_Zero);
+        
+        // a pool initialized again (without PoolRelease) is only listed once
+        PoolSharedLockAcquire();
+        u32 Shared = 0;
+        while (Shared < PoolSharedCount && PoolShared[Shared] != Pool)
+        {
+            ++Shared;
+        }
+        if (Shared == PoolSharedCount)
+        {
+            Assert(PoolSharedCount < POOL_MAX_SHARED_POOLS);
+            PoolShared[PoolSharedCount++] = Pool;
+        }
+        PoolSharedLockRelease();
+    }
+}
+
+// Before the arena is cleared, the exiting threads must not drain into it anymore
+internal void PoolRelease(pool *Pool)
+{
+    if (!(Pool->Flags & Pool_ThreadSafe)) {
+        return;
+    }
+    
+    PoolSharedLockAcquire();
+    for (u32 i = 0; i < PoolSharedCount; ++i)
+    {
+        if (PoolShared[i] == Pool)
+        {
+            PoolShared[i] = PoolShared[--PoolSharedCount];
+            break;
+        }
+    }
+    PoolSharedLockRelease();
+}
+
+inline void PoolLock(pool *Pool)
+{
+    while (AtomicCompareExchange(&Pool->Lock, 0, 1) != 0)
+    {
+        CpuPause();
+    }
+}
+
+inline void PoolUnlock(pool *Pool)
+{
+    AtomicStoreRelease(&Pool->Lock, 0);
+}
+
+inline void PoolPoison(pool *Pool, pool_free_slot *Slot)
+{
+#if POOL_DEBUG
+    memset(Slot + 1, POOL_POISON_BYTE, Pool->SlotSize - sizeof(pool_free_slot));
+    Slot->Magic = POOL_FREE_MAGIC;
+#endif
+}
+
+inline void PoolCheckPoison(pool *Pool, pool_free_slot *Slot)
+{
+#if POOL_DEBUG
+    Assert(Slot->Magic == POOL_FREE_MAGIC);
+    u8* Bytes = (u8*)(Slot + 1);
+    for (u64 i = 0; i < Pool->SlotSize - sizeof(pool_free_slot); ++i)
+    {
+        Assert(Bytes[i] == POOL_POISON_BYTE); // written after being freed
+    }
+#endif
+}
+
+// Carves SlotsPerBatch new slots from the arena and links them, returns the first one
+internal pool_free_slot* PoolCarveBatch(pool *Pool)
+{
+    u8* Batch = PushSize(Pool->Arena, Pool->SlotSize * Pool->SlotsPerBatch, POOL_SLOT_ALIGNMENT);
+    Pool->SlotCount += Pool->SlotsPerBatch;
+    
+    for (u32 i = 0; i < Pool->SlotsPerBatch; ++i)
+    {
+        pool_free_slot *Slot = (pool_free_slot*)(Batch + i * Pool->SlotSize);
+        Slot->Next = (i + 1 < Pool->SlotsPerBatch) ? (pool_free_slot*)(Batch + (i + 1) * Pool->SlotSize) : 0;
+        PoolPoison(Pool, Slot);
+    }
+    
+    return (pool_free_slot*)Batch;
+}
+
+// First free index, or POOL_NO_THREAD_CACHE when POOL_MAX_THREADS threads hold one
+internal u32 PoolAcquireThreadIndex()
+{
+    for (u32 Index = 0; Index < POOL_MAX_THREADS; ++Index)
+    {
+        if (!PoolThreadIndexUsed[Index] && AtomicCompareExchange(PoolThreadIndexUsed + Index, 0, 1) == 0) {
+            return Index;
+        }
+    }
+    return POOL_NO_THREAD_CACHE;
+}
+
+// NULL when the thread has no cache, the shared list is used under the lock then
+inline pool_thread_cache* PoolGetThreadCache(pool *Pool)
+{
+    if (PoolThread.Index == U32_MAX) {
+        PoolThread.Index = PoolAcquireThreadIndex();
+    }
+    if (PoolThread.Index == POOL_NO_THREAD_CACHE) {
+        return NULL;
+    }
+    return Pool->ThreadCaches + PoolThread.Index;
+}
+
+// Moves up to Count slots from the shared list to the cache, carving a batch if it is empty
+internal void PoolRefillCache(pool *Pool, pool_thread_cache *Cache, u32 Count)
+{
+    PoolLock(Pool);
+    
+    if (!Pool->FreeList) {
+        Pool->FreeList = PoolCarveBatch(Pool);
+    }
+    
+    while (Pool->FreeList && Cache->Count < Count)
+    {
+        pool_free_slot *Slot = Pool->FreeList;
+        Pool->FreeList  = Slot->Next;
+        Slot->Next      = Cache->FreeList;
+        Cache->FreeList = Slot;
+        Cache->Count++;
+    }
+    
+    PoolUnlock(Pool);
+}
+
+// Moves slots from the cache back to the shared list until Count are left in the cache
+internal void PoolDrainCache(pool *Pool, pool_thread_cache *Cache, u32 Count)
+{
+    if (Cache->Count <= Count) {
+        return;
+    }
+    
+    // unlink the extra slots first, the lock is only held to splice them in
+    pool_free_slot *First = Cache->FreeList;
+    pool_free_slot *Last  = First;
+    for (u32 i = 1; i < Cache->Count - Count; ++i)
+    {
+        Last = Last->Next;
+    }
+    Cache->FreeList = Last->Next;
+    Cache->Count    = Count;
+    
+    PoolLock(Pool);
+    Last->Next = Pool->FreeList;
+    Pool->FreeList = First;
+    PoolUnlock(Pool);
+}
+
+// Returns a zeroed slot (unless the pool is Pool_NoZero)
+internal void* PoolAlloc(pool *Pool)
+{
+    pool_free_slot *Slot;
+    
+    if (Pool->Flags & Pool_ThreadSafe)
+    {
+        pool_thread_cache *Cache = PoolGetThreadCache(Pool);
+        if (Cache)
+        {
+            if (!Cache->FreeList) {
+                PoolRefillCache(Pool, Cache, POOL_THREAD_CACHE_SIZE / 2);
+            }
+            
+            Slot = Cache->FreeList;
+            Cache->FreeList = Slot->Next;
+            Cache->Count--;
+        }
+        else
+        {
+            PoolLock(Pool);
+            if (!Pool->FreeList) {
+                Pool->FreeList = PoolCarveBatch(Pool);
+            }
+            Slot = Pool->FreeList;
+            Pool->FreeList = Slot->Next;
+            PoolUnlock(Pool);
+        }
+        AtomicIncrement(&Pool->LiveCount);
+    }
+    else
+    {
+        if (!Pool->FreeList) {
+            Pool->FreeList = PoolCarveBatch(Pool);
+        }
+        
+        Slot = Pool->FreeList;
+        Pool->FreeList = Slot->Next;
+        Pool->LiveCount++;
+    }
+    
+    PoolCheckPoison(Pool, Slot);
+    if (!(Pool->Flags & Pool_NoZero)) {
+        memset(Slot, 0, Pool->SlotSize);
+    }
+    return Slot;
+}
+
+internal void PoolFree(pool *Pool, void *Item)
+{
+    if (!Item) {
+        return;
+    }
+    
+    pool_free_slot *Slot = (pool_free_slot*)Item;
+    Assert(((u64)Slot & (POOL_SLOT_ALIGNMENT - 1)) == 0);
+#if POOL_DEBUG
+    Assert(Slot->Magic != POOL_FREE_MAGIC); // double free
+#endif
+    PoolPoison(Pool, Slot);
+    
+    if (Pool->Flags & Pool_ThreadSafe)
+    {
+        AtomicDecrement(&Pool->LiveCount);
+        
+        pool_thread_cache *Cache = PoolGetThreadCache(Pool);
+        if (Cache)
+        {
+            Slot->Next      = Cache->FreeList;
+            Cache->FreeList = Slot;
+            Cache->Count++;
+            
+            if (Cache->Count >= POOL_THREAD_CACHE_SIZE) {
+                PoolDrainCache(Pool, Cache, POOL_THREAD_CACHE_SIZE / 2);
+            }
+        }
+        else
+        {
+            PoolLock(Pool);
+            Slot->Next = Pool->FreeList;
+            Pool->FreeList = Slot;
+            PoolUnlock(Pool);
+        }
+    }
+    else
+    {
+        Slot->Next = Pool->FreeList;
+        Pool->FreeList = Slot;
+        Pool->LiveCount--;
+    }
+}
+
+pool_thread::~pool_thread()
+{
+    if (Index >= POOL_MAX_THREADS) {
+        return;
+    }
+    
+    // NOTE(jdiaz): The shared lock keeps PoolRelease from clearing a pool while we drain into it
+    PoolSharedLockAcquire();
+    for (u32 i = 0; i < PoolSharedCount; ++i)
+    {
+        PoolDrainCache(PoolShared[i], PoolShared[i]->ThreadCaches + Index, 0);
+    }
+    PoolSharedLockRelease();
+    
+    AtomicStoreRelease(PoolThreadIndexUsed + Index, 0);
+    Index = U32_MAX;
+}
+
+// Typed front end, Pool.Alloc() returns a zeroed type*
+template <typename type>
+struct typed_pool
+{
+    pool Pool;
+    
+    type* Alloc()          { return (type*)PoolAlloc(&Pool); }
+    void  Free(type *Item) { PoolFree(&Pool, Item); }
+};
+
+template <typename type>
+internal void PoolInit(typed_pool<type> *Pool, arena *Arena, u32 SlotsPerBatch, u32 Flags = 0)
+{
+    static_assert(alignof(type) <= POOL_SLOT_ALIGNMENT, "Pool slots are not aligned enough for this type");
+    PoolInit(&Pool->Pool, Arena, sizeof(type), SlotsPerBatch, Flags);
+}
+
+#endif //POOL_H
@@ -0,0 +1,102 @@
+/* date = October 17th 2026 9:30 pm */
+
+#ifndef STBI_ARENA_H
+#define STBI_ARENA_H
+
+// NOTE(jdiaz): stb_image allocations (output image, zlib buffers, JPEG component planes...) go to
+// the arena bound to the calling thread with StbiBindArena, never to the heap, so decodes running
+// on different workers do not contend on the malloc lock. Every allocation is preceded by its size,
+// freeing or growing the last allocation of the arena is done in place (stb_image frees most of its
+// temporaries in reverse order), anything else is left for the owner of the arena to reset once
+// the image has been consumed.
+//
+// When the arena is fixed size and the allocation does not fit, stb_image gets NULL and fails the
+// decode cleanly ("outofmem").
+//
+// Has to be included before stb_image.h.
+
+#define STBI_ARENA_HEADER_SIZE 16
+
+#define STBI_MALLOC(Size)                        StbiArenaAlloc(Size)
+#define STBI_REALLOC_SIZED(Ptr, OldSize, NewSize) StbiArenaRealloc(Ptr, NewSize)
+#define STBI_FREE(Ptr)                           StbiArenaFree(Ptr)
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal thread_local arena* StbiArena;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// Binds the arena the decodes of this thread allocate from, 0 unbinds it
+inline void StbiBindArena(arena *Arena)
+{
+    StbiArena = Arena;
+}
+
+inline u64* StbiArenaHeader(void *Ptr)
+{
+    return (u64*)((u8*)Ptr - STBI_ARENA_HEADER_SIZE);
+}
+
+// The allocation ends at the arena head, so it can be popped or resized in place
+inline b32 StbiArenaIsLast(arena *Arena, void *Ptr)
+{
+    return (u8*)Ptr + *StbiArenaHeader(Ptr) == Arena->Buffer + Arena->Head;
+}
+
+internal void* StbiArenaAlloc(u64 Size)
+{
+    arena *Arena = StbiArena;
+    Assert(Arena); // decodes only run with an arena bound, see StbiBindArena
+    
+    u64 Total = STBI_ARENA_HEADER_SIZE + Size;
+    if (Arena->Flags & Arena_FixedSize)
+    {
+        if (Arena->Head + ArenaAlignmentOffset(Arena, 16) + Total > Arena->Size) {
+            return 0;
+        }
+    }
+    
+    u8* Block = PushSize(Arena, Total, 16);
+    *(u64*)Block = Size;
+    return Block + STBI_ARENA_HEADER_SIZE;
+}
+
+internal void StbiArenaFree(void *Ptr)
+{
+    arena *Arena = StbiArena;
+    if (Ptr && Arena && StbiArenaIsLast(Arena, Ptr)) {
+        Arena->Head = (u8*)StbiArenaHeader(Ptr) - Arena->Buffer;
+    }
+}
+
+internal void* StbiArenaRealloc(void *Ptr, u64 NewSize)
+{
+    if (!Ptr) {
+        return StbiArenaAlloc(NewSize);
+    }
+    
+    arena *Arena = StbiArena;
+    u64   *Header = StbiArenaHeader(Ptr);
+    
+    if (StbiArenaIsLast(Arena, Ptr))
+    {
+        u64 Offset = (u8*)Ptr - Arena->Buffer;
+        if (Offset + NewSize <= Arena->Size)
+        {
+            Arena->Head = Offset + NewSize;
+            Arena->HighWater = Max(Arena->HighWater, ArenaUsed(Arena));
+            *Header = NewSize;
+            return Ptr;
+        }
+    }
+    
+    void* Res = StbiArenaAlloc(NewSize);
+    if (Res) {
+        memcpy(Res, Ptr, Min(*Header, NewSize));
+    }
+    return Res;
+}
+
+#endif //STBI_ARENA_H
@@ -0,0 +1,267 @@
+/* date = October 17th 2026 11:45 pm */
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+// NOTE(jdiaz): Batch transforms. Positions, rotations (unit quaternions) and scales live in
+// separate arrays, so 4 objects fill one f32x4 per component and every matrix element of 4 objects
+// is computed at once. The world and MVP matrices are transposed back to one matrix per object only
+// when they are stored, straight into the destination (usually a mapped GPU buffer, written front
+// to back in whole 16 byte stores, which is what write-combined memory wants).
+//
+// Objects can be placed under parents: every TRANSFORM_GROUP_OBJECTS consecutive objects share one
+// parent world matrix (usually from a transform_hierarchy, see transform_hierarchy.h), and their
+// positions, rotations and scales are relative to it. Parents have to be affine.
+//
+// TransformBatchParallel splits the objects into jobs of TRANSFORM_JOB_OBJECTS and waits for them.
+
+#define TRANSFORM_GROUP_OBJECTS 64   // objects per parent, multiple of 4
+#define TRANSFORM_JOB_OBJECTS   2048 // multiple of TRANSFORM_GROUP_OBJECTS
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+// Capacity is rounded up to a multiple of 4, the padding lanes hold identity transforms
+struct transform_soa
+{
+    u32  Count;
+    u32  Capacity;
+    f32* PositionX;
+    f32* PositionY;
+    f32* PositionZ;
+    f32* RotationX;
+    f32* RotationY;
+    f32* RotationZ;
+    f32* RotationW;
+    f32* ScaleX;
+    f32* ScaleY;
+    f32* ScaleZ;
+};
+
+// NOTE: Matches ObjectTransform in vertex_shader.glsl (std430)
+struct object_transform
+{
+    mat4 World;
+    mat4 MVP;
+};
+
+CTAssert(sizeof(object_transform) == 128 && alignof(object_transform) == 16);
+CTAssert(OffsetOf(object_transform, World) == 0 && OffsetOf(object_transform, MVP) == 64);
+CTAssert(TRANSFORM_JOB_OBJECTS % TRANSFORM_GROUP_OBJECTS == 0 && (TRANSFORM_GROUP_OBJECTS & (TRANSFORM_GROUP_OBJECTS - 1)) == 0);
+
+struct transform_batch_job
+{
+    const transform_soa* Transforms;
+    u32                  First;
+    u32                  Count;
+    const mat4*          ViewProj;
+    const mat4*          Parents;
+    object_transform*    Dest;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal void TransformSoAInit(transform_soa *Transforms, arena *Arena, u32 Capacity)
+{
+    Capacity = (Capacity + 3) & ~3u;
+    
+    f32** Arrays[] = {
+        &Transforms->PositionX, &Transforms->PositionY, &Transforms->PositionZ,
+        &Transforms->RotationX, &Transforms->RotationY, &Transforms->RotationZ, &Transforms->RotationW,
+        &Transforms->ScaleX,    &Transforms->ScaleY,    &Transforms->ScaleZ,
+    };
+    for (u32 i = 0; i < ArrayCount(Arrays); ++i) {
+        *Arrays[i] = (f32*)PushSize(Arena, Capacity * sizeof(f32), 16);
+    }
+    
+    Transforms->Count    = 0;
+    Transforms->Capacity = Capacity;
+    
+    for (u32 i = 0; i < Capacity; ++i)
+    {
+        Transforms->PositionX[i] = Transforms->PositionY[i] = Transforms->PositionZ[i] = 0.0f;
+        Transforms->RotationX[i] = Transforms->RotationY[i] = Transforms->RotationZ[i] = 0.0f;
+        Transforms->RotationW[i] = 1.0f;
+        Transforms->ScaleX[i]    = Transforms->ScaleY[i]    = Transforms->ScaleZ[i]    = 1.0f;
+    }
+}
+
+// Rotation is a unit quaternion (x, y, z, w), see Quaternion
+internal void TransformSet(transform_soa *Transforms, u32 Index, const vec3 &Position, const vec4 &Rotation, const vec3 &Scale)
+{
+    Assert(Index < Transforms->Count);
+    Transforms->PositionX[Index] = Position.x;
+    Transforms->PositionY[Index] = Position.y;
+    Transforms->PositionZ[Index] = Position.z;
+    Transforms->RotationX[Index] = Rotation.x;
+    Transforms->RotationY[Index] = Rotation.y;
+    Transforms->RotationZ[Index] = Rotation.z;
+    Transforms->RotationW[Index] = Rotation.w;
+    Transforms->ScaleX[Index]    = Scale.x;
+    Transforms->ScaleY[Index]    = Scale.y;
+    Transforms->ScaleZ[Index]    = Scale.z;
+}
+
+internal u32 TransformAdd(transform_soa *Transforms, const vec3 &Position, const vec4 &Rotation, const vec3 &Scale)
+{
+    Assert(Transforms->Count < Transforms->Capacity);
+    u32 Index = Transforms->Count++;
+    TransformSet(Transforms, Index, Position, Rotation, Scale);
+    return Index;
+}
+
+// Objects [First, First + Count) to Dest[First...], World = Parent * T * R * S and
+// MVP = ViewProj * World. Parents holds one matrix per TRANSFORM_GROUP_OBJECTS objects, or is NULL
+// when the objects are not under anything. First has to be a multiple of 4.
+internal void TransformBatch(const transform_soa *Transforms, u32 First, u32 Count, const mat4 &ViewProj, const mat4 *Parents, object_transform *Dest)
+{
+    Assert((First & 3) == 0 && First + Count <= Transforms->Count);
+    Assert(((u64)Dest & 15) == 0);
+    
+    // ViewProj elements, broadcast once: VP[Column][Row]
+    f32x4 VP[4][4];
+    for (u32 c = 0; c < 4; ++c)
+    {
+        for (u32 r = 0; r < 4; ++r) {
+            VP[c][r] = F32x4Set1(ViewProj.data[c][r]);
+        }
+    }
+    
+    f32x4 One  = F32x4Set1(1.0f);
+    f32x4 Two  = F32x4Set1(2.0f);
+    f32x4 Zero = F32x4Zero();
+    
+    // Parent elements of the current group, P[Column][Row], the last row is (0 0 0 1)
+    f32x4 P[4][3];
+    
+    for (u32 Index = First; Index < First + Count; Index += 4)
+    {
+        u32 LaneCount = Min(4u, First + Count - Index);
+        
+        if (Parents && (Index == First || (Index & (TRANSFORM_GROUP_OBJECTS - 1)) == 0))
+        {
+            const mat4 &Parent = Parents[Index / TRANSFORM_GROUP_OBJECTS];
+            for (u32 c = 0; c < 4; ++c)
+            {
+                for (u32 r = 0; r < 3; ++r) {
+                    P[c][r] = F32x4Set1(Parent.data[c][r]);
+                }
+            }
+        }
+        
+        f32x4 qx = F32x4Load(Transforms->RotationX + Index);
+        f32x4 qy = F32x4Load(Transforms->RotationY + Index);
+        f32x4 qz = F32x4Load(Transforms->RotationZ + Index);
+        f32x4 qw = F32x4Load(Transforms->RotationW + Index);
+        f32x4 sx = F32x4Load(Transforms->ScaleX + Index);
+        f32x4 sy = F32x4Load(Transforms->ScaleY + Index);
+        f32x4 sz = F32x4Load(Transforms->ScaleZ + Index);
+        
+        f32x4 xx = F32x4Mul(qx, qx), yy = F32x4Mul(qy, qy), zz = F32x4Mul(qz, qz);
+        f32x4 xy = F32x4Mul(qx, qy), xz = F32x4Mul(qx, qz), yz = F32x4Mul(qy, qz);
+        f32x4 wx = F32x4Mul(qw, qx), wy = F32x4Mul(qw, qy), wz = F32x4Mul(qw, qz);
+        
+        // W[Column][Row], the upper 3x3 is R * S, the last row is (0 0 0 1)
+        f32x4 W[4][3];
+        W[0][0] = F32x4Mul(F32x4Sub(One, F32x4Mul(Two, F32x4Add(yy, zz))), sx);
+        W[0][1] = F32x4Mul(F32x4Mul(Two, F32x4Add(xy, wz)), sx);
+        W[0][2] = F32x4Mul(F32x4Mul(Two, F32x4Sub(xz, wy)), sx);
+        W[1][0] = F32x4Mul(F32x4Mul(Two, F32x4Sub(xy, wz)), sy);
+        W[1][1] = F32x4Mul(F32x4Sub(One, F32x4Mul(Two, F32x4Add(xx, zz))), sy);
+        W[1][2] = F32x4Mul(F32x4Mul(Two, F32x4Add(yz, wx)), sy);
+        W[2][0] = F32x4Mul(F32x4Mul(Two, F32x4Add(xz, wy)), sz);
+        W[2][1] = F32x4Mul(F32x4Mul(Two, F32x4Sub(yz, wx)), sz);
+        W[2][2] = F32x4Mul(F32x4Sub(One, F32x4Mul(Two, F32x4Add(xx, yy))), sz);
+        W[3][0] = F32x4Load(Transforms->PositionX + Index);
+        W[3][1] = F32x4Load(Transforms->PositionY + Index);
+        W[3][2] = F32x4Load(Transforms->PositionZ + Index);
+        
+        // W = Parent * W, W[c][3] being 0 or 1 as in the MVP below
+        if (Parents)
+        {
+            f32x4 Local[4][3];
+            memcpy(Local, W, sizeof(Local));
+            for (u32 c = 0; c < 4; ++c)
+            {
+                for (u32 r = 0; r < 3; ++r)
+                {
+                    f32x4 Sum = F32x4Mul(P[0][r], Local[c][0]);
+                    Sum = F32x4MulAdd(P[1][r], Local[c][1], Sum);
+                    Sum = F32x4MulAdd(P[2][r], Local[c][2], Sum);
+                    W[c][r] = (c == 3) ? F32x4Add(Sum, P[3][r]) : Sum;
+                }
+            }
+        }
+        
+        // Column c of the 4 objects, transposed so WorldColumns[c][i] is the column of object i
+        f32x4 WorldColumns[4][4];
+        f32x4 MVPColumns[4][4];
+        for (u32 c = 0; c < 4; ++c)
+        {
+            f32x4 *Column = WorldColumns[c];
+            Column[0] = W[c][0];
+            Column[1] = W[c][1];
+            Column[2] = W[c][2];
+            Column[3] = (c == 3) ? One : Zero;
+            F32x4Transpose(Column[0], Column[1], Column[2], Column[3]);
+            
+            // MVP[c][r] = sum_k VP[k][r] * W[c][k], with W[c][3] being 0 or 1
+            Column = MVPColumns[c];
+            for (u32 r = 0; r < 4; ++r)
+            {
+                f32x4 Sum = F32x4Mul(VP[0][r], W[c][0]);
+                Sum = F32x4MulAdd(VP[1][r], W[c][1], Sum);
+                Sum = F32x4MulAdd(VP[2][r], W[c][2], Sum);
+                Column[r] = (c == 3) ? F32x4Add(Sum, VP[3][r]) : Sum;
+            }
+            F32x4Transpose(Column[0], Column[1], Column[2], Column[3]);
+        }
+        
+        // one whole object_transform after the other
+        for (u32 i = 0; i < LaneCount; ++i)
+        {
+            object_transform *Out = Dest + Index + i;
+            for (u32 c = 0; c < 4; ++c) {
+                F32x4Store(Out->World.data[c], WorldColumns[c][i]);
+            }
+            for (u32 c = 0; c < 4; ++c) {
+                F32x4Store(Out->MVP.data[c], MVPColumns[c][i]);
+            }
+        }
+    }
+}
+
+internal void TransformBatchJob(void *Data)
+{
+    transform_batch_job *Job = (transform_batch_job*)Data;
+    TransformBatch(Job->Transforms, Job->First, Job->Count, *Job->ViewProj, Job->Parents, Job->Dest);
+}
+
+// Every object to Dest[0...Count), split across the job system. Arena holds the job descriptions
+// until they are done.
+internal void TransformBatchParallel(const transform_soa *Transforms, const mat4 &ViewProj, const mat4 *Parents, object_transform *Dest, arena *Arena)
+{
+    u32 JobCount = (Transforms->Count + TRANSFORM_JOB_OBJECTS - 1) / TRANSFORM_JOB_OBJECTS;
+    if (JobCount <= 1)
+    {
+        TransformBatch(Transforms, 0, Transforms->Count, ViewProj, Parents, Dest);
+        return;
+    }
+    
+    transform_batch_job *BatchJobs = PushArray(Arena, transform_batch_job, JobCount);
+    for (u32 i = 0; i < JobCount; ++i)
+    {
+        BatchJobs[i].Transforms = Transforms;
+        BatchJobs[i].First      = i * TRANSFORM_JOB_OBJECTS;
+        BatchJobs[i].Count      = Min((u32)TRANSFORM_JOB_OBJECTS, Transforms->Count - BatchJobs[i].First);
+        BatchJobs[i].ViewProj   = &ViewProj;
+        BatchJobs[i].Parents    = Parents;
+        BatchJobs[i].Dest       = Dest;
+    }
+    
+    job_counter Counter = {};
+    JobRunMany(TransformBatchJob, BatchJobs, sizeof(transform_batch_job), JobCount, &Counter);
+    JobWait(&Counter);
+}
+
+#endif //TRANSFORM_H
@@ -0,0 +1,132 @@
+/* date = October 18th 2026 0:20 am */
+
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+// NOTE(jdiaz): Parent/child transforms, flattened. Nodes are stored depth first (every node comes
+// right after its parent's previous descendants), so parents always come before their children and
+// the subtree of node i is the contiguous range [i, i + SubtreeSize[i]).
+//
+// Changing a local transform only sets the dirty flag of that node. TransformHierarchyUpdate walks
+// the flags, skipping 8 clean nodes at a time, and every dirty node recomputes its whole subtree in
+// order (World = World[Parent] * Local) and jumps past it. Nodes that did not move and are under no
+// node that moved are never touched, their world matrices stay as they were.
+//
+// Nodes have to be added depth first: the parent of a new node is the last node added or one of
+// its ancestors. Removing nodes is not supported, rebuild the hierarchy instead.
+
+#define TRANSFORM_HIERARCHY_ROOT U32_MAX // parent of the top level nodes
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct transform_hierarchy
+{
+    u32   Count;
+    u32   Capacity;
+    u32*  Parent;      // TRANSFORM_HIERARCHY_ROOT for top level nodes
+    u32*  SubtreeSize; // the node itself included
+    u8*   Dirty;       // Capacity rounded up to 8, the padding is never dirty
+    mat4* Local;
+    mat4* World;
+    u32   LastUpdated; // world matrices recomputed by the last update
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal void TransformHierarchyInit(transform_hierarchy *Hierarchy, arena *Arena, u32 Capacity)
+{
+    *Hierarchy = {};
+    Hierarchy->Capacity    = Capacity;
+    Hierarchy->Parent      = PushArray(Arena, u32,  Capacity);
+    Hierarchy->SubtreeSize = PushArray(Arena, u32,  Capacity);
+    Hierarchy->Dirty       = PushArray(Arena, u8,   (Capacity + 7) & ~7u, ArenaPush_Zero);
+    Hierarchy->Local       = PushArray(Arena, mat4, Capacity);
+    Hierarchy->World       = PushArray(Arena, mat4, Capacity);
+}
+
+// Returns the index of the new node, which starts dirty
+internal u32 TransformHierarchyAdd(transform_hierarchy *Hierarchy, u32 Parent, const mat4 &Local)
+{
+    Assert(Hierarchy->Count < Hierarchy->Capacity);
+    u32 Index = Hierarchy->Count++;
+    
+    Hierarchy->Parent[Index]      = Parent;
+    Hierarchy->SubtreeSize[Index] = 1;
+    Hierarchy->Dirty[Index]       = true;
+    Hierarchy->Local[Index]       = Local;
+    Hierarchy->World[Index]       = Local;
+    
+    for (u32 Ancestor = Parent; Ancestor != TRANSFORM_HIERARCHY_ROOT; Ancestor = Hierarchy->Parent[Ancestor])
+    {
+        // depth first: the subtree of every ancestor has to end right where the new node goes
+        Assert(Ancestor + Hierarchy->SubtreeSize[Ancestor] == Index);
+        ++Hierarchy->SubtreeSize[Ancestor];
+    }
+    
+    return Index;
+}
+
+inline void TransformHierarchySetLocal(transform_hierarchy *Hierarchy, u32 Index, const mat4 &Local)
+{
+    Assert(Index < Hierarchy->Count);
+    Hierarchy->Local[Index] = Local;
+    Hierarchy->Dirty[Index] = true;
+}
+
+// First dirty node at or after Index, Count when there is none
+inline u32 TransformHierarchyNextDirty(transform_hierarchy *Hierarchy, u32 Index)
+{
+    // byte by byte up to a multiple of 8, then 8 flags per load
+    for (; Index < Hierarchy->Count && (Index & 7); ++Index)
+    {
+        if (Hierarchy->Dirty[Index]) {
+            return Index;
+        }
+    }
+    
+    for (; Index < Hierarchy->Count; Index += 8)
+    {
+        u64 Flags;
+        memcpy(&Flags, Hierarchy->Dirty + Index, sizeof(Flags));
+        if (Flags)
+        {
+            while (!Hierarchy->Dirty[Index]) {
+                ++Index;
+            }
+            return Min(Index, Hierarchy->Count);
+        }
+    }
+    
+    return Hierarchy->Count;
+}
+
+// Recomputes the world matrices of the dirty nodes and of everything below them, clears the flags
+internal void TransformHierarchyUpdate(transform_hierarchy *Hierarchy)
+{
+    u32 Updated = 0;
+    u32 Index   = TransformHierarchyNextDirty(Hierarchy, 0);
+    
+    while (Index < Hierarchy->Count)
+    {
+        u32 End = Index + Hierarchy->SubtreeSize[Index];
+        
+        for (u32 i = Index; i < End; ++i)
+        {
+            u32 Parent = Hierarchy->Parent[i];
+            if (Parent == TRANSFORM_HIERARCHY_ROOT) {
+                Hierarchy->World[i] = Hierarchy->Local[i];
+            } else {
+                Hierarchy->World[i] = Hierarchy->World[Parent] * Hierarchy->Local[i];
+            }
+            Hierarchy->Dirty[i] = false;
+        }
+        
+        Updated += End - Index;
+        Index    = TransformHierarchyNextDirty(Hierarchy, End);
+    }
+    
+    Hierarchy->LastUpdated = Updated;
+}
+
+#endif //TRANSFORM_HIERARCHY_H
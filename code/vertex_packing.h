@@ -0,0 +1,277 @@
+/* date = October 18th 2026 2:30 am */
+
+#ifndef VERTEX_PACKING_H
+#define VERTEX_PACKING_H
+
+// NOTE(jdiaz): Conversions from f32 vertex streams to the packed formats the GPU can read directly,
+// 4 values per f32x4. Sources are plain arrays (one f32 per component, or one vec3/vec4 per
+// normal/tangent), any count, the tails go through the same kernels.
+//
+//   Half     IEEE binary16, round to nearest even, overflow to inf, NaN stays NaN  (R16_SFLOAT)
+//   Unorm    round(clamp(x, 0, 1) * max)                                           (R8/R16_UNORM)
+//   Snorm    round(clamp(x, -1, 1) * max), decodes as max(q / max, -1)             (R8/R16_SNORM)
+//   Normals  octahedral, 2 snorm16 (R16G16_SNORM), for unit vectors. Max error 0.004 degrees.
+//   Tangents octahedral like the normals, the bitangent sign (w) goes in the sign of the second
+//            component, which keeps half of its range: y' = (y * 0.5 + 0.5) * w. Max error
+//            0.007 degrees.
+//
+// The Unpack functions are the matching decoders, plain scalar code, for tests and tools (the GPU
+// decodes on its own). vertex_packing_test.cpp checks the round trips and the error bounds above.
+
+#define PACK_SIGN_BIT (i32)0x80000000
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// Count (up to 4) values, the missing lanes are 0
+inline f32x4 PackLoad(const f32 *Source, u32 Count)
+{
+    if (Count >= 4) {
+        return F32x4LoadU(Source);
+    }
+    
+    alignas(16) f32 Lanes[4] = {};
+    for (u32 i = 0; i < Count; ++i) {
+        Lanes[i] = Source[i];
+    }
+    return F32x4Load(Lanes);
+}
+
+// The low 8/16 bits of Count (up to 4) lanes
+inline void PackStore8(u8 *Dest, i32x4 Values, u32 Count)
+{
+    alignas(16) i32 Lanes[4];
+    I32x4Store(Lanes, Values);
+    for (u32 i = 0; i < Count && i < 4; ++i) {
+        Dest[i] = (u8)Lanes[i];
+    }
+}
+
+inline void PackStore16(u16 *Dest, i32x4 Values, u32 Count)
+{
+    alignas(16) i32 Lanes[4];
+    I32x4Store(Lanes, Values);
+    for (u32 i = 0; i < Count && i < 4; ++i) {
+        Dest[i] = (u16)Lanes[i];
+    }
+}
+
+// Lane kernels, the results in the low bits of every lane
+
+inline i32x4 F32x4ToHalf(f32x4 Value)
+{
+    i32x4 Bits = F32x4AsI32x4(Value);
+    i32x4 Sign = I32x4And(Bits, I32x4Set1(PACK_SIGN_BIT));
+    i32x4 Abs  = I32x4And(Bits, I32x4Set1(0x7FFFFFFF));
+    
+    // normal halves: rebias the exponent and round the mantissa to 10 bits (ties to even)
+    i32x4 Odd    = I32x4And(I32x4ShiftRight(Abs, 13), I32x4Set1(1));
+    i32x4 Normal = I32x4Add(Abs, I32x4Set1((i32)0xC8000FFF)); // ((15 - 127) << 23) + 0xFFF
+    Normal = I32x4ShiftRight(I32x4Add(Normal, Odd), 13);
+    
+    // below 2^-14: adding 0.5 puts the denormal half mantissa in the low bits, rounded by the FPU
+    i32x4 Denormal = F32x4AsI32x4(F32x4Add(I32x4AsF32x4(Abs), F32x4Set1(0.5f)));
+    Denormal = I32x4Sub(Denormal, I32x4Set1(0x3F000000));
+    
+    // 65536 and up is inf (65520 and up already rounds to it above), NaN stays a (quiet) NaN
+    i32x4 IsNaN   = I32x4CmpGT(Abs, I32x4Set1(0x7F800000));
+    i32x4 Special = I32x4Or(I32x4Set1(0x7C00), I32x4And(IsNaN, I32x4Set1(0x0200)));
+    
+    i32x4 IsDenormal = I32x4CmpGT(I32x4Set1(0x38800000), Abs); // 2^-14
+    i32x4 IsSpecial  = I32x4CmpGT(Abs, I32x4Set1(0x477FFFFF)); // 65536
+    f32x4 Res = F32x4Select(I32x4AsF32x4(IsDenormal), I32x4AsF32x4(Denormal), I32x4AsF32x4(Normal));
+    Res = F32x4Select(I32x4AsF32x4(IsSpecial), I32x4AsF32x4(Special), Res);
+    
+    return I32x4Or(F32x4AsI32x4(Res), I32x4ShiftRight(Sign, 16));
+}
+
+inline i32x4 F32x4ToUnorm(f32x4 Value, f32 Max)
+{
+    Value = F32x4Min(F32x4Max(Value, F32x4Zero()), F32x4Set1(1.0f));
+    return F32x4RoundToI32(F32x4Mul(Value, F32x4Set1(Max)));
+}
+
+inline i32x4 F32x4ToSnorm(f32x4 Value, f32 Max)
+{
+    Value = F32x4Min(F32x4Max(Value, F32x4Set1(-1.0f)), F32x4Set1(1.0f));
+    return F32x4RoundToI32(F32x4Mul(Value, F32x4Set1(Max)));
+}
+
+// Octahedral projection of 4 unit vectors to [-1, 1]^2, the lower half folded over the diagonals
+inline void F32x4ToOctahedral(f32x4 x, f32x4 y, f32x4 z, f32x4 *OctX, f32x4 *OctY)
+{
+    f32x4 AbsMask = I32x4AsF32x4(I32x4Set1(0x7FFFFFFF));
+    f32x4 SignMask = I32x4AsF32x4(I32x4Set1(PACK_SIGN_BIT));
+    f32x4 One = F32x4Set1(1.0f);
+    
+    f32x4 L1 = F32x4Add(F32x4Add(F32x4And(x, AbsMask), F32x4And(y, AbsMask)), F32x4And(z, AbsMask));
+    f32x4 InvL1 = F32x4Div(One, F32x4Max(L1, F32x4Set1(1e-20f)));
+    f32x4 px = F32x4Mul(x, InvL1);
+    f32x4 py = F32x4Mul(y, InvL1);
+    
+    f32x4 SignX = F32x4Or(F32x4And(px, SignMask), One); // +-1, 0 counts as positive
+    f32x4 SignY = F32x4Or(F32x4And(py, SignMask), One);
+    f32x4 FoldX = F32x4Mul(F32x4Sub(One, F32x4And(py, AbsMask)), SignX);
+    f32x4 FoldY = F32x4Mul(F32x4Sub(One, F32x4And(px, AbsMask)), SignY);
+    
+    f32x4 Upper = F32x4CmpGE(z, F32x4Zero());
+    *OctX = F32x4Select(Upper, px, FoldX);
+    *OctY = F32x4Select(Upper, py, FoldY);
+}
+
+// Streams of Count values (components, not vertices)
+
+internal void PackHalf(u16 *Dest, const f32 *Source, u32 Count)
+{
+    for (u32 i = 0; i < Count; i += 4)
+    {
+        u32 Lanes = Min(4u, Count - i);
+        PackStore16(Dest + i, F32x4ToHalf(PackLoad(Source + i, Lanes)), Lanes);
+    }
+}
+
+internal void PackUnorm8(u8 *Dest, const f32 *Source, u32 Count)
+{
+    for (u32 i = 0; i < Count; i += 4)
+    {
+        u32 Lanes = Min(4u, Count - i);
+        PackStore8(Dest + i, F32x4ToUnorm(PackLoad(Source + i, Lanes), 255.0f), Lanes);
+    }
+}
+
+internal void PackUnorm16(u16 *Dest, const f32 *Source, u32 Count)
+{
+    for (u32 i = 0; i < Count; i += 4)
+    {
+        u32 Lanes = Min(4u, Count - i);
+        PackStore16(Dest + i, F32x4ToUnorm(PackLoad(Source + i, Lanes), 65535.0f), Lanes);
+    }
+}
+
+internal void PackSnorm8(i8 *Dest, const f32 *Source, u32 Count)
+{
+    for (u32 i = 0; i < Count; i += 4)
+    {
+        u32 Lanes = Min(4u, Count - i);
+        PackStore8((u8*)Dest + i, F32x4ToSnorm(PackLoad(Source + i, Lanes), 127.0f), Lanes);
+    }
+}
+
+internal void PackSnorm16(i16 *Dest, const f32 *Source, u32 Count)
+{
+    for (u32 i = 0; i < Count; i += 4)
+    {
+        u32 Lanes = Min(4u, Count - i);
+        PackStore16((u16*)Dest + i, F32x4ToSnorm(PackLoad(Source + i, Lanes), 32767.0f), Lanes);
+    }
+}
+
+// Count normals (unit vectors) to Dest[2 * Count]
+internal void PackNormalsOct(i16 *Dest, const vec3 *Normals, u32 Count)
+{
+    for (u32 i = 0; i < Count; i += 4)
+    {
+        u32  Lanes = Min(4u, Count - i);
+        vec3 n[4]  = {V3(0.0f, 0.0f, 1.0f), V3(0.0f, 0.0f, 1.0f), V3(0.0f, 0.0f, 1.0f), V3(0.0f, 0.0f, 1.0f)};
+        for (u32 l = 0; l < Lanes; ++l) {
+            n[l] = Normals[i + l];
+        }
+        
+        f32x4 OctX, OctY;
+        F32x4ToOctahedral(F32x4Set(n[0].x, n[1].x, n[2].x, n[3].x),
+                          F32x4Set(n[0].y, n[1].y, n[2].y, n[3].y),
+                          F32x4Set(n[0].z, n[1].z, n[2].z, n[3].z), &OctX, &OctY);
+        
+        alignas(16) i32 x[4];
+        alignas(16) i32 y[4];
+        I32x4Store(x, F32x4ToSnorm(OctX, 32767.0f));
+        I32x4Store(y, F32x4ToSnorm(OctY, 32767.0f));
+        for (u32 l = 0; l < Lanes; ++l)
+        {
+            Dest[2 * (i + l) + 0] = (i16)x[l];
+            Dest[2 * (i + l) + 1] = (i16)y[l];
+        }
+    }
+}
+
+// Count tangents (unit xyz, w is the bitangent sign +-1) to Dest[2 * Count]
+internal void PackTangentsOct(i16 *Dest, const vec4 *Tangents, u32 Count)
+{
+    for (u32 i = 0; i < Count; i += 4)
+    {
+        u32  Lanes = Min(4u, Count - i);
+        vec4 t[4]  = {V4(0.0f, 0.0f, 1.0f, 1.0f), V4(0.0f, 0.0f, 1.0f, 1.0f), V4(0.0f, 0.0f, 1.0f, 1.0f), V4(0.0f, 0.0f, 1.0f, 1.0f)};
+        for (u32 l = 0; l < Lanes; ++l) {
+            t[l] = Tangents[i + l];
+        }
+        
+        f32x4 OctX, OctY;
+        F32x4ToOctahedral(F32x4Set(t[0].x, t[1].x, t[2].x, t[3].x),
+                          F32x4Set(t[0].y, t[1].y, t[2].y, t[3].y),
+                          F32x4Set(t[0].z, t[1].z, t[2].z, t[3].z), &OctX, &OctY);
+        
+        // y to [1/32767, 1] so it never rounds to 0, which has no sign, then the sign of w
+        f32x4 SignW = F32x4And(F32x4Set(t[0].w, t[1].w, t[2].w, t[3].w), I32x4AsF32x4(I32x4Set1(PACK_SIGN_BIT)));
+        OctY = F32x4Max(F32x4MulAdd(OctY, F32x4Set1(0.5f), F32x4Set1(0.5f)), F32x4Set1(1.0f / 32767.0f));
+        OctY = F32x4Or(OctY, SignW);
+        
+        alignas(16) i32 x[4];
+        alignas(16) i32 y[4];
+        I32x4Store(x, F32x4ToSnorm(OctX, 32767.0f));
+        I32x4Store(y, F32x4ToSnorm(OctY, 32767.0f));
+        for (u32 l = 0; l < Lanes; ++l)
+        {
+            Dest[2 * (i + l) + 0] = (i16)x[l];
+            Dest[2 * (i + l) + 1] = (i16)y[l];
+        }
+    }
+}
+
+// Decoders
+
+internal f32 UnpackHalf(u16 Half)
+{
+    u32 Sign     = (u32)(Half & 0x8000) << 16;
+    u32 Exponent = (Half >> 10) & 0x1F;
+    u32 Mantissa = Half & 0x3FF;
+    
+    if (Exponent == 0)
+    {
+        f32 Res = Mantissa * (1.0f / 16777216.0f); // 2^-24
+        return Sign ? -Res : Res;
+    }
+    
+    u32 Bits = (Exponent == 31) ? (Sign | 0x7F800000 | (Mantissa << 13)) : (Sign | ((Exponent + 112) << 23) | (Mantissa << 13));
+    return F32FromBits(Bits);
+}
+
+inline f32 UnpackUnorm8(u8 Value)   { return Value / 255.0f; }
+inline f32 UnpackUnorm16(u16 Value) { return Value / 65535.0f; }
+inline f32 UnpackSnorm8(i8 Value)   { return Max(Value / 127.0f, -1.0f); }
+inline f32 UnpackSnorm16(i16 Value) { return Max(Value / 32767.0f, -1.0f); }
+
+internal vec3 UnpackOctahedral(f32 x, f32 y)
+{
+    f32 z = 1.0f - (x < 0.0f ? -x : x) - (y < 0.0f ? -y : y);
+    if (z < 0.0f)
+    {
+        f32 FoldX = (1.0f - (y < 0.0f ? -y : y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        f32 FoldY = (1.0f - (x < 0.0f ? -x : x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = FoldX;
+        y = FoldY;
+    }
+    return Normalize(V3(x, y, z));
+}
+
+inline vec3 UnpackNormalOct(const i16 *Packed)
+{
+    return UnpackOctahedral(UnpackSnorm16(Packed[0]), UnpackSnorm16(Packed[1]));
+}
+
+inline vec4 UnpackTangentOct(const i16 *Packed)
+{
+    f32  y = UnpackSnorm16(Packed[1]);
+    vec3 t = UnpackOctahedral(UnpackSnorm16(Packed[0]), (y < 0.0f ? -y : y) * 2.0f - 1.0f);
+    return V4(t, y < 0.0f ? -1.0f : 1.0f);
+}
+
+#endif //VERTEX_PACKING_H
@@ -0,0 +1,252 @@
+// NOTE(jdiaz): Offline round trip test of the vertex packing (see vertex_packing.h): every format is
+// packed with the SIMD kernels and decoded with the scalar Unpack functions, counts that are not a
+// multiple of 4 so the tails are covered too.
+// Usage: vertex_packing_test, returns 0 when everything matches.
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "engine_simd.h"
+#include "engine_math.h"
+#include "vertex_packing.h"
+
+#define TEST_VALUES  100003
+#define TEST_NORMALS 1000003
+
+// The bounds the header promises, in degrees
+#define TEST_NORMAL_ERROR  0.004
+#define TEST_TANGENT_ERROR 0.007
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal u32 TestRandomState = 12345;
+internal u32 TestFailures;
+
+internal f32 Values[TEST_VALUES];
+internal u16 Packed16[TEST_VALUES];
+internal u8  Packed8[TEST_VALUES];
+
+internal vec3 Normals[TEST_NORMALS];
+internal vec4 Tangents[TEST_NORMALS];
+internal i16  PackedNormals[2 * TEST_NORMALS];
+internal i16  PackedTangents[2 * TEST_NORMALS];
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// [-1, 1)
+internal f32 TestRandom()
+{
+    TestRandomState = TestRandomState * 1664525 + 1013904223;
+    return (f32)(TestRandomState >> 8) / (f32)(1 << 23) - 1.0f;
+}
+
+internal void TestCheck(b32 Condition, const char *What)
+{
+    printf("%s: %s\n", Condition ? "ok" : "FAILED", What);
+    if (!Condition) {
+        ++TestFailures;
+    }
+}
+
+// Round to nearest even in double precision, the reference for PackHalf
+internal u16 ReferenceHalf(f32 Value)
+{
+    u32 Bits = F32ToBits(Value);
+    u16 Sign = (u16)((Bits >> 16) & 0x8000);
+    if ((Bits & 0x7FFFFFFF) > 0x7F800000) {
+        return Sign | 0x7E00;
+    }
+    
+    double Abs = fabs((double)Value);
+    if (Abs >= 65520.0) {
+        return Sign | 0x7C00;
+    }
+    if (Abs < 6.103515625e-05) {
+        return Sign | (u16)nearbyint(Abs / 5.9604644775390625e-08); // denormals, steps of 2^-24
+    }
+    
+    int    Exponent;
+    double Fraction = frexp(Abs, &Exponent);
+    double Mantissa = nearbyint(Fraction * 2048.0);
+    if (Mantissa == 2048.0)
+    {
+        Mantissa = 1024.0;
+        ++Exponent;
+    }
+    return Sign | (u16)((Exponent + 14) << 10) | (u16)(Mantissa - 1024.0);
+}
+
+// In degrees, from the cross and dot products in double precision: acos of an f32 dot product
+// cannot resolve angles under about 0.02 degrees
+internal double AngleBetween(const vec3 &a, const vec3 &b)
+{
+    double x   = (double)a.y * b.z - (double)a.z * b.y;
+    double y   = (double)a.z * b.x - (double)a.x * b.z;
+    double z   = (double)a.x * b.y - (double)a.y * b.x;
+    double Dot = (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z;
+    return atan2(sqrt(x * x + y * y + z * z), Dot) * 57.29577951308232;
+}
+
+internal void TestHalf()
+{
+    // a stride through all the f32 bit patterns, against the reference rounding
+    u32 Mismatches = 0;
+    for (u64 Start = 0; Start < (1ull << 32); Start += (u64)TEST_VALUES * 4099)
+    {
+        for (u32 i = 0; i < TEST_VALUES; ++i) {
+            Values[i] = F32FromBits((u32)(Start + (u64)i * 4099));
+        }
+        PackHalf(Packed16, Values, TEST_VALUES);
+        for (u32 i = 0; i < TEST_VALUES; ++i) {
+            Mismatches += Packed16[i] != ReferenceHalf(Values[i]);
+        }
+    }
+    TestCheck(Mismatches == 0, "half, rounding to nearest even");
+    
+    // every half decodes and packs back to itself, NaNs to a NaN
+    u32 RoundTripErrors = 0;
+    for (u32 Half = 0; Half < 65536; ++Half)
+    {
+        f32 Value = UnpackHalf((u16)Half);
+        u16 Repacked;
+        PackHalf(&Repacked, &Value, 1);
+        
+        b32 IsNaN = (Half & 0x7C00) == 0x7C00 && (Half & 0x3FF);
+        if (IsNaN) {
+            RoundTripErrors += (Repacked & 0x7C00) != 0x7C00 || !(Repacked & 0x3FF);
+        } else {
+            RoundTripErrors += Repacked != Half;
+        }
+    }
+    TestCheck(RoundTripErrors == 0, "half, all 65536 values round trip");
+}
+
+// Largest error in steps of the format, has to be half a step at most
+internal void TestNorms()
+{
+    for (u32 i = 0; i < TEST_VALUES; ++i) {
+        Values[i] = TestRandom() * 1.2f;
+    }
+    
+    double Unorm8Error  = 0.0;
+    double Unorm16Error = 0.0;
+    double Snorm8Error  = 0.0;
+    double Snorm16Error = 0.0;
+    
+    PackUnorm8(Packed8, Values, TEST_VALUES);
+    for (u32 i = 0; i < TEST_VALUES; ++i) {
+        Unorm8Error = fmax(Unorm8Error, fabs(UnpackUnorm8(Packed8[i]) - Min(Max(Values[i], 0.0f), 1.0f)) * 255.0);
+    }
+    PackUnorm16(Packed16, Values, TEST_VALUES);
+    for (u32 i = 0; i < TEST_VALUES; ++i) {
+        Unorm16Error = fmax(Unorm16Error, fabs(UnpackUnorm16(Packed16[i]) - Min(Max(Values[i], 0.0f), 1.0f)) * 65535.0);
+    }
+    PackSnorm8((i8*)Packed8, Values, TEST_VALUES);
+    for (u32 i = 0; i < TEST_VALUES; ++i) {
+        Snorm8Error = fmax(Snorm8Error, fabs(UnpackSnorm8((i8)Packed8[i]) - Min(Max(Values[i], -1.0f), 1.0f)) * 127.0);
+    }
+    PackSnorm16((i16*)Packed16, Values, TEST_VALUES);
+    for (u32 i = 0; i < TEST_VALUES; ++i) {
+        Snorm16Error = fmax(Snorm16Error, fabs(UnpackSnorm16((i16)Packed16[i]) - Min(Max(Values[i], -1.0f), 1.0f)) * 32767.0);
+    }
+    
+    char Name[128];
+    snprintf(Name, sizeof(Name), "unorm8, %.4f steps", Unorm8Error);
+    TestCheck(Unorm8Error <= 0.5001, Name);
+    snprintf(Name, sizeof(Name), "unorm16, %.4f steps", Unorm16Error);
+    TestCheck(Unorm16Error <= 0.5001, Name);
+    snprintf(Name, sizeof(Name), "snorm8, %.4f steps", Snorm8Error);
+    TestCheck(Snorm8Error <= 0.5001, Name);
+    snprintf(Name, sizeof(Name), "snorm16, %.4f steps", Snorm16Error);
+    TestCheck(Snorm16Error <= 0.5001, Name);
+    
+    // every code but the most negative snorm (which decodes as -1 like the next one) packs back
+    u32 RoundTripErrors = 0;
+    for (u32 Code = 0; Code < 256; ++Code)
+    {
+        f32 Value = UnpackUnorm8((u8)Code);
+        u8  Repacked;
+        PackUnorm8(&Repacked, &Value, 1);
+        RoundTripErrors += Repacked != Code;
+        
+        i8 Signed = (i8)(Code - 128);
+        if (Signed != -128)
+        {
+            i8 RepackedSigned;
+            Value = UnpackSnorm8(Signed);
+            PackSnorm8(&RepackedSigned, &Value, 1);
+            RoundTripErrors += RepackedSigned != Signed;
+        }
+    }
+    for (u32 Code = 0; Code < 65536; ++Code)
+    {
+        f32 Value = UnpackUnorm16((u16)Code);
+        u16 Repacked;
+        PackUnorm16(&Repacked, &Value, 1);
+        RoundTripErrors += Repacked != Code;
+        
+        i16 Signed = (i16)((i32)Code - 32768);
+        if (Signed != -32768)
+        {
+            i16 RepackedSigned;
+            Value = UnpackSnorm16(Signed);
+            PackSnorm16(&RepackedSigned, &Value, 1);
+            RoundTripErrors += RepackedSigned != Signed;
+        }
+    }
+    TestCheck(RoundTripErrors == 0, "unorm/snorm 8/16, every code round trips");
+}
+
+internal void TestOctahedral()
+{
+    // the axes and the z = 0 circle, where the folds meet, first
+    vec3 Axes[6] = {V3(1.0f, 0.0f, 0.0f), V3(-1.0f, 0.0f, 0.0f), V3(0.0f, 1.0f, 0.0f),
+                    V3(0.0f, -1.0f, 0.0f), V3(0.0f, 0.0f, 1.0f), V3(0.0f, 0.0f, -1.0f)};
+    for (u32 i = 0; i < TEST_NORMALS; ++i)
+    {
+        vec3 Direction = V3(TestRandom(), TestRandom(), TestRandom());
+        if (i < 6) {
+            Direction = Axes[i];
+        } else if (i < 1000) {
+            Direction.z = 0.0f;
+        }
+        Normals[i]  = Normalize(Direction);
+        Tangents[i] = V4(Normals[i], (i & 2) ? -1.0f : 1.0f);
+    }
+    
+    PackNormalsOct(PackedNormals, Normals, TEST_NORMALS);
+    PackTangentsOct(PackedTangents, Tangents, TEST_NORMALS);
+    
+    double NormalError  = 0.0;
+    double TangentError = 0.0;
+    u32    SignErrors   = 0;
+    for (u32 i = 0; i < TEST_NORMALS; ++i)
+    {
+        NormalError = fmax(NormalError, AngleBetween(UnpackNormalOct(PackedNormals + 2 * i), Normals[i]));
+        
+        vec4 Tangent = UnpackTangentOct(PackedTangents + 2 * i);
+        TangentError = fmax(TangentError, AngleBetween(V3(Tangent.x, Tangent.y, Tangent.z), V3(Tangents[i].x, Tangents[i].y, Tangents[i].z)));
+        SignErrors  += Tangent.w != Tangents[i].w;
+    }
+    
+    char Name[128];
+    snprintf(Name, sizeof(Name), "octahedral normals, max error %.5f degrees", NormalError);
+    TestCheck(NormalError <= TEST_NORMAL_ERROR, Name);
+    snprintf(Name, sizeof(Name), "octahedral tangents, max error %.5f degrees", TangentError);
+    TestCheck(TangentError <= TEST_TANGENT_ERROR, Name);
+    TestCheck(SignErrors == 0, "octahedral tangents, bitangent signs");
+}
+
+int main(int ArgCount, char **Args)
+{
+    TestHalf();
+    TestNorms();
+    TestOctahedral();
+    
+    printf(TestFailures ? "%u checks failed\n" : "all checks passed\n", TestFailures);
+    return TestFailures ? 1 : 0;
+}
@@ -5,11 +5,24 @@
 #extension GL_ARB_separate_shader_objects : enable
 
 layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
-	mat4 view;
-	mat4 proj;
+	mat4 viewProj;
 } ubo;
 
+// One per object (instance), written by TransformBatch on the CPU
+struct ObjectTransform {
+	mat4 world;
+	mat4 mvp; // viewProj * world
+};
+
+layout(std430, binding = 2) readonly buffer ObjectBuffer {
+	ObjectTransform objects[];
+};
+
+// Objects that passed frustum culling, one per instance
+layout(std430, binding = 3) readonly buffer VisibleBuffer {
+	uint visible[];
+};
+
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
@@ -19,7 +32,7 @@ layout(location = 1) out vec2 fragTexCoord;
 
 void main()
 {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+	gl_Position = objects[visible[gl_InstanceIndex]].mvp * vec4(inPosition, 1.0);
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
 }
@@ -0,0 +1,401 @@
+/* date = October 17th 2026 8:40 pm */
+
+#ifndef VULKAN_ALLOCATOR_H
+#define VULKAN_ALLOCATOR_H
+
+// NOTE(jdiaz): VkAllocationCallbacks for the driver host allocations. Every vkCreate*/vkAllocate*/
+// vkDestroy*/vkFree* call passes VulkanAllocator, so the memory the driver allocates for our objects
+// comes from our allocators and is accounted per VkSystemAllocationScope (live count and bytes,
+// peak bytes, total allocations). Allocations the driver makes on its own and only reports to us
+// (pfnInternalAllocation) are accounted separately.
+//
+// Allocations come from size class pools: up to 4KB thread safe pools (the driver can call us from
+// any thread), up to 1MB pools under one lock, carved in batches of about VULKAN_HOST_MEDIUM_BATCH.
+// Only what is bigger than that or aligned past a cache line gets its own block from the platform.
+// Every allocation is preceded by a vulkan_host_header, which is how free and realloc know what
+// they are given. Stats are memory_stats (memory_accounting.h), bytes are 64 bit.
+//
+// Device memory goes through VulkanAllocateMemory / VulkanFreeMemory, which account every
+// VkDeviceMemory under a memory_tag and its heap (memory_accounting.h). Drivers cap the number of
+// allocations (maxMemoryAllocationCount, 4096 on most), so a flat array is enough to remember them.
+
+#define VULKAN_HOST_HEADER_SIZE     64
+#define VULKAN_HOST_SMALL_CLASSES   6    // 128 bytes to 4KB, header included, thread safe pools
+#define VULKAN_HOST_CLASS_COUNT     14   // then 8KB to 1MB, pools under MediumLock
+#define VULKAN_HOST_MIN_CLASS_SIZE  128
+#define VULKAN_HOST_SLOTS_PER_BATCH 256
+#define VULKAN_HOST_MEDIUM_BATCH    MB(1)
+#define VULKAN_HOST_LARGE_CLASS     U32_MAX
+
+#define VULKAN_HOST_SCOPE_COUNT (VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1)
+
+#define VULKAN_MAX_DEVICE_ALLOCATIONS 4096
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct vulkan_host_header
+{
+    u64 Size;        // requested size
+    u32 Scope;
+    u32 Class;       // size class, or VULKAN_HOST_LARGE_CLASS
+    u8* Block;       // large allocations only
+    u64 BlockSize;
+    u8  Pad[VULKAN_HOST_HEADER_SIZE - 32];
+};
+
+struct vulkan_host_allocator
+{
+    VkAllocationCallbacks Callbacks;
+    arena                 ClassArenas[VULKAN_HOST_CLASS_COUNT]; // one per pool, batches are carved under the pool lock
+    pool                  Classes[VULKAN_HOST_CLASS_COUNT];
+    volatile u32          MediumLock; // the pools from VULKAN_HOST_SMALL_CLASSES on
+    memory_stats          Scopes[VULKAN_HOST_SCOPE_COUNT];
+    memory_stats          InternalScopes[VULKAN_HOST_SCOPE_COUNT];
+};
+
+struct vulkan_device_allocation
+{
+    VkDeviceMemory Memory;
+    VkDeviceSize   Size;
+    u32            Tag;
+    u32            HeapIndex;
+};
+
+struct vulkan_device_memory
+{
+    volatile u32             Lock;
+    u32                      HeapOfType[VK_MAX_MEMORY_TYPES];
+    u32                      AllocationCount;
+    vulkan_device_allocation Allocations[VULKAN_MAX_DEVICE_ALLOCATIONS];
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal vulkan_host_allocator  VulkanHostAllocator;
+internal VkAllocationCallbacks* VulkanAllocator; // NULL until VulkanHostAllocatorInit
+internal vulkan_device_memory   VulkanDeviceMemory;
+
+internal const char* VulkanScopeNames[VULKAN_HOST_SCOPE_COUNT] = {
+    "command", "object", "cache", "device", "instance"
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+inline u32 VulkanHostSizeClass(u64 Size, u64 Alignment)
+{
+    u64 Total = Size + VULKAN_HOST_HEADER_SIZE;
+    if (Alignment > POOL_SLOT_ALIGNMENT) {
+        return VULKAN_HOST_LARGE_CLASS;
+    }
+    
+    for (u32 i = 0; i < VULKAN_HOST_CLASS_COUNT; ++i)
+    {
+        if (Total <= ((u64)VULKAN_HOST_MIN_CLASS_SIZE << i)) {
+            return i;
+        }
+    }
+    return VULKAN_HOST_LARGE_CLASS;
+}
+
+inline vulkan_host_header* VulkanHostGetHeader(void *Memory)
+{
+    return (vulkan_host_header*)((u8*)Memory - VULKAN_HOST_HEADER_SIZE);
+}
+
+inline void* VulkanHostPoolAlloc(vulkan_host_allocator *Allocator, u32 Class)
+{
+    if (Class < VULKAN_HOST_SMALL_CLASSES) {
+        return PoolAlloc(Allocator->Classes + Class);
+    }
+    
+    while (AtomicCompareExchange(&Allocator->MediumLock, 0, 1) != 0)
+    {
+        CpuPause();
+    }
+    void* Res = PoolAlloc(Allocator->Classes + Class);
+    AtomicStoreRelease(&Allocator->MediumLock, 0);
+    return Res;
+}
+
+inline void VulkanHostPoolFree(vulkan_host_allocator *Allocator, u32 Class, void *Memory)
+{
+    if (Class < VULKAN_HOST_SMALL_CLASSES)
+    {
+        PoolFree(Allocator->Classes + Class, Memory);
+        return;
+    }
+    
+    while (AtomicCompareExchange(&Allocator->MediumLock, 0, 1) != 0)
+    {
+        CpuPause();
+    }
+    PoolFree(Allocator->Classes + Class, Memory);
+    AtomicStoreRelease(&Allocator->MediumLock, 0);
+}
+
+internal void* VKAPI_CALL VulkanHostAllocate(void *UserData, size_t Size, size_t Alignment, VkSystemAllocationScope Scope)
+{
+    vulkan_host_allocator *Allocator = (vulkan_host_allocator*)UserData;
+    Assert((Alignment & (Alignment - 1)) == 0);
+    
+    if (Size == 0) {
+        return NULL;
+    }
+    
+    vulkan_host_header *Header;
+    u32 Class = VulkanHostSizeClass(Size, Alignment);
+    
+    if (Class != VULKAN_HOST_LARGE_CLASS)
+    {
+        Header = (vulkan_host_header*)VulkanHostPoolAlloc(Allocator, Class);
+        Header->Block     = 0;
+        Header->BlockSize = 0;
+    }
+    else
+    {
+        // blocks are page aligned, the header goes right before the first aligned address after it
+        u64 Offset = Max((u64)VULKAN_HOST_HEADER_SIZE, (u64)Alignment);
+        Assert(Offset <= KB(4));
+        
+        u64 BlockSize = Offset + Size;
+        u8* Block     = AllocateArenaBlock(BlockSize);
+        if (!Block) {
+            return NULL;
+        }
+        MemoryTrackAlloc(MemoryTag_DriverHost, BlockSize);
+        
+        Header = (vulkan_host_header*)(Block + Offset - VULKAN_HOST_HEADER_SIZE);
+        Header->Block     = Block;
+        Header->BlockSize = BlockSize;
+    }
+    
+    Header->Size  = Size;
+    Header->Scope = Scope;
+    Header->Class = Class;
+    
+    MemoryStatsAdd(Allocator->Scopes + Scope, Size);
+    return (u8*)Header + VULKAN_HOST_HEADER_SIZE;
+}
+
+internal void VKAPI_CALL VulkanHostFree(void *UserData, void *Memory)
+{
+    if (!Memory) {
+        return;
+    }
+    
+    vulkan_host_allocator *Allocator = (vulkan_host_allocator*)UserData;
+    vulkan_host_header *Header = VulkanHostGetHeader(Memory);
+    
+    MemoryStatsRemove(Allocator->Scopes + Header->Scope, Header->Size);
+    
+    if (Header->Class != VULKAN_HOST_LARGE_CLASS) {
+        VulkanHostPoolFree(Allocator, Header->Class, Header);
+    } else {
+        MemoryTrackFree(MemoryTag_DriverHost, Header->BlockSize);
+        FreeArenaBlock(Header->Block, Header->BlockSize);
+    }
+}
+
+internal void* VKAPI_CALL VulkanHostReallocate(void *UserData, void *Original, size_t Size, size_t Alignment, VkSystemAllocationScope Scope)
+{
+    if (!Original) {
+        return VulkanHostAllocate(UserData, Size, Alignment, Scope);
+    }
+    
+    if (Size == 0)
+    {
+        VulkanHostFree(UserData, Original);
+        return NULL;
+    }
+    
+    vulkan_host_allocator *Allocator = (vulkan_host_allocator*)UserData;
+    vulkan_host_header *Header = VulkanHostGetHeader(Original);
+    
+    // still fits in the same slot, only the accounting changes
+    if (Header->Class != VULKAN_HOST_LARGE_CLASS && VulkanHostSizeClass(Size, Alignment) == Header->Class)
+    {
+        MemoryStatsResize(Allocator->Scopes + Header->Scope, Header->Size, Size);
+        Header->Size = Size;
+        return Original;
+    }
+    
+    void* Memory = VulkanHostAllocate(UserData, Size, Alignment, Scope);
+    if (Memory)
+    {
+        memcpy(Memory, Original, Min((u64)Size, Header->Size));
+        VulkanHostFree(UserData, Original);
+    }
+    return Memory;
+}
+
+internal void VKAPI_CALL VulkanHostInternalAllocation(void *UserData, size_t Size, VkInternalAllocationType Type, VkSystemAllocationScope Scope)
+{
+    vulkan_host_allocator *Allocator = (vulkan_host_allocator*)UserData;
+    MemoryStatsAdd(Allocator->InternalScopes + Scope, Size);
+}
+
+internal void VKAPI_CALL VulkanHostInternalFree(void *UserData, size_t Size, VkInternalAllocationType Type, VkSystemAllocationScope Scope)
+{
+    vulkan_host_allocator *Allocator = (vulkan_host_allocator*)UserData;
+    MemoryStatsRemove(Allocator->InternalScopes + Scope, Size);
+}
+
+internal void VulkanHostAllocatorInit()
+{
+    vulkan_host_allocator *Allocator = &VulkanHostAllocator;
+    *Allocator = {};
+    
+    // NOTE(jdiaz): The driver does not need zeroed memory, no point clearing up to 1MB per allocation
+    for (u32 i = 0; i < VULKAN_HOST_CLASS_COUNT; ++i)
+    {
+        u64 SlotSize = (u64)VULKAN_HOST_MIN_CLASS_SIZE << i;
+        u32 Flags    = Pool_NoZero;
+        u32 SlotsPerBatch;
+        if (i < VULKAN_HOST_SMALL_CLASSES)
+        {
+            Flags        |= Pool_ThreadSafe;
+            SlotsPerBatch = VULKAN_HOST_SLOTS_PER_BATCH;
+        }
+        else
+        {
+            SlotsPerBatch = (u32)Max(VULKAN_HOST_MEDIUM_BATCH / SlotSize, 1ull);
+        }
+        
+        Allocator->ClassArenas[i] = MakeGrowingArena(SlotSize * SlotsPerBatch + KB(64), MemoryTag_DriverHost);
+        PoolInit(Allocator->Classes + i, Allocator->ClassArenas + i, SlotSize, SlotsPerBatch, Flags);
+    }
+    
+    Allocator->Callbacks.pUserData             = Allocator;
+    Allocator->Callbacks.pfnAllocation         = VulkanHostAllocate;
+    Allocator->Callbacks.pfnReallocation       = VulkanHostReallocate;
+    Allocator->Callbacks.pfnFree               = VulkanHostFree;
+    Allocator->Callbacks.pfnInternalAllocation = VulkanHostInternalAllocation;
+    Allocator->Callbacks.pfnInternalFree       = VulkanHostInternalFree;
+    
+    VulkanAllocator = &Allocator->Callbacks;
+}
+
+internal void VulkanHostMemoryReport(const char *When)
+{
+    vulkan_host_allocator *Allocator = &VulkanHostAllocator;
+    
+    LOG("Vulkan host memory (%s):", When);
+    for (u32 i = 0; i < VULKAN_HOST_SCOPE_COUNT; ++i)
+    {
+        memory_stats *Stats    = Allocator->Scopes + i;
+        memory_stats *Internal = Allocator->InternalScopes + i;
+        LOG("  %s: %llu live, %llu bytes, peak %llu bytes, %llu total | internal %llu bytes, peak %llu bytes",
+            VulkanScopeNames[i], Stats->Count, Stats->Current, Stats->Peak, Stats->TotalCount,
+            Internal->Current, Internal->Peak);
+    }
+}
+
+// Called once the instance is gone, anything still live was leaked by us or by the driver
+internal void VulkanHostAllocatorShutdown()
+{
+    vulkan_host_allocator *Allocator = &VulkanHostAllocator;
+    VulkanHostMemoryReport("shutdown");
+    
+    u64 LiveCount = 0;
+    for (u32 i = 0; i < VULKAN_HOST_SCOPE_COUNT; ++i)
+    {
+        LiveCount += Allocator->Scopes[i].Count;
+    }
+    
+    VulkanAllocator = NULL;
+    
+    if (LiveCount > 0)
+    {
+        LOG("Vulkan host memory: %llu allocations leaked", LiveCount);
+        return; // the pools stay around, something may still point into them
+    }
+    
+    for (u32 i = 0; i < VULKAN_HOST_CLASS_COUNT; ++i)
+    {
+        PoolRelease(Allocator->Classes + i);
+        ClearArena(Allocator->ClassArenas + i);
+    }
+}
+
+// Device memory
+
+// Registers the heaps of the device with the memory accounting
+internal void VulkanDeviceMemoryInit(VkPhysicalDevice PhysicalDevice)
+{
+    VkPhysicalDeviceMemoryProperties Properties;
+    vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &Properties);
+    
+    for (u32 i = 0; i < Properties.memoryHeapCount; ++i)
+    {
+        MemorySetGPUHeap(i, Properties.memoryHeaps[i].size, (Properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0);
+    }
+    for (u32 i = 0; i < Properties.memoryTypeCount; ++i)
+    {
+        VulkanDeviceMemory.HeapOfType[i] = Properties.memoryTypes[i].heapIndex;
+    }
+}
+
+inline void VulkanDeviceMemoryLock()
+{
+    while (AtomicCompareExchange(&VulkanDeviceMemory.Lock, 0, 1) != 0)
+    {
+        CpuPause();
+    }
+}
+
+inline void VulkanDeviceMemoryUnlock()
+{
+    AtomicStoreRelease(&VulkanDeviceMemory.Lock, 0);
+}
+
+internal VkResult VulkanAllocateMemory(VkDevice Device, const VkMemoryAllocateInfo *AllocInfo, u32 Tag, VkDeviceMemory *Memory)
+{
+    VkResult Res = vkAllocateMemory(Device, AllocInfo, VulkanAllocator, Memory);
+    if (Res != VK_SUCCESS) {
+        return Res;
+    }
+    
+    u32 HeapIndex = VulkanDeviceMemory.HeapOfType[AllocInfo->memoryTypeIndex];
+    MemoryTrackGPUAlloc(Tag, HeapIndex, AllocInfo->allocationSize);
+    
+    VulkanDeviceMemoryLock();
+    Assert(VulkanDeviceMemory.AllocationCount < VULKAN_MAX_DEVICE_ALLOCATIONS);
+    vulkan_device_allocation *Allocation = VulkanDeviceMemory.Allocations + VulkanDeviceMemory.AllocationCount++;
+    Allocation->Memory    = *Memory;
+    Allocation->Size      = AllocInfo->allocationSize;
+    Allocation->Tag       = Tag;
+    Allocation->HeapIndex = HeapIndex;
+    VulkanDeviceMemoryUnlock();
+    
+    return Res;
+}
+
+internal void VulkanFreeMemory(VkDevice Device, VkDeviceMemory Memory)
+{
+    if (Memory == VK_NULL_HANDLE) {
+        return;
+    }
+    
+    vulkan_device_allocation Allocation = {};
+    
+    VulkanDeviceMemoryLock();
+    for (u32 i = 0; i < VulkanDeviceMemory.AllocationCount; ++i)
+    {
+        if (VulkanDeviceMemory.Allocations[i].Memory == Memory)
+        {
+            Allocation = VulkanDeviceMemory.Allocations[i];
+            VulkanDeviceMemory.Allocations[i] = VulkanDeviceMemory.Allocations[--VulkanDeviceMemory.AllocationCount];
+            break;
+        }
+    }
+    VulkanDeviceMemoryUnlock();
+    
+    Assert(Allocation.Memory == Memory); // not allocated with VulkanAllocateMemory
+    MemoryTrackGPUFree(Allocation.Tag, Allocation.HeapIndex, Allocation.Size);
+    
+    vkFreeMemory(Device, Memory, VulkanAllocator);
+}
+
+#endif //VULKAN_ALLOCATOR_H
@@ -0,0 +1,2126 @@
+// NOTE(jdiaz): Platform independent renderer. It is included by the platform layers (main.cpp for
+// Win32, linux_main.cpp for Linux) after they have defined the following:
+//   LOG(format, ...) (logger.h)                deferred binary logging
+//   ExitWithError(msg)                         fatal error reporting
+//   PlatformReadFile / PlatformFreeFileMemory  whole file reads
+//   PlatformMapFile / PlatformUnmapFile        read-only memory mapped file views
+//   AsyncIO* (async_io.h)                      batched asynchronous file reads
+//   FrameTiming* (frame_timing.h)              per phase CPU frame timing
+//   Job* (job_system.h)                        work-stealing job system, initialized by the caller
+//   Pak* (pak.h)                               packed asset archive reader
+//   Pool* (pool.h)                             fixed size pool allocators
+//   Transform* (transform.h)                   batch world/MVP matrices for the scene objects
+//   Transform* (transform_hierarchy.h)         parents of the scene objects, dirty-flag updates
+//   Cull* (culling.h)                          view frustum planes, flat SoA sphere/box culling
+//   Bvh* (bvh.h)                               object BVH, job-parallel frustum culling
+//   PlatformCreateVulkanSurface                VkSurfaceKHR creation for the platform window
+//   PLATFORM_VULKAN_SURFACE_EXTENSION_NAME     instance extension needed by the surface
+//   USE_VALIDATION_LAYERS                      (optional) enables VK_LAYER_KHRONOS_validation
+
+#include "vulkan_allocator.h"
+#include "vulkan_resources.h"
+
+#define INVALID_INDEX U32_MAX
+
+#define DEFAULT_WINDOW_WIDTH 1024
+#define DEFAULT_WINDOW_HEIGHT 768
+
+#define MAX_SWAPCHAIN_IMAGES 4
+#define MAX_FRAMES_IN_FLIGHT 2
+
+#define TEXTURE_DECODE_MEMORY MB(96) // decoded RGBA8 image plus the decoder temporaries
+
+#define MAX_SCENE_OBJECTS (1 << 20)
+
+// Draw buffers: the indirect draw command, then the visible object indices from this offset
+// (minStorageBufferOffsetAlignment is 256 at most)
+#define DRAW_BUFFER_VISIBLE_OFFSET 256
+
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct vertex
+{
+    vec3 pos;
+    vec3 color;
+    vec2 texCoord;
+};
+
+// NOTE(jdiaz): What goes in the vertex buffer, vertex packed by PackVertices (see vertex_packing.h)
+struct packed_vertex
+{
+    vec3 pos;
+    u8   color[4];    // unorm, alpha 1
+    u16  texCoord[2]; // half
+};
+
+// NOTE(jdiaz): Per frame constants. The per object matrices (model-view-projection included, so
+// the shader does not multiply matrices per vertex) are in the object buffers, see transform.h.
+struct uniform_buffer_object
+{
+    mat4 viewProj;
+};
+
+// NOTE: The layouts the shaders and the vertex input description expect (vertex_shader.glsl)
+CTAssert(sizeof(packed_vertex) == 20);
+CTAssert(OffsetOf(packed_vertex, pos) == 0 && OffsetOf(packed_vertex, color) == 12 && OffsetOf(packed_vertex, texCoord) == 16);
+CTAssert(sizeof(uniform_buffer_object) == 64 && OffsetOf(uniform_buffer_object, viewProj) == 0);
+CTAssert(sizeof(VkDrawIndexedIndirectCommand) <= DRAW_BUFFER_VISIBLE_OFFSET);
+
+struct vulkan_create_buffer_result
+{
+    VkBuffer       Buffer;
+    VkDeviceMemory Memory;
+};
+
+struct vulkan_create_image_result
+{
+    VkImage        Image;
+    VkDeviceMemory Memory;
+};
+
+struct vulkan_texture_decode
+{
+    async_read* Read;
+    arena*      Arena;    // every decoder allocation, the pixels included
+    u64         MemoryUsed;
+    stbi_uc*    Pixels;
+    int         Width;
+    int         Height;
+    int         Channels;
+};
+
+struct vulkan_context
+{
+    VkInstance            Instance;
+    VkSurfaceKHR          Surface;
+    VkExtent2D            WindowExtent;
+    VkPhysicalDevice      PhysicalDevice;
+    VkDevice              Device;
+    uint32_t              GraphicsQueueFamily;
+    uint32_t              PresentQueueFamily;
+    VkQueue               GraphicsQueue;
+    VkQueue               PresentQueue;
+    VkSwapchainKHR        Swapchain;
+    VkExtent2D            SwapchainExtent;
+    VkFormat              SwapchainImageFormat;
+    uint32_t              SwapchainImageCount;
+    VkImage               SwapchainImages[MAX_SWAPCHAIN_IMAGES];
+    VkImageView           SwapchainImageViews[MAX_SWAPCHAIN_IMAGES];
+    vulkan_resources      Resources;
+    vulkan_image_handle   ColorImage;
+    vulkan_view_handle    ColorImageView;
+    vulkan_image_handle   DepthImage;
+    vulkan_view_handle    DepthImageView;
+    VkFormat              DepthFormat;
+    b32                   DepthHasStencil;
+    VkRenderPass          RenderPass;
+    VkDescriptorSetLayout DescriptorSetLayout;
+    VkPipelineLayout      PipelineLayout;
+    vulkan_pipeline_handle GraphicsPipeline;
+    VkShaderModule        VertexShaderModule;
+    VkShaderModule        FragmentShaderModule;
+    VkFramebuffer         SwapchainFramebuffers[MAX_SWAPCHAIN_IMAGES];
+    VkCommandPool         CommandPool;
+    VkCommandBuffer       CommandBuffers[MAX_SWAPCHAIN_IMAGES];
+    VkSemaphore           ImageAvailableSemaphore[MAX_FRAMES_IN_FLIGHT];
+    VkSemaphore           RenderFinishedSemaphore[MAX_FRAMES_IN_FLIGHT];
+    VkFence               InFlightFences[MAX_FRAMES_IN_FLIGHT];
+    VkFence               InFlightImages[MAX_SWAPCHAIN_IMAGES];
+    vulkan_buffer_handle  VertexBuffer;
+    vulkan_buffer_handle  IndexBuffer;
+    vulkan_buffer_handle  UniformBuffers[MAX_SWAPCHAIN_IMAGES];
+    vulkan_buffer_handle  ObjectBuffers[MAX_SWAPCHAIN_IMAGES];   // object_transform per object
+    object_transform*     ObjectTransforms[MAX_SWAPCHAIN_IMAGES]; // ObjectBuffers, persistently mapped
+    vulkan_buffer_handle  DrawBuffers[MAX_SWAPCHAIN_IMAGES];      // indirect draw + visible indices
+    u8*                   DrawData[MAX_SWAPCHAIN_IMAGES];         // DrawBuffers, persistently mapped
+    VkDescriptorPool      DescriptorPool;
+    VkDescriptorSet       DescriptorSets[MAX_SWAPCHAIN_IMAGES];
+    vulkan_image_handle   TextureImage;
+    vulkan_view_handle    TextureImageView;
+    vulkan_sampler_handle TextureSampler;
+    VkSampleCountFlagBits MSAASampleCount;
+    u32                   CurrentFrame;
+    
+    // Scene, drawn as one instance per object
+    mat4                  ViewProj; // CameraView and the projection for the swapchain extent
+    arena                 SceneMemory;
+    transform_hierarchy   SceneHierarchy; // root, then the parent of every TRANSFORM_GROUP_OBJECTS objects
+    transform_soa         Objects;        // relative to their parent node
+    bvh                   ObjectBvh;      // the objects spin in place, built once
+};
+
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+const vertex Vertices[] = {
+    {{-0.5f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f}},
+    {{ 0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}},
+    {{ 0.5f,  0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+    {{-0.5f,  0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}, {0.0f, 1.0f}},
+    
+    {{-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.0f}},
+    {{ 0.5f, -0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}},
+    {{ 0.5f,  0.5f, -0.5f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+    {{-0.5f,  0.5f, -0.5f}, {1.0f, 1.0f, 1.0f}, {0.0f, 1.0f}}
+};
+
+const uint16_t Indices[] = {
+    0, 1, 2, 2, 3, 0,
+    4, 5, 6, 6, 7, 4
+};
+
+// The camera does not move, the view matrix is computed by the compiler
+constexpr mat4 CameraView = LookAt(V3(2.0f, 2.0f, 2.0f), V3(0.0f, 0.0f, 0.0f), V3(0.0f, 1.0f, 0.0f));
+
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+// Colors to unorm8 and texture coordinates to half, one stream per attribute through the packing
+// kernels. Scratch holds the streams until it returns.
+internal void PackVertices(packed_vertex *Dest, const vertex *Source, u32 Count, arena *Scratch)
+{
+    f32* Colors    = PushArray(Scratch, f32, 4 * Count);
+    f32* TexCoords = PushArray(Scratch, f32, 2 * Count);
+    for (u32 i = 0; i < Count; ++i)
+    {
+        Colors[4 * i + 0]    = Source[i].color.x;
+        Colors[4 * i + 1]    = Source[i].color.y;
+        Colors[4 * i + 2]    = Source[i].color.z;
+        Colors[4 * i + 3]    = 1.0f;
+        TexCoords[2 * i + 0] = Source[i].texCoord.x;
+        TexCoords[2 * i + 1] = Source[i].texCoord.y;
+    }
+    
+    u8*  PackedColors    = PushArray(Scratch, u8,  4 * Count);
+    u16* PackedTexCoords = PushArray(Scratch, u16, 2 * Count);
+    PackUnorm8(PackedColors, Colors, 4 * Count);
+    PackHalf(PackedTexCoords, TexCoords, 2 * Count);
+    
+    for (u32 i = 0; i < Count; ++i)
+    {
+        Dest[i].pos = Source[i].pos;
+        memcpy(Dest[i].color,    PackedColors    + 4 * i, sizeof(Dest[i].color));
+        memcpy(Dest[i].texCoord, PackedTexCoords + 2 * i, sizeof(Dest[i].texCoord));
+    }
+}
+
+internal b32 StringsAreEqual(const char * A, const char * B)
+{
+    while (*A && *A == *B)
+    {
+        A++;
+        B++;
+    }
+    
+    return (*A == *B);
+}
+
+// Vulkan stuff ///////////////////////////////////////////////////////////////////////////////
+
+internal VkOffset3D VulkanOffset3D(int32_t X, int32_t Y, int32_t Z)
+{
+    VkOffset3D Res = { X, Y, Z };
+    return Res;
+}
+
+internal uint32_t VulkanFindMemoryType(VkPhysicalDevice PhysicalDevice, uint32_t TypeFilter, VkMemoryPropertyFlags Properties)
+{
+    VkPhysicalDeviceMemoryProperties MemProperties;
+    vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &MemProperties);
+    
+    for (uint32_t i = 0; i < MemProperties.memoryTypeCount; ++i)
+    {
+        if (TypeFilter & (1 << i) && (MemProperties.memoryTypes[i].propertyFlags & Properties) == Properties)
+        {
+            return i;
+        }
+    }
+    
+    Assert(false && "Failed to find suitable memory type");
+    return 0;
+}
+
+internal vulkan_create_buffer_result VulkanCreateBuffer(VkPhysicalDevice PhysicalDevice, VkDevice LogicalDevice, VkDeviceSize Size, VkBufferUsageFlags Usage, VkMemoryPropertyFlags Properties, u32 Tag)
+{
+    vulkan_create_buffer_result Res = {};
+    
+    // create buffer
+    VkBufferCreateInfo VertexBufferCreateInfo = {};
+    VertexBufferCreateInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    VertexBufferCreateInfo.size        = Size;
+    VertexBufferCreateInfo.usage       = Usage;
+    VertexBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    
+    if (vkCreateBuffer(LogicalDevice, &VertexBufferCreateInfo, VulkanAllocator, &Res.Buffer) != VK_SUCCESS) {
+        ExitWithError("Failed to create vertex buffer");
+    }
+    
+    // alloc buffer memory
+    VkMemoryRequirements MemRequirements;
+    vkGetBufferMemoryRequirements(LogicalDevice, Res.Buffer, &MemRequirements);
+    
+    VkMemoryAllocateInfo MemAllocInfo = {};
+    MemAllocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    MemAllocInfo.allocationSize  = MemRequirements.size;
+    MemAllocInfo.memoryTypeIndex = VulkanFindMemoryType(PhysicalDevice, MemRequirements.memoryTypeBits, Properties);
+    
+    if (VulkanAllocateMemory(LogicalDevice, &MemAllocInfo, Tag, &Res.Memory) != VK_SUCCESS) {
+        ExitWithError("Failed to allocate vertex buffer memory");
+    }
+    
+    vkBindBufferMemory(LogicalDevice, Res.Buffer, Res.Memory, 0);
+    
+    return Res;
+}
+
+internal VkCommandBuffer VulkanBeginSingleTimeCommands(VkDevice Device, VkCommandPool CommandPool)
+{
+    VkCommandBufferAllocateInfo AllocInfo = {};
+    AllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    AllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    AllocInfo.commandPool = CommandPool;
+    AllocInfo.commandBufferCount = 1;
+    
+    VkCommandBuffer CommandBuffer;
+    vkAllocateCommandBuffers(Device, &AllocInfo, &CommandBuffer);
+    
+    VkCommandBufferBeginInfo BeginInfo = {};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    
+    vkBeginCommandBuffer(CommandBuffer, &BeginInfo);
+    
+    return CommandBuffer;
+}
+
+internal void VulkanEndSingleTimeCommands(VkDevice Device, VkCommandPool CommandPool, VkCommandBuffer CommandBuffer, VkQueue Queue)
+{
+    vkEndCommandBuffer(CommandBuffer);
+    
+    VkSubmitInfo SubmitInfo = {};
+    SubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.commandBufferCount = 1;
+    SubmitInfo.pCommandBuffers    = &CommandBuffer;
+    
+    vkQueueSubmit(Queue, 1, &SubmitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(Queue);
+    
+    vkFreeCommandBuffers(Device, CommandPool, 1, &CommandBuffer);
+}
+
+internal void VulkanCopyBuffer(vulkan_context *Vk, VkBuffer SrcBuffer, VkBuffer DstBuffer, VkDeviceSize Size)
+{
+    VkCommandBuffer CommandBuffer = VulkanBeginSingleTimeCommands(Vk->Device, Vk->CommandPool);
+    
+    VkBufferCopy CopyRegion = {};
+    CopyRegion.srcOffset = 0;
+    CopyRegion.dstOffset = 0;
+    CopyRegion.size      = Size;
+    vkCmdCopyBuffer(CommandBuffer, SrcBuffer, DstBuffer, 1, &CopyRegion);
+    
+    VulkanEndSingleTimeCommands(Vk->Device, Vk->CommandPool, CommandBuffer, Vk->GraphicsQueue);
+}
+
+internal void VulkanCopyBufferToImage(vulkan_context *Vk, VkBuffer Buffer, VkImage Image, uint32_t Width, uint32_t Height)
+{
+    VkCommandBuffer CommandBuffer = VulkanBeginSingleTimeCommands(Vk->Device, Vk->CommandPool);
+    
+    VkBufferImageCopy Region = {};
+    Region.bufferOffset                    = 0;
+    Region.bufferRowLength                 = 0;
+    Region.bufferImageHeight               = 0;
+    Region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    Region.imageSubresource.mipLevel       = 0;
+    Region.imageSubresource.baseArrayLayer = 0;
+    Region.imageSubresource.layerCount     = 1;
+    Region.imageOffset.x                   = 0;
+    Region.imageOffset.y                   = 0;
+    Region.imageOffset.z                   = 0;
+    Region.imageExtent.width               = Width;
+    Region.imageExtent.height              = Height;
+    Region.imageExtent.depth               = 1;
+    
+    vkCmdCopyBufferToImage(CommandBuffer, Buffer, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+    
+    VulkanEndSingleTimeCommands(Vk->Device, Vk->CommandPool, CommandBuffer, Vk->GraphicsQueue);
+}
+
+internal void VulkanTransitionImageLayout(vulkan_context* Vk, VkImage Image, VkFormat Format, VkImageLayout OldLayout, VkImageLayout NewLayout, u32 MipLevelCount)
+{
+    VkCommandBuffer CommandBuffer = VulkanBeginSingleTimeCommands(Vk->Device, Vk->CommandPool);
+    
+    VkImageAspectFlags AspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    if (NewLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
+        AspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        if (Format == VK_FORMAT_D32_SFLOAT_S8_UINT ||
+            Format == VK_FORMAT_D24_UNORM_S8_UINT) {
+            AspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+    }
+    
+    VkImageMemoryBarrier Barrier = {};
+    Barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier.oldLayout                       = OldLayout;
+    Barrier.newLayout                       = NewLayout;
+    Barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.image                           = Image;
+    Barrier.subresourceRange.aspectMask     = AspectMask;
+    Barrier.subresourceRange.baseMipLevel   = 0;
+    Barrier.subresourceRange.levelCount     = MipLevelCount;
+    Barrier.subresourceRange.baseArrayLayer = 0;
+    Barrier.subresourceRange.layerCount     = 1;
+    Barrier.srcAccessMask                   = 0;
+    Barrier.dstAccessMask                   = 0;
+    
+    VkPipelineStageFlags SrcStage;
+    VkPipelineStageFlags DstStage;
+    
+    if (OldLayout == VK_IMAGE_LAYOUT_UNDEFINED && NewLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    {
+        Barrier.srcAccessMask = 0;
+        Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        SrcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        DstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+    else if (OldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && NewLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL )
+    {
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        SrcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        DstStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    }
+    else if (OldLayout == VK_IMAGE_LAYOUT_UNDEFINED && NewLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+    {
+        Barrier.srcAccessMask = 0;
+        Barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        SrcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        DstStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    }
+    else
+    {
+        ExitWithError("Unsupported layout transition");
+    }
+    
+    vkCmdPipelineBarrier(CommandBuffer,
+                         SrcStage, DstStage,
+                         0,
+                         0, NULL,
+                         0, NULL,
+                         1, &Barrier
+                         );
+    
+    VulkanEndSingleTimeCommands(Vk->Device, Vk->CommandPool, CommandBuffer, Vk->GraphicsQueue);
+}
+
+internal void VulkanGenerateMipmaps(vulkan_context* Vk, VkImage Image, VkFormat ImageFormat, u32 Width, u32 Height, u32 MipCount)
+{
+    VkFormatProperties FormatProperties;
+    vkGetPhysicalDeviceFormatProperties(Vk->PhysicalDevice, ImageFormat, &FormatProperties);
+    if (!(FormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+        ExitWithError("Texture image format does not support linear blitting");
+    }
+    
+    VkCommandBuffer CommandBuffer = VulkanBeginSingleTimeCommands(Vk->Device, Vk->CommandPool);
+    
+    VkImageMemoryBarrier Barrier = {};
+    Barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    Barrier.image                           = Image;
+    Barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    Barrier.subresourceRange.baseArrayLayer = 0;
+    Barrier.subresourceRange.layerCount     = 1;
+    Barrier.subresourceRange.levelCount     = 1;
+    
+    for (u32 i = 1; i < MipCount; ++i)
+    {
+        Barrier.subresourceRange.baseMipLevel = i - 1;
+        Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        Barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        
+        vkCmdPipelineBarrier(CommandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, NULL,
+                             0, NULL,
+                             1, &Barrier);
+        
+        VkImageBlit Blit = {};
+        Blit.srcOffsets[0]                 = VulkanOffset3D( 0, 0, 0 );
+        Blit.srcOffsets[1]                 = VulkanOffset3D( Width, Height, 1 );
+        Blit.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        Blit.srcSubresource.mipLevel       = i - 1;
+        Blit.srcSubresource.baseArrayLayer = 0;
+        Blit.srcSubresource.layerCount     = 1;
+        Blit.dstOffsets[0]                 = VulkanOffset3D( 0, 0, 0 );
+        Blit.dstOffsets[1]                 = VulkanOffset3D( Width>1 ? Width/2 : 1, Height>1 ? Height/2 : 1, 1 );
+        Blit.dstSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        Blit.dstSubresource.mipLevel       = i;
+        Blit.dstSubresource.baseArrayLayer = 0;
+        Blit.dstSubresource.layerCount     = 1;
+        
+        vkCmdBlitImage(CommandBuffer, Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Blit, VK_FILTER_LINEAR);
+        
+        Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        Barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        Barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        
+        vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                             0, NULL,
+                             0, NULL,
+                             1, &Barrier);
+        
+        if (Width > 1) Width = Width/2;
+        if (Height > 1) Height = Height/2;
+    }
+    
+    Barrier.subresourceRange.baseMipLevel = MipCount - 1;
+    Barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    Barrier.newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    Barrier.srcAccessMask                 = VK_ACCESS_TRANSFER_WRITE_BIT;
+    Barrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
+    
+    vkCmdPipelineBarrier(CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, NULL,
+                         0, NULL,
+                         1, &Barrier);
+    
+    VulkanEndSingleTimeCommands(Vk->Device, Vk->CommandPool, CommandBuffer, Vk->GraphicsQueue);
+}
+
+// Serves the asset from the archive when it is there (the bytes stay in the mapping and the read is
+// already completed), otherwise queues an asynchronous read of the loose file
+internal b32 VulkanRequestAsset(pak *Pak, async_read *Read, arena *Arena)
+{
+    read_file_result Packed = PakFind(Pak, Read->FilePath);
+    if (Packed.Bytes)
+    {
+        Read->Bytes     = Packed.Bytes;
+        Read->ByteCount = Packed.ByteCount;
+        Read->Succeeded = true;
+        Read->Completed = true;
+        return true;
+    }
+    
+    return AsyncIOSubmitRead(Read, Arena);
+}
+
+// Job: waits for the texture read and decodes it to RGBA8
+internal void VulkanDecodeTextureJob(void *Data)
+{
+    vulkan_texture_decode *Decode = (vulkan_texture_decode*)Data;
+    
+    AsyncIOWaitFor(Decode->Read);
+    if (Decode->Read->Succeeded)
+    {
+        StbiBindArena(Decode->Arena);
+        Decode->Pixels = stbi_load_from_memory(Decode->Read->Bytes, (int)Decode->Read->ByteCount, &Decode->Width, &Decode->Height, &Decode->Channels, STBI_rgb_alpha);
+        StbiBindArena(0);
+        
+        Decode->MemoryUsed = Decode->Arena->HighWater;
+        MemoryTrackAlloc(MemoryTag_ImageDecode, Decode->MemoryUsed);
+    }
+}
+
+internal VkShaderModule VulkanCreateShaderModule(VkDevice Device, const u8* Bytes, u32 ByteCount)
+{
+    VkShaderModuleCreateInfo ShaderModuleCreateInfo = {};
+    ShaderModuleCreateInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    ShaderModuleCreateInfo.codeSize = ByteCount;
+    ShaderModuleCreateInfo.pCode    = (const uint32_t*)Bytes;
+    
+    VkShaderModule ShaderModule;
+    if (vkCreateShaderModule(Device, &ShaderModuleCreateInfo, VulkanAllocator, &ShaderModule) != VK_SUCCESS) {
+        ExitWithError("Failed to create shader module");
+    }
+    
+    return ShaderModule;
+}
+
+internal vulkan_create_image_result VulkanCreateImage(VkPhysicalDevice PhysicalDevice, VkDevice LogicalDevice, u32 Width, u32 Height, u32 MipLevelCount, VkSampleCountFlagBits SampleCount, VkFormat Format, VkImageTiling Tiling, VkImageUsageFlags UsageFlags, VkMemoryPropertyFlags MemoryFlags, u32 Tag)
+{
+    // create image
+    VkImageCreateInfo ImageCreateInfo = {};
+    ImageCreateInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ImageCreateInfo.imageType     = VK_IMAGE_TYPE_2D;
+    ImageCreateInfo.extent.width  = Width;
+    ImageCreateInfo.extent.height = Height;
+    ImageCreateInfo.extent.depth  = 1;
+    ImageCreateInfo.mipLevels     = MipLevelCount;
+    ImageCreateInfo.arrayLayers   = 1;
+    ImageCreateInfo.format        = Format;
+    ImageCreateInfo.tiling        = Tiling; // implementation defined
+    ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    ImageCreateInfo.usage         = UsageFlags;
+    ImageCreateInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+    ImageCreateInfo.samples       = SampleCount; // only for multisampled attachments
+    ImageCreateInfo.flags         = 0;
+    
+    vulkan_create_image_result Res;
+    if (vkCreateImage(LogicalDevice, &ImageCreateInfo, VulkanAllocator, &Res.Image) != VK_SUCCESS) {
+        ExitWithError("Failed to create image");
+    }
+    
+    // create image memory
+    VkMemoryRequirements MemRequirements;
+    vkGetImageMemoryRequirements(LogicalDevice, Res.Image, &MemRequirements);
+    
+    VkMemoryAllocateInfo AllocInfo = {};
+    AllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    AllocInfo.allocationSize = MemRequirements.size;
+    AllocInfo.memoryTypeIndex = VulkanFindMemoryType(PhysicalDevice, MemRequirements.memoryTypeBits, MemoryFlags);
+    
+    if (VulkanAllocateMemory(LogicalDevice, &AllocInfo, Tag, &Res.Memory) != VK_SUCCESS) {
+        ExitWithError("Failed to allocate image memory");
+    }
+    
+    vkBindImageMemory(LogicalDevice, Res.Image, Res.Memory, 0);
+    
+    return Res;
+}
+
+internal VkImageView VulkanCreateImageView(VkDevice Device, VkImage Image, VkFormat Format, VkImageAspectFlags AspectFlags, u32 MipLevelCount)
+{
+    VkImageViewCreateInfo ImageViewCreateInfo = {};
+    ImageViewCreateInfo.sType        = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    ImageViewCreateInfo.image        = Image;
+    ImageViewCreateInfo.viewType     = VK_IMAGE_VIEW_TYPE_2D;
+    ImageViewCreateInfo.format       = Format;
+    ImageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    ImageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    ImageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    ImageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    ImageViewCreateInfo.subresourceRange.aspectMask     = AspectFlags;
+    ImageViewCreateInfo.subresourceRange.baseMipLevel   = 0;
+    ImageViewCreateInfo.subresourceRange.levelCount     = MipLevelCount;
+    ImageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+    ImageViewCreateInfo.subresourceRange.layerCount     = 1;
+    
+    VkImageView ImageView;
+    if (vkCreateImageView(Device, &ImageViewCreateInfo, VulkanAllocator, &ImageView) != VK_SUCCESS) {
+        ExitWithError("Failed to create texture image view");
+    }
+    
+    return ImageView;
+}
+
+internal void VulkanCreateSwapchain(vulkan_context *Vk)
+{
+    // Vulkan: Swap chain
+    {
+        VkSurfaceFormatKHR SurfaceFormat;
+        VkPresentModeKHR   PresentMode;
+        
+        VkSurfaceCapabilitiesKHR Capabilities;
+        VkSurfaceFormatKHR       Formats[64];
+        VkPresentModeKHR         PresentModes[64];
+        
+        // choose the best format
+        uint32_t FormatCount = ArrayCount(Formats);
+        VkResult Res = vkGetPhysicalDeviceSurfaceFormatsKHR(Vk->PhysicalDevice, Vk->Surface, &FormatCount, Formats);
+        Assert(Res == VK_SUCCESS);
+        
+        SurfaceFormat = Formats[0];
+        for (u32 i = 1; i < FormatCount; ++i)
+        {
+            if (Formats[i].format == VK_FORMAT_B8G8R8A8_SRGB &&
+                Formats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+            {
+                SurfaceFormat = Formats[i];
+                break;
+            }
+        }
+        
+        Vk->SwapchainImageFormat = SurfaceFormat.format;
+        
+        // choose the best present mode
+        uint32_t PresentModesCount = ArrayCount(PresentModes);
+        Res = vkGetPhysicalDeviceSurfacePresentModesKHR(Vk->PhysicalDevice, Vk->Surface, &PresentModesCount, PresentModes);
+        Assert(Res == VK_SUCCESS);
+        
+        PresentMode = PresentModes[0];
+        for (u32 i = 1; i < PresentModesCount; ++i)
+        {
+            if (PresentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+            {
+                PresentMode = PresentModes[i];
+                break;
+            }
+        }
+        
+        // get the extent
+        vkGetPhysicalDeviceSurfaceCapabilitiesKHR(Vk->PhysicalDevice, Vk->Surface, &Capabilities);
+        if (Capabilities.currentExtent.width != UINT32_MAX)
+        {
+            Vk->SwapchainExtent = Capabilities.currentExtent;
+        }
+        else
+        {
+            // NOTE(jdiaz): The platform layer keeps WindowExtent up to date
+            u32 Width  = Vk->WindowExtent.width;
+            u32 Height = Vk->WindowExtent.height;
+            
+            Vk->SwapchainExtent.width = Max(Capabilities.minImageExtent.width,  Min(Capabilities.maxImageExtent.width, Width));
+            Vk->SwapchainExtent.height = Max(Capabilities.minImageExtent.height, Min(Capabilities.maxImageExtent.height, Height));
+        }
+        
+        // the projection only changes with the extent (Y flipped, Vulkan clip space points down)
+        mat4 Proj = Perspective(Radians(45.0f), Vk->SwapchainExtent.width / (f32)Vk->SwapchainExtent.height, 0.1f, 10.0f);
+        Proj.data[1][1] *= -1.0f;
+        Vk->ViewProj = Proj * CameraView;
+        
+        // set the number of images
+        uint32_t ImageCount = Capabilities.minImageCount + 1;
+        if (Capabilities.maxImageCount > 0)
+            ImageCount = Min(ImageCount, Capabilities.maxImageCount);
+        Assert(ImageCount <= ArrayCount(Vk->SwapchainImages));
+        
+        // create swap chain
+        VkSwapchainCreateInfoKHR SwapchainCreateInfo = {};
+        SwapchainCreateInfo.sType            = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+        SwapchainCreateInfo.surface          = Vk->Surface;
+        SwapchainCreateInfo.minImageCount    = ImageCount;
+        SwapchainCreateInfo.imageFormat      = SurfaceFormat.format;
+        SwapchainCreateInfo.imageColorSpace  = SurfaceFormat.colorSpace;
+        SwapchainCreateInfo.imageExtent      = Vk->SwapchainExtent;
+        SwapchainCreateInfo.imageArrayLayers = 1; // 1 unless stereo images
+        SwapchainCreateInfo.imageUsage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        
+        uint32_t QueueFamilyIndices[] = { Vk->GraphicsQueueFamily, Vk->PresentQueueFamily };
+        if ( Vk->GraphicsQueueFamily != Vk->PresentQueueFamily )
+        {
+            SwapchainCreateInfo.imageSharingMode      = VK_SHARING_MODE_CONCURRENT;
+            SwapchainCreateInfo.queueFamilyIndexCount = ArrayCount(QueueFamilyIndices);
+            SwapchainCreateInfo.pQueueFamilyIndices   = QueueFamilyIndices;
+        }
+        else
+        {
+            SwapchainCreateInfo.imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE;
+            SwapchainCreateInfo.queueFamilyIndexCount = 0;    // opt
+            SwapchainCreateInfo.pQueueFamilyIndices   = NULL; // opt
+        }
+        
+        SwapchainCreateInfo.preTransform   = Capabilities.currentTransform;
+        SwapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+        SwapchainCreateInfo.presentMode    = PresentMode;
+        SwapchainCreateInfo.clipped        = VK_TRUE;
+        SwapchainCreateInfo.oldSwapchain   = VK_NULL_HANDLE;
+        
+        if (vkCreateSwapchainKHR(Vk->Device, &SwapchainCreateInfo, VulkanAllocator, &Vk->Swapchain) != VK_SUCCESS) {
+            ExitWithError("Failed to create the swap chain");
+        }
+        
+        Vk->SwapchainImageCount = ImageCount;
+        Res = vkGetSwapchainImagesKHR(Vk->Device, Vk->Swapchain, &Vk->SwapchainImageCount, Vk->SwapchainImages);
+        Assert(Res == VK_SUCCESS);
+        
+        // create chapchain image views
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i)
+        {
+            Vk->SwapchainImageViews[i] = VulkanCreateImageView(Vk->Device, Vk->SwapchainImages[i], Vk->SwapchainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+        }
+    }
+    
+    // Vulkan: Render pass
+    {
+        // attachment description
+        
+        VkAttachmentDescription ColorAttachment = {};
+        ColorAttachment.format         = Vk->SwapchainImageFormat;
+        ColorAttachment.samples        = Vk->MSAASampleCount;
+        ColorAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        ColorAttachment.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+        ColorAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        ColorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        ColorAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        ColorAttachment.finalLayout    = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        
+        VkAttachmentReference ColorAttachmentRef = {};
+        ColorAttachmentRef.attachment = 0; // index in the pAttachments render pass global array
+        ColorAttachmentRef.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        
+        VkAttachmentDescription DepthAttachment = {};
+        DepthAttachment.format         = Vk->DepthFormat;
+        DepthAttachment.samples        = Vk->MSAASampleCount;
+        DepthAttachment.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        DepthAttachment.storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE; // because we won't use it after render
+        DepthAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        DepthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        DepthAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        DepthAttachment.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        
+        VkAttachmentReference DepthAttachmentRef = {};
+        DepthAttachmentRef.attachment = 1; // index in the pAttachments render pass global array
+        DepthAttachmentRef.layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        
+        VkAttachmentDescription ColorAttachmentResolve = {};
+        ColorAttachmentResolve.format         = Vk->SwapchainImageFormat;
+        ColorAttachmentResolve.samples        = VK_SAMPLE_COUNT_1_BIT;
+        ColorAttachmentResolve.loadOp         = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        ColorAttachmentResolve.storeOp        = VK_ATTACHMENT_STORE_OP_STORE;
+        ColorAttachmentResolve.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        ColorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        ColorAttachmentResolve.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
+        ColorAttachmentResolve.finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        
+        VkAttachmentReference ColorAttachmentResolveRef = {};
+        ColorAttachmentResolveRef.attachment = 2; // index in the pAttachments render pass global array
+        ColorAttachmentResolveRef.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        
+        VkSubpassDescription Subpass    = {};
+        Subpass.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        Subpass.colorAttachmentCount    = 1;
+        Subpass.pColorAttachments       = &ColorAttachmentRef; // position in this array is the attachment location in the shader
+        Subpass.pResolveAttachments     = &ColorAttachmentResolveRef;
+        Subpass.pDepthStencilAttachment = &DepthAttachmentRef;
+        
+        // NOTE(jdiaz): Didn't understand these flags very well...
+        VkSubpassDependency SubpassDependency = {};
+        SubpassDependency.srcSubpass    = VK_SUBPASS_EXTERNAL;
+        SubpassDependency.dstSubpass    = 0;
+        SubpassDependency.srcStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        SubpassDependency.srcAccessMask = 0;
+        SubpassDependency.dstStageMask  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        SubpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        
+        VkAttachmentDescription Attachments[] = {ColorAttachment, DepthAttachment, ColorAttachmentResolve};
+        
+        VkRenderPassCreateInfo RenderPassCreateInfo = {};
+        RenderPassCreateInfo.sType           = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        RenderPassCreateInfo.attachmentCount = ArrayCount(Attachments);
+        RenderPassCreateInfo.pAttachments    = Attachments;
+        RenderPassCreateInfo.subpassCount    = 1;
+        RenderPassCreateInfo.pSubpasses      = &Subpass;
+        RenderPassCreateInfo.dependencyCount = 1;
+        RenderPassCreateInfo.pDependencies   = &SubpassDependency;
+        
+        if (vkCreateRenderPass(Vk->Device, &RenderPassCreateInfo, VulkanAllocator, &Vk->RenderPass) != VK_SUCCESS) {
+            ExitWithError("Render pass could not be created");
+        }
+    }
+    
+    // Vulkan: Graphics pipeline
+    {
+        // shader modules (created once in VulkanInit, they survive swapchain recreation)
+        
+        VkPipelineShaderStageCreateInfo VSStageCreateInfo = {};
+        VSStageCreateInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        VSStageCreateInfo.stage  = VK_SHADER_STAGE_VERTEX_BIT;
+        VSStageCreateInfo.module = Vk->VertexShaderModule;
+        VSStageCreateInfo.pName  = "main";
+        
+        VkPipelineShaderStageCreateInfo FSStageCreateInfo = {};
+        FSStageCreateInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        FSStageCreateInfo.stage  = VK_SHADER_STAGE_FRAGMENT_BIT;
+        FSStageCreateInfo.module = Vk->FragmentShaderModule;
+        FSStageCreateInfo.pName  = "main";
+        
+        VkPipelineShaderStageCreateInfo ShaderStages[] = { VSStageCreateInfo, FSStageCreateInfo };
+        
+        // Vertex input
+        
+        VkVertexInputBindingDescription VertexBindingDescription = {};
+        VertexBindingDescription.binding   = 0;
+        VertexBindingDescription.stride    = sizeof(packed_vertex);
+        VertexBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Change to INSTANCE for instancing
+        
+        VkVertexInputAttributeDescription VertexAttributesDescription[3] = {};
+        VertexAttributesDescription[0].binding  = 0;
+        VertexAttributesDescription[0].location = 0;
+        VertexAttributesDescription[0].format   = VK_FORMAT_R32G32B32_SFLOAT;
+        VertexAttributesDescription[0].offset   = OffsetOf(packed_vertex, pos);
+        VertexAttributesDescription[1].binding  = 0;
+        VertexAttributesDescription[1].location = 1;
+        VertexAttributesDescription[1].format   = VK_FORMAT_R8G8B8A8_UNORM;
+        VertexAttributesDescription[1].offset   = OffsetOf(packed_vertex, color);
+        VertexAttributesDescription[2].binding  = 0;
+        VertexAttributesDescription[2].location = 2;
+        VertexAttributesDescription[2].format   = VK_FORMAT_R16G16_SFLOAT;
+        VertexAttributesDescription[2].offset   = OffsetOf(packed_vertex, texCoord);
+        
+        VkPipelineVertexInputStateCreateInfo VertexInputCreateInfo = {};
+        VertexInputCreateInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        VertexInputCreateInfo.vertexBindingDescriptionCount   = 1;
+        VertexInputCreateInfo.pVertexBindingDescriptions      = &VertexBindingDescription;
+        VertexInputCreateInfo.vertexAttributeDescriptionCount = ArrayCount(VertexAttributesDescription);
+        VertexInputCreateInfo.pVertexAttributeDescriptions    = VertexAttributesDescription;
+        
+        // Input assembly
+        
+        VkPipelineInputAssemblyStateCreateInfo InputAssemblyCreateInfo = {};
+        InputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        InputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        InputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+        
+        // Viewports / scissors
+        
+        VkViewport Viewport = {};
+        Viewport.x = 0.0f;
+        Viewport.y = 0.0f;
+        Viewport.width  = (f32)Vk->SwapchainExtent.width;
+        Viewport.height = (f32)Vk->SwapchainExtent.height;
+        Viewport.minDepth = 0.0f;
+        Viewport.maxDepth = 1.0;
+        
+        VkRect2D Scissor = {};
+        Scissor.extent = Vk->SwapchainExtent;
+        
+        VkPipelineViewportStateCreateInfo ViewportStateCreateInfo = {};
+        ViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        ViewportStateCreateInfo.viewportCount = 1;
+        ViewportStateCreateInfo.pViewports    = &Viewport;
+        ViewportStateCreateInfo.scissorCount = 1;
+        ViewportStateCreateInfo.pScissors     = &Scissor;
+        
+        // Rasterizer
+        
+        VkPipelineRasterizationStateCreateInfo RasterizerCreateInfo = {};
+        RasterizerCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        RasterizerCreateInfo.depthClampEnable        = VK_FALSE;
+        RasterizerCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+        RasterizerCreateInfo.polygonMode             = VK_POLYGON_MODE_FILL;
+        RasterizerCreateInfo.lineWidth               = 1.0f;
+        RasterizerCreateInfo.cullMode                = VK_CULL_MODE_BACK_BIT;
+        RasterizerCreateInfo.frontFace               = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        RasterizerCreateInfo.depthBiasEnable         = VK_FALSE;
+        RasterizerCreateInfo.depthBiasConstantFactor = 0.0f;
+        RasterizerCreateInfo.depthBiasClamp          = 0.0f;
+        RasterizerCreateInfo.depthBiasSlopeFactor    = 0.0f;
+        
+        // Multisampling
+        
+        VkPipelineMultisampleStateCreateInfo MultisampleCreateInfo = {};
+        MultisampleCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        MultisampleCreateInfo.sampleShadingEnable   = VK_FALSE; // VK_TRUE also applies MSAA to shading (if supported)
+        MultisampleCreateInfo.rasterizationSamples  = Vk->MSAASampleCount;
+        MultisampleCreateInfo.minSampleShading      = 1.0f;     // If sampleShadingEnabled, close to 1.0 means smoother
+        MultisampleCreateInfo.pSampleMask           = NULL;
+        MultisampleCreateInfo.alphaToCoverageEnable = VK_FALSE;
+        MultisampleCreateInfo.alphaToOneEnable      = VK_FALSE;
+        
+        // Depth / stencil
+        
+        VkPipelineDepthStencilStateCreateInfo DepthStencilCreateInfo = {};
+        DepthStencilCreateInfo.sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        DepthStencilCreateInfo.depthTestEnable       = VK_TRUE;
+        DepthStencilCreateInfo.depthWriteEnable      = VK_TRUE;
+        DepthStencilCreateInfo.depthCompareOp        = VK_COMPARE_OP_LESS;
+        DepthStencilCreateInfo.depthBoundsTestEnable = VK_FALSE;
+        DepthStencilCreateInfo.minDepthBounds        = 0.0f;
+        DepthStencilCreateInfo.maxDepthBounds        = 1.0f;
+        DepthStencilCreateInfo.stencilTestEnable     = VK_FALSE;
+        //DepthStencilCreateInfo.front;
+        //DepthStencilCreateInfo.back;
+        
+        // Color blending
+        
+        VkPipelineColorBlendAttachmentState ColorBlendAttachment = {};
+        ColorBlendAttachment.colorWriteMask      = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        ColorBlendAttachment.blendEnable         = VK_FALSE;
+        ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+        ColorBlendAttachment.colorBlendOp        = VK_BLEND_OP_ADD;
+        ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        ColorBlendAttachment.alphaBlendOp        = VK_BLEND_OP_ADD;
+        
+        VkPipelineColorBlendStateCreateInfo ColorBlendingCreateInfo = {};
+        ColorBlendingCreateInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        ColorBlendingCreateInfo.logicOpEnable     = VK_FALSE;
+        ColorBlendingCreateInfo.logicOp           = VK_LOGIC_OP_COPY;
+        ColorBlendingCreateInfo.attachmentCount   = 1;
+        ColorBlendingCreateInfo.pAttachments      = &ColorBlendAttachment;
+        ColorBlendingCreateInfo.blendConstants[0] = 0.0f;
+        ColorBlendingCreateInfo.blendConstants[1] = 0.0f;
+        ColorBlendingCreateInfo.blendConstants[2] = 0.0f;
+        ColorBlendingCreateInfo.blendConstants[3] = 0.0f;
+        
+        // Dynamic state
+        
+        /*
+// Dynamic states must be specified at draw time (if we need them)
+        VkDynamicState DynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_LINE_WIDTH };
+        
+        VkPipelineDynamicStateCreateInfo DynamicStateCreateInfo = {};
+        DynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        DynamicStateCreateInfo.dynamicStateCount = ArrayCount(DynamicStates);
+        DynamicStateCreateInfo.pDynamicStates    = DynamicStates;
+*/
+        
+        // Pipeline layout
+        
+        VkPipelineLayout PipelineLayout;
+        
+        VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo = {};
+        PipelineLayoutCreateInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        PipelineLayoutCreateInfo.setLayoutCount         = 1;
+        PipelineLayoutCreateInfo.pSetLayouts            = &Vk->DescriptorSetLayout;
+        PipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+        PipelineLayoutCreateInfo.pPushConstantRanges    = NULL;
+        
+        if (vkCreatePipelineLayout(Vk->Device, &PipelineLayoutCreateInfo, VulkanAllocator, &Vk->PipelineLayout) != VK_SUCCESS) {
+            ExitWithError("Could not create the pipeline layout");
+        }
+        
+        // Graphics pipeline!!!
+        
+        VkGraphicsPipelineCreateInfo GraphicsPipelineCreateInfo = {};
+        GraphicsPipelineCreateInfo.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        GraphicsPipelineCreateInfo.stageCount          = 2;
+        GraphicsPipelineCreateInfo.pStages             = ShaderStages;
+        GraphicsPipelineCreateInfo.pVertexInputState   = &VertexInputCreateInfo;
+        GraphicsPipelineCreateInfo.pInputAssemblyState = &InputAssemblyCreateInfo;
+        GraphicsPipelineCreateInfo.pViewportState      = &ViewportStateCreateInfo;
+        GraphicsPipelineCreateInfo.pRasterizationState = &RasterizerCreateInfo;
+        GraphicsPipelineCreateInfo.pMultisampleState   = &MultisampleCreateInfo;
+        GraphicsPipelineCreateInfo.pDepthStencilState  = &DepthStencilCreateInfo;
+        GraphicsPipelineCreateInfo.pColorBlendState    = &ColorBlendingCreateInfo;
+        GraphicsPipelineCreateInfo.pDynamicState       = NULL;
+        
+        GraphicsPipelineCreateInfo.layout              = Vk->PipelineLayout;
+        
+        GraphicsPipelineCreateInfo.renderPass          = Vk->RenderPass;
+        GraphicsPipelineCreateInfo.subpass             = 0; // graphics subpass index
+        
+        GraphicsPipelineCreateInfo.basePipelineHandle  = VK_NULL_HANDLE;
+        GraphicsPipelineCreateInfo.basePipelineIndex   = -1;
+        
+        VkPipeline GraphicsPipeline;
+        if (vkCreateGraphicsPipelines(Vk->Device, VK_NULL_HANDLE, 1, &GraphicsPipelineCreateInfo, VulkanAllocator, &GraphicsPipeline) != VK_SUCCESS) {
+            ExitWithError("Graphics pipeline could not be created");
+        }
+        Vk->GraphicsPipeline = VulkanAddPipeline(&Vk->Resources, GraphicsPipeline, Vk->PipelineLayout);
+    }
+    
+    // Vulkan: Color buffer
+    {
+        VkFormat ColorFormat = Vk->SwapchainImageFormat;
+        
+        vulkan_create_image_result Color = VulkanCreateImage(Vk->PhysicalDevice, Vk->Device,
+                                                             Vk->SwapchainExtent.width,
+                                                             Vk->SwapchainExtent.height,
+                                                             1,
+                                                             Vk->MSAASampleCount,
+                                                             ColorFormat,
+                                                             VK_IMAGE_TILING_OPTIMAL,
+                                                             VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                             MemoryTag_RenderTargets);
+        Vk->ColorImage     = VulkanAddImage(&Vk->Resources, Color.Image, Color.Memory, ColorFormat, Vk->SwapchainExtent.width, Vk->SwapchainExtent.height, 1);
+        Vk->ColorImageView = VulkanAddView(&Vk->Resources, VulkanCreateImageView(Vk->Device, Color.Image, ColorFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1), Vk->ColorImage);
+    }
+    
+    // Vulkan: Depth buffer
+    {
+        vulkan_create_image_result Depth = VulkanCreateImage(Vk->PhysicalDevice, Vk->Device,
+                                                             Vk->SwapchainExtent.width,
+                                                             Vk->SwapchainExtent.height,
+                                                             1,
+                                                             Vk->MSAASampleCount,
+                                                             Vk->DepthFormat,
+                                                             VK_IMAGE_TILING_OPTIMAL,
+                                                             VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                             MemoryTag_RenderTargets);
+        Vk->DepthImage     = VulkanAddImage(&Vk->Resources, Depth.Image, Depth.Memory, Vk->DepthFormat, Vk->SwapchainExtent.width, Vk->SwapchainExtent.height, 1);
+        Vk->DepthImageView = VulkanAddView(&Vk->Resources, VulkanCreateImageView(Vk->Device, Depth.Image, Vk->DepthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1), Vk->DepthImage);
+    }
+    
+    // Vulkan: Framebuffers for the swapchain
+    {
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i)
+        {
+            VkImageView Attachments[] = {
+                VulkanGetView(&Vk->Resources, Vk->ColorImageView),
+                VulkanGetView(&Vk->Resources, Vk->DepthImageView),
+                Vk->SwapchainImageViews[i]
+            };
+            
+            VkFramebufferCreateInfo FramebufferCreateInfo = {};
+            FramebufferCreateInfo.sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            FramebufferCreateInfo.renderPass      = Vk->RenderPass;
+            FramebufferCreateInfo.attachmentCount = ArrayCount(Attachments);
+            FramebufferCreateInfo.pAttachments    = Attachments;
+            FramebufferCreateInfo.width           = Vk->SwapchainExtent.width;
+            FramebufferCreateInfo.height          = Vk->SwapchainExtent.height;
+            FramebufferCreateInfo.layers          = 1;
+            
+            if (vkCreateFramebuffer(Vk->Device, &FramebufferCreateInfo, VulkanAllocator, &Vk->SwapchainFramebuffers[i]) != VK_SUCCESS) {
+                ExitWithError("Swapchain framebuffer could not be created");
+            }
+        }
+    }
+    
+    // Vulkan: Uniform buffers
+    {
+        VkDeviceSize BufferSize = sizeof(uniform_buffer_object);
+        
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i)
+        {
+            vulkan_create_buffer_result Uniform = 
+                VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryTag_Uniforms);
+            Vk->UniformBuffers[i] = VulkanAddBuffer(&Vk->Resources, Uniform.Buffer, Uniform.Memory, BufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+        }
+    }
+    
+    // Vulkan: Object buffers (mapped for as long as they live, TransformBatch writes them directly)
+    {
+        VkDeviceSize BufferSize = Vk->Objects.Count * sizeof(object_transform);
+        
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i)
+        {
+            vulkan_create_buffer_result Objects = 
+                VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, BufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryTag_Uniforms);
+            Vk->ObjectBuffers[i] = VulkanAddBuffer(&Vk->Resources, Objects.Buffer, Objects.Memory, BufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+            
+            void *Mapped;
+            if (vkMapMemory(Vk->Device, Objects.Memory, 0, BufferSize, 0, &Mapped) != VK_SUCCESS) {
+                ExitWithError("Failed to map an object buffer");
+            }
+            Vk->ObjectTransforms[i] = (object_transform*)Mapped;
+        }
+    }
+    
+    // Vulkan: Draw buffers (mapped as well, the instance count and the visible objects are written
+    // every frame after culling)
+    {
+        VkDeviceSize       BufferSize = DRAW_BUFFER_VISIBLE_OFFSET + Vk->Objects.Count * sizeof(u32);
+        VkBufferUsageFlags Usage      = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i)
+        {
+            vulkan_create_buffer_result Draw = 
+                VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, BufferSize, Usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryTag_Uniforms);
+            Vk->DrawBuffers[i] = VulkanAddBuffer(&Vk->Resources, Draw.Buffer, Draw.Memory, BufferSize, Usage);
+            
+            void *Mapped;
+            if (vkMapMemory(Vk->Device, Draw.Memory, 0, BufferSize, 0, &Mapped) != VK_SUCCESS) {
+                ExitWithError("Failed to map a draw buffer");
+            }
+            Vk->DrawData[i] = (u8*)Mapped;
+            
+            // nothing drawn until the first frame has culled
+            VkDrawIndexedIndirectCommand Command = {};
+            Command.indexCount = ArrayCount(Indices);
+            memcpy(Vk->DrawData[i], &Command, sizeof(Command));
+        }
+    }
+    
+    // Vulkan: Descriptor pool / Descriptor set
+    {
+        // descriptor pool
+        VkDescriptorPoolSize DescriptorPoolSize[3] = {};
+        DescriptorPoolSize[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        DescriptorPoolSize[0].descriptorCount = Vk->SwapchainImageCount;
+        DescriptorPoolSize[1].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        DescriptorPoolSize[1].descriptorCount = Vk->SwapchainImageCount;
+        DescriptorPoolSize[2].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        DescriptorPoolSize[2].descriptorCount = 2 * Vk->SwapchainImageCount;
+        
+        VkDescriptorPoolCreateInfo DescriptorPoolCreateInfo = {};
+        DescriptorPoolCreateInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        DescriptorPoolCreateInfo.poolSizeCount = ArrayCount(DescriptorPoolSize);
+        DescriptorPoolCreateInfo.pPoolSizes    = DescriptorPoolSize;
+        DescriptorPoolCreateInfo.maxSets       = Vk->SwapchainImageCount;
+        
+        if (vkCreateDescriptorPool(Vk->Device, &DescriptorPoolCreateInfo, VulkanAllocator, &Vk->DescriptorPool) != VK_SUCCESS)
+        {
+            ExitWithError("Failed to create descriptor pool");
+        }
+        
+        // descriptor sets
+        VkDescriptorSetLayout DescriptorSetLayouts[MAX_SWAPCHAIN_IMAGES];
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i) {
+            DescriptorSetLayouts[i] = Vk->DescriptorSetLayout;
+        }
+        
+        VkDescriptorSetAllocateInfo DescriptorSetAllocInfo = {};
+        DescriptorSetAllocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        DescriptorSetAllocInfo.descriptorPool     = Vk->DescriptorPool;
+        DescriptorSetAllocInfo.descriptorSetCount = Vk->SwapchainImageCount;
+        DescriptorSetAllocInfo.pSetLayouts        = DescriptorSetLayouts;
+        
+        if (vkAllocateDescriptorSets(Vk->Device, &DescriptorSetAllocInfo, Vk->DescriptorSets) != VK_SUCCESS) {
+            ExitWithError("Failed to allocate descriptor sets");
+        }
+        
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i)
+        {
+            VkDescriptorBufferInfo BufferInfo = {};
+            BufferInfo.buffer = VulkanGetBuffer(&Vk->Resources, Vk->UniformBuffers[i]);
+            BufferInfo.offset = 0;
+            BufferInfo.range  = sizeof(uniform_buffer_object);
+            
+            VkDescriptorImageInfo ImageInfo = {};
+            ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            ImageInfo.imageView   = VulkanGetView(&Vk->Resources, Vk->TextureImageView);
+            ImageInfo.sampler     = VulkanGetSampler(&Vk->Resources, Vk->TextureSampler);
+            
+            VkDescriptorBufferInfo ObjectBufferInfo = {};
+            ObjectBufferInfo.buffer = VulkanGetBuffer(&Vk->Resources, Vk->ObjectBuffers[i]);
+            ObjectBufferInfo.offset = 0;
+            ObjectBufferInfo.range  = VK_WHOLE_SIZE;
+            
+            VkDescriptorBufferInfo VisibleBufferInfo = {};
+            VisibleBufferInfo.buffer = VulkanGetBuffer(&Vk->Resources, Vk->DrawBuffers[i]);
+            VisibleBufferInfo.offset = DRAW_BUFFER_VISIBLE_OFFSET;
+            VisibleBufferInfo.range  = VK_WHOLE_SIZE;
+            
+            VkWriteDescriptorSet DescriptorWrite[4] = {};
+            
+            DescriptorWrite[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrite[0].dstSet          = Vk->DescriptorSets[i];
+            DescriptorWrite[0].dstBinding      = 0;
+            DescriptorWrite[0].dstArrayElement = 0;
+            DescriptorWrite[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            DescriptorWrite[0].descriptorCount = 1;
+            DescriptorWrite[0].pBufferInfo     = &BufferInfo;
+            DescriptorWrite[0].pImageInfo      = NULL;
+            DescriptorWrite[0].pTexelBufferView= NULL;
+            
+            DescriptorWrite[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrite[1].dstSet          = Vk->DescriptorSets[i];
+            DescriptorWrite[1].dstBinding      = 1;
+            DescriptorWrite[1].dstArrayElement = 0;
+            DescriptorWrite[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            DescriptorWrite[1].descriptorCount = 1;
+            DescriptorWrite[1].pBufferInfo     = NULL;
+            DescriptorWrite[1].pImageInfo      = &ImageInfo;
+            DescriptorWrite[1].pTexelBufferView= NULL;
+            
+            DescriptorWrite[2].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrite[2].dstSet          = Vk->DescriptorSets[i];
+            DescriptorWrite[2].dstBinding      = 2;
+            DescriptorWrite[2].dstArrayElement = 0;
+            DescriptorWrite[2].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            DescriptorWrite[2].descriptorCount = 1;
+            DescriptorWrite[2].pBufferInfo     = &ObjectBufferInfo;
+            DescriptorWrite[2].pImageInfo      = NULL;
+            DescriptorWrite[2].pTexelBufferView= NULL;
+            
+            DescriptorWrite[3].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            DescriptorWrite[3].dstSet          = Vk->DescriptorSets[i];
+            DescriptorWrite[3].dstBinding      = 3;
+            DescriptorWrite[3].dstArrayElement = 0;
+            DescriptorWrite[3].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            DescriptorWrite[3].descriptorCount = 1;
+            DescriptorWrite[3].pBufferInfo     = &VisibleBufferInfo;
+            DescriptorWrite[3].pImageInfo      = NULL;
+            DescriptorWrite[3].pTexelBufferView= NULL;
+            
+            vkUpdateDescriptorSets(Vk->Device, ArrayCount(DescriptorWrite), DescriptorWrite, 0, NULL);
+        }
+    }
+    
+    // Vulkan: Command buffers
+    {
+        // command buffers
+        VkCommandBufferAllocateInfo CommandBufferAllocInfo = {};
+        CommandBufferAllocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        CommandBufferAllocInfo.commandPool        = Vk->CommandPool;
+        CommandBufferAllocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        CommandBufferAllocInfo.commandBufferCount = (uint32_t) Vk->SwapchainImageCount;
+        
+        if (vkAllocateCommandBuffers(Vk->Device, &CommandBufferAllocInfo, Vk->CommandBuffers) != VK_SUCCESS) {
+            ExitWithError("Command buffers could not be created");
+        }
+        
+        // start command buffer recording
+        for (u32 i = 0; i < Vk->SwapchainImageCount; ++i)
+        {
+            VkCommandBufferBeginInfo BeginInfo = {};
+            BeginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            BeginInfo.flags            = 0;
+            BeginInfo.pInheritanceInfo = NULL; // for secondary only
+            
+            if (vkBeginCommandBuffer(Vk->CommandBuffers[i], &BeginInfo) != VK_SUCCESS) {
+                ExitWithError("Failed to begin recording command buffer");
+            }
+            
+            VkClearValue ClearValues[] = {{0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 0}};
+            
+            // start render pass
+            VkRenderPassBeginInfo RenderPassInfo = {};
+            RenderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            RenderPassInfo.renderPass        = Vk->RenderPass;
+            RenderPassInfo.framebuffer       = Vk->SwapchainFramebuffers[i];
+            //RenderPassInfo.renderArea.offset  = {0, 0};
+            RenderPassInfo.renderArea.extent = Vk->SwapchainExtent;
+            RenderPassInfo.clearValueCount   = ArrayCount(ClearValues);
+            RenderPassInfo.pClearValues      = ClearValues;
+            
+            vkCmdBeginRenderPass(Vk->CommandBuffers[i], &RenderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+            
+            // bind pipeline
+            vkCmdBindPipeline(Vk->CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanGetPipeline(&Vk->Resources, Vk->GraphicsPipeline));
+            
+            // vertex buffer binding
+            VkBuffer VertexBuffers[] = { VulkanGetBuffer(&Vk->Resources, Vk->VertexBuffer) };
+            VkDeviceSize Offsets[] = {0};
+            vkCmdBindVertexBuffers(Vk->CommandBuffers[i], 0, ArrayCount(VertexBuffers), VertexBuffers, Offsets);
+            
+            vkCmdBindIndexBuffer(Vk->CommandBuffers[i], VulkanGetBuffer(&Vk->Resources, Vk->IndexBuffer), 0, VK_INDEX_TYPE_UINT16);
+            
+            // bind descriptor sets
+            vkCmdBindDescriptorSets(Vk->CommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, Vk->PipelineLayout, 0, 1, &Vk->DescriptorSets[i], 0, NULL);
+            
+            // draw, one instance per visible scene object (the count is written every frame)
+            vkCmdDrawIndexedIndirect(Vk->CommandBuffers[i], VulkanGetBuffer(&Vk->Resources, Vk->DrawBuffers[i]), 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+            
+            vkCmdEndRenderPass(Vk->CommandBuffers[i]);
+            
+            if (vkEndCommandBuffer(Vk->CommandBuffers[i]) != VK_SUCCESS) {
+                ExitWithError("Failed to record command buffer");
+            }
+        }
+    }
+}
+
+internal void VulkanCleanupSwapchain(vulkan_context* Vk)
+{
+    VulkanDestroyView(Vk->Device, &Vk->Resources, Vk->DepthImageView);
+    VulkanDestroyImage(Vk->Device, &Vk->Resources, Vk->DepthImage);
+    
+    VulkanDestroyView(Vk->Device, &Vk->Resources, Vk->ColorImageView);
+    VulkanDestroyImage(Vk->Device, &Vk->Resources, Vk->ColorImage);
+    
+    u32 Count = Vk->SwapchainImageCount;
+    
+    for (u32 i = 0; i < Count; ++i) {
+        vkDestroyFramebuffer(Vk->Device, Vk->SwapchainFramebuffers[i], VulkanAllocator);
+    }
+    
+    // we free the buffers, but reuse the command pool
+    vkFreeCommandBuffers(Vk->Device, Vk->CommandPool, Count, Vk->CommandBuffers);
+    
+    VulkanDestroyPipeline(Vk->Device, &Vk->Resources, Vk->GraphicsPipeline);
+    vkDestroyPipelineLayout(Vk->Device, Vk->PipelineLayout, VulkanAllocator);
+    vkDestroyRenderPass(Vk->Device, Vk->RenderPass, VulkanAllocator);
+    
+    for (u32 i = 0; i < Count; ++i) {
+        vkDestroyImageView(Vk->Device, Vk->SwapchainImageViews[i], VulkanAllocator);
+    }
+    
+    vkDestroySwapchainKHR(Vk->Device, Vk->Swapchain, VulkanAllocator);
+    
+    for (u32 i = 0; i < Count; ++i) {
+        VulkanDestroyBuffer(Vk->Device, &Vk->Resources, Vk->UniformBuffers[i]);
+        VulkanDestroyBuffer(Vk->Device, &Vk->Resources, Vk->ObjectBuffers[i]); // unmapped by the free
+        VulkanDestroyBuffer(Vk->Device, &Vk->Resources, Vk->DrawBuffers[i]);
+    }
+    
+    //vkFreeDescriptorSets(Vk->Device, Vk->DescriptorPool, Count, Vk->DescriptorSets);
+    
+    vkDestroyDescriptorPool(Vk->Device, Vk->DescriptorPool, VulkanAllocator);
+}
+
+internal void VulkanInit(vulkan_context *Vk, i32 Width, i32 Height, u32 ObjectCount)
+{
+    scratch_block Scratch;
+    arena*        Arena = &Scratch.Arena;
+    
+    Vk->WindowExtent.width  = Width;
+    Vk->WindowExtent.height = Height;
+    
+    VulkanHostAllocatorInit();
+    VulkanResourcesInit(&Vk->Resources);
+    
+    // Asset reads: served from assets.pak if there is one, loose files are queued up front so they
+    // load in parallel while the instance and the device are being created, they are waited for
+    // right before they are needed
+    scratch_block AssetScratch(MB(32));
+    
+    pak AssetPak;
+    if (PakOpen(&AssetPak, "assets.pak")) {
+        LOG("Assets: assets.pak, %u entries", AssetPak.EntryCount);
+    }
+    
+    async_read VertexShaderRead   = {"vertex_shader.spv"};
+    async_read FragmentShaderRead = {"fragment_shader.spv"};
+    async_read TextureRead        = {"texture.jpg"};
+    
+    async_read* AssetReads[] = { &VertexShaderRead, &FragmentShaderRead, &TextureRead };
+    for (u32 i = 0; i < ArrayCount(AssetReads); ++i)
+    {
+        if (!VulkanRequestAsset(&AssetPak, AssetReads[i], AssetScratch)) {
+            ExitWithError("Failed to open an asset file");
+        }
+    }
+    AsyncIOFlush();
+    
+    // The texture is decoded by a worker meanwhile, into memory of its own that is reset once the
+    // pixels are in the staging buffer
+    scratch_block TextureDecodeScratch(TEXTURE_DECODE_MEMORY);
+    
+    vulkan_texture_decode TextureDecode = {};
+    TextureDecode.Read  = &TextureRead;
+    TextureDecode.Arena = TextureDecodeScratch;
+    
+    job_counter TextureDecodeCounter = {};
+    JobRun(VulkanDecodeTextureJob, &TextureDecode, &TextureDecodeCounter);
+    
+    const char* RequiredInstanceExtensions[] = { PLATFORM_VULKAN_SURFACE_EXTENSION_NAME, VK_KHR_SURFACE_EXTENSION_NAME };
+    const char* RequiredDeviceExtensions[]   = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+#if defined(USE_VALIDATION_LAYERS)
+    const char* RequiredValidationLayers[]   = { "VK_LAYER_KHRONOS_validation" };
+#endif
+    
+    VkResult Res;
+    
+    // Vulkan: Retrieving all instance extensions
+    {
+        uint32_t InstanceExtensionCount;
+        vkEnumerateInstanceExtensionProperties(NULL, &InstanceExtensionCount, NULL);
+        LOG("Extension count: %u", InstanceExtensionCount);
+        
+        VkExtensionProperties* InstanceExtensions = PushArray(Arena, VkExtensionProperties, InstanceExtensionCount);
+        vkEnumerateInstanceExtensionProperties(NULL, &InstanceExtensionCount, InstanceExtensions);
+        
+        for (u32 i = 0; i < ArrayCount(RequiredInstanceExtensions); ++i)
+        {
+            b32 ExtensionFound = false;
+            
+            for (u32 j = 0; j < InstanceExtensionCount && !ExtensionFound; ++j)
+            {
+                if (StringsAreEqual(RequiredInstanceExtensions[ i ], InstanceExtensions[ j ].extensionName))
+                {
+                    ExtensionFound = true;
+                    break;
+                }
+            }
+            
+            if (!ExtensionFound)
+            {
+                ExitWithError("Could not find the instance extension");
+            }
+        }
+    }
+    
+#if defined(USE_VALIDATION_LAYERS)
+    // Vulkan: Check validation layers
+    {
+        uint32_t InstanceLayerCount;
+        vkEnumerateInstanceLayerProperties(&InstanceLayerCount, NULL);
+        VkLayerProperties* InstanceLayers = PushArray(Arena, VkLayerProperties, InstanceLayerCount);
+        vkEnumerateInstanceLayerProperties(&InstanceLayerCount, InstanceLayers);
+        
+        for (u32 i = 0; i < ArrayCount(RequiredValidationLayers); ++i)
+        {
+            b32 LayerFound = false;
+            
+            for (u32 j = 0; j < InstanceLayerCount; ++j)
+            {
+                if (StringsAreEqual(RequiredValidationLayers[ i ], InstanceLayers[ j ].layerName))
+                {
+                    LayerFound = true;
+                    break;
+                }
+            }
+            
+            if (!LayerFound)
+            {
+                ExitWithError("Could not find the validation layer");
+            }
+        }
+    }
+#endif
+    
+    // Vulkan: instance creation
+    {
+        VkApplicationInfo AppInfo  = {};
+        AppInfo.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        AppInfo.pApplicationName   = "Vulkan app";
+        AppInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+        AppInfo.pEngineName        = "No engine";
+        AppInfo.engineVersion      = VK_MAKE_VERSION(1, 0, 0);
+        AppInfo.apiVersion         = VK_API_VERSION_1_0;
+        
+        VkInstanceCreateInfo CreateInfo = {};
+        CreateInfo.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        CreateInfo.pApplicationInfo        = &AppInfo;
+        CreateInfo.enabledExtensionCount   = ArrayCount(RequiredInstanceExtensions);
+        CreateInfo.ppEnabledExtensionNames = RequiredInstanceExtensions;
+#if defined(USE_VALIDATION_LAYERS)
+        CreateInfo.enabledLayerCount       = ArrayCount(RequiredValidationLayers);
+        CreateInfo.ppEnabledLayerNames     = RequiredValidationLayers;
+#else
+        CreateInfo.enabledLayerCount       = 0;
+#endif
+        
+        if ( vkCreateInstance(&CreateInfo, VulkanAllocator, &Vk->Instance) != VK_SUCCESS ) {
+            ExitWithError("Failed to create Vulkan instance");
+        }
+    }
+    
+    // Vulkan: Setup debug messenger
+    
+    // TODO(jdiaz)
+    
+    // Vulkan: Window surface
+    {
+        if (PlatformCreateVulkanSurface(Vk->Instance, VulkanAllocator, &Vk->Surface) != VK_SUCCESS) {
+            ExitWithError("Failed to create a Vulkan surface");
+        }
+    }
+    
+    // Vulkan: Pick physical device
+    {
+        uint32_t         PhysicalDeviceCount = 64;
+        VkPhysicalDevice PhysicalDevices[ 64 ];
+        Res = vkEnumeratePhysicalDevices(Vk->Instance, &PhysicalDeviceCount, PhysicalDevices);
+        Assert(Res == VK_SUCCESS);
+        
+        u32 BestScore = 0;
+        for (u32 i = 0; i < PhysicalDeviceCount; ++i)
+        {
+            VkPhysicalDevice CurrPhysicalDevice = PhysicalDevices[ i ];
+            
+            // Check queues support
+            
+            uint32_t PhysicalDeviceQueueFamilyCount = 16;
+            VkQueueFamilyProperties PhysicalDeviceQueueFamilies[ 16 ];
+            vkGetPhysicalDeviceQueueFamilyProperties(CurrPhysicalDevice, &PhysicalDeviceQueueFamilyCount, PhysicalDeviceQueueFamilies);
+            Assert(PhysicalDeviceQueueFamilyCount < 16); // 16 is more than enough, this "less than" is not an error
+            
+            u32 GraphicsQueueIdx = INVALID_INDEX;
+            u32 PresentQueueIdx  = INVALID_INDEX;
+            for (u32 j = 0; j < PhysicalDeviceQueueFamilyCount; ++j)
+            {
+                if (PhysicalDeviceQueueFamilies[ j ].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+                    GraphicsQueueIdx = j;
+                
+                VkBool32 PresentSupport = false;
+                vkGetPhysicalDeviceSurfaceSupportKHR(CurrPhysicalDevice, j, Vk->Surface, &PresentSupport);
+                if (PresentSupport)
+                    PresentQueueIdx = j;
+            }
+            
+            if (GraphicsQueueIdx == INVALID_INDEX || PresentQueueIdx == INVALID_INDEX)
+                continue;
+            
+            
+            // Check extensions support
+            
+            uint32_t DeviceExtensionsCount = 256;
+            VkExtensionProperties DeviceExtensions[ 256 ];
+            vkEnumerateDeviceExtensionProperties(CurrPhysicalDevice, NULL, &DeviceExtensionsCount, NULL);
+            Res = vkEnumerateDeviceExtensionProperties(CurrPhysicalDevice, NULL, &DeviceExtensionsCount, DeviceExtensions);
+            Assert(Res == VK_SUCCESS);
+            
+            b32 AllRequiredExtensionsFound = true;
+            for (u32 req_idx = 0; req_idx < ArrayCount(RequiredDeviceExtensions); ++req_idx)
+            {
+                b32 RequiredExtensionFound = false;
+                for (u32 ext_idx = 0; ext_idx < DeviceExtensionsCount; ++ext_idx)
+                {
+                    if (StringsAreEqual(RequiredDeviceExtensions[req_idx], DeviceExtensions[ext_idx].extensionName))
+                    {
+                        RequiredExtensionFound = true;
+                        break;
+                    }
+                }
+                if (!RequiredExtensionFound)
+                {
+                    AllRequiredExtensionsFound = false;
+                    break;
+                }
+                
+            }
+            if (!AllRequiredExtensionsFound)
+                continue;
+            
+            
+            // Check swapchain support
+            
+            uint32_t FormatCount;
+            vkGetPhysicalDeviceSurfaceFormatsKHR(CurrPhysicalDevice, Vk->Surface, &FormatCount, NULL);
+            
+            uint32_t PresentModesCount;
+            vkGetPhysicalDeviceSurfacePresentModesKHR(CurrPhysicalDevice, Vk->Surface, &PresentModesCount, NULL);
+            
+            b32 IsValidSwapChain = FormatCount != 0 && PresentModesCount != 0;
+            if (!IsValidSwapChain)
+                continue;
+            
+            // Check depth buffer availability
+            
+            VkImageTiling        Tiling         = VK_IMAGE_TILING_OPTIMAL; // or LINEAR
+            VkFormatFeatureFlags Features       = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            VkFormat             DepthFormats[] = {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT};
+            
+            b32 AvailableDepthFormatFound = false;
+            VkFormat DepthFormat;
+            for (u32 j = 0; j < ArrayCount(DepthFormats); ++j)
+            {
+                VkFormatProperties Props;
+                vkGetPhysicalDeviceFormatProperties(CurrPhysicalDevice, DepthFormats[j], &Props);
+                
+                if (Tiling == VK_IMAGE_TILING_LINEAR && (Props.linearTilingFeatures & Features) == Features)
+                {
+                    DepthFormat = DepthFormats[j];
+                    AvailableDepthFormatFound = true;
+                }
+                else if (Tiling == VK_IMAGE_TILING_OPTIMAL && (Props.optimalTilingFeatures & Features) == Features)
+                {
+                    DepthFormat = DepthFormats[j];
+                    AvailableDepthFormatFound = true;
+                }
+            }
+            
+            if (!AvailableDepthFormatFound)
+                continue;
+            
+            b32 DepthHasStencil = (DepthFormat == VK_FORMAT_D24_UNORM_S8_UINT || DepthFormat == VK_FORMAT_D32_SFLOAT_S8_UINT);
+            
+            
+            
+            // Check device properties
+            
+            u32 Score = 0;
+            
+            VkPhysicalDeviceProperties DeviceProperties;
+            vkGetPhysicalDeviceProperties(CurrPhysicalDevice, &DeviceProperties);
+            
+            if (DeviceProperties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+                Score += 1000;
+            
+            Score += DeviceProperties.limits.maxImageDimension2D;
+            
+            VkSampleCountFlagBits SampleCountFlag;
+            VkSampleCountFlags    SampleCountFlags = DeviceProperties.limits.framebufferColorSampleCounts & DeviceProperties.limits.framebufferDepthSampleCounts;
+            if      (SampleCountFlags & VK_SAMPLE_COUNT_64_BIT) SampleCountFlag = VK_SAMPLE_COUNT_64_BIT;
+            else if (SampleCountFlags & VK_SAMPLE_COUNT_32_BIT) SampleCountFlag = VK_SAMPLE_COUNT_32_BIT;
+            else if (SampleCountFlags & VK_SAMPLE_COUNT_16_BIT) SampleCountFlag = VK_SAMPLE_COUNT_16_BIT;
+            else if (SampleCountFlags & VK_SAMPLE_COUNT_8_BIT)  SampleCountFlag = VK_SAMPLE_COUNT_8_BIT;
+            else if (SampleCountFlags & VK_SAMPLE_COUNT_4_BIT)  SampleCountFlag = VK_SAMPLE_COUNT_4_BIT;
+            else if (SampleCountFlags & VK_SAMPLE_COUNT_2_BIT)  SampleCountFlag = VK_SAMPLE_COUNT_2_BIT;
+            else                                                SampleCountFlag = VK_SAMPLE_COUNT_1_BIT;
+            
+            
+            // Check device features
+            
+            VkPhysicalDeviceFeatures DeviceFeatures;
+            vkGetPhysicalDeviceFeatures(CurrPhysicalDevice, &DeviceFeatures);
+            
+            // NOTE(jdiaz): No geometry shaders are used, and software drivers (SwiftShader) lack them
+            if (!DeviceFeatures.samplerAnisotropy) Score = 0;
+            
+            
+            // Get the most suitable device found so far
+            if (Score > BestScore)
+            {
+                BestScore = Score;
+                Vk->PhysicalDevice      = CurrPhysicalDevice;
+                Vk->GraphicsQueueFamily = GraphicsQueueIdx;
+                Vk->PresentQueueFamily  = PresentQueueIdx;
+                Vk->MSAASampleCount     = SampleCountFlag;
+                Vk->DepthFormat         = DepthFormat;
+                Vk->DepthHasStencil     = DepthHasStencil;
+            }
+        }
+        
+        if (BestScore == 0) {
+            ExitWithError("Failed to find a proper Vulkan physical device");
+        }
+        
+        VulkanDeviceMemoryInit(Vk->PhysicalDevice);
+    }
+    
+    // Vulkan: Logical device
+    {
+        f32 QueuePriorities[] = { 1.0f };
+        
+        uint32_t QueueIndices[] = { Vk->GraphicsQueueFamily, Vk->PresentQueueFamily };
+        
+        // queue families must be unique (software drivers expose a single family)
+        u32 QueueCreateInfoCount = (Vk->GraphicsQueueFamily == Vk->PresentQueueFamily) ? 1 : 2;
+        
+        VkDeviceQueueCreateInfo QueueCreateInfos[ ArrayCount(QueueIndices) ] = {};
+        for (u32 i = 0; i < QueueCreateInfoCount; ++i)
+        {
+            QueueCreateInfos[ i ].sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            QueueCreateInfos[ i ].queueFamilyIndex = QueueIndices[ i ];
+            QueueCreateInfos[ i ].queueCount       = 1;
+            QueueCreateInfos[ i ].pQueuePriorities = QueuePriorities;
+        }
+        
+        VkPhysicalDeviceFeatures DeviceFeatures = {};
+        DeviceFeatures.samplerAnisotropy = VK_TRUE;
+        //DeviceFeatures.sampleRateShading = VK_TRUE; // MSAA also applied to shading (more costly)
+        // TODO(jdiaz): Fill this structure when we know the features we need
+        
+        VkDeviceCreateInfo DeviceCreateInfo = {};
+        DeviceCreateInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        DeviceCreateInfo.pQueueCreateInfos       = QueueCreateInfos;
+        DeviceCreateInfo.queueCreateInfoCount    = QueueCreateInfoCount;
+        DeviceCreateInfo.pEnabledFeatures        = &DeviceFeatures;
+        DeviceCreateInfo.enabledExtensionCount   = ArrayCount(RequiredDeviceExtensions);
+        DeviceCreateInfo.ppEnabledExtensionNames = RequiredDeviceExtensions;
+#if defined(USE_VALIDATION_LAYERS)
+        DeviceCreateInfo.enabledLayerCount       = ArrayCount(RequiredValidationLayers); // Deprecated
+        DeviceCreateInfo.ppEnabledLayerNames     = RequiredValidationLayers;             // Deprecated
+#else
+        DeviceCreateInfo.enabledLayerCount       = 0;
+#endif
+        
+        if (vkCreateDevice(Vk->PhysicalDevice, &DeviceCreateInfo, VulkanAllocator, &Vk->Device) != VK_SUCCESS) {
+            ExitWithError("Failed to create Vulkan logical device");
+        }
+        
+        vkGetDeviceQueue(Vk->Device, Vk->GraphicsQueueFamily, 0, &Vk->GraphicsQueue);
+        
+        vkGetDeviceQueue(Vk->Device, Vk->PresentQueueFamily,  0, &Vk->PresentQueue);
+    }
+    
+    // Vulkan: Shader modules
+    {
+        // NOTE(jdiaz): The read buffers are 16 byte aligned, so the SPIR-V is consumed in place
+        AsyncIOWaitFor(&VertexShaderRead);
+        AsyncIOWaitFor(&FragmentShaderRead);
+        if (!VertexShaderRead.Succeeded || !FragmentShaderRead.Succeeded) {
+            ExitWithError("Failed to load the shaders");
+        }
+        
+        Vk->VertexShaderModule   = VulkanCreateShaderModule(Vk->Device, VertexShaderRead.Bytes, VertexShaderRead.ByteCount);
+        Vk->FragmentShaderModule = VulkanCreateShaderModule(Vk->Device, FragmentShaderRead.Bytes, FragmentShaderRead.ByteCount);
+    }
+    
+    // Vulkan: Command pool
+    {
+        // command pool
+        VkCommandPoolCreateInfo CmdPoolCreateInfo = {};
+        CmdPoolCreateInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        CmdPoolCreateInfo.queueFamilyIndex = Vk->GraphicsQueueFamily;
+        CmdPoolCreateInfo.flags            = 0; // flags to indicate the frequency of change of commands
+        
+        if (vkCreateCommandPool(Vk->Device, &CmdPoolCreateInfo, VulkanAllocator, &Vk->CommandPool) != VK_SUCCESS) {
+            ExitWithError("Command pool could not be created");
+        }
+    }
+    
+    // Vulkan: Texture image
+    {
+        // read image (decoded straight from the read buffer by VulkanDecodeTextureJob)
+        JobWait(&TextureDecodeCounter);
+        if (!TextureRead.Succeeded) {
+            ExitWithError("Failed to load texture.jpg");
+        }
+        
+        stbi_uc* Pixels = TextureDecode.Pixels;
+        int TexWidth    = TextureDecode.Width;
+        int TexHeight   = TextureDecode.Height;
+        if (!Pixels) {
+            ExitWithError("Failed to decode texture.jpg");
+        }
+        
+        u32 MipLevels = (uint32_t)Floor(Log2(Max(TexWidth, TexHeight))) + 1u;
+        
+        // staging buffer
+        VkDeviceSize ImageSize = TexWidth * TexHeight * 4;
+        vulkan_create_buffer_result Staging = 
+            VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, ImageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryTag_Staging);
+        
+        void* Data;
+        vkMapMemory(Vk->Device, Staging.Memory, 0, ImageSize, 0, &Data);
+        memcpy(Data, Pixels, ImageSize);
+        vkUnmapMemory(Vk->Device, Staging.Memory);
+        
+        ClearArena(TextureDecodeScratch);
+        MemoryTrackFree(MemoryTag_ImageDecode, TextureDecode.MemoryUsed);
+        
+        vulkan_create_image_result Res = VulkanCreateImage(Vk->PhysicalDevice, Vk->Device,
+                                                           TexWidth, TexHeight, MipLevels,
+                                                           VK_SAMPLE_COUNT_1_BIT,
+                                                           VK_FORMAT_R8G8B8A8_SRGB,
+                                                           VK_IMAGE_TILING_OPTIMAL,
+                                                           VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                                           MemoryTag_Textures);
+        Vk->TextureImage = VulkanAddImage(&Vk->Resources, Res.Image, Res.Memory, VK_FORMAT_R8G8B8A8_SRGB, TexWidth, TexHeight, MipLevels);
+        
+        VulkanTransitionImageLayout(Vk, Res.Image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, MipLevels);
+        VulkanCopyBufferToImage(Vk, Staging.Buffer, Res.Image, TexWidth, TexHeight);
+        
+        // OLD: Transitions all mip levels in the image to read_only_optimal
+        //VulkanTransitionImageLayout(VulkanTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VulkanMipLevels);
+        
+        // NEW: Generate all mipmap levels one by one, making layout transitions more granular
+        VulkanGenerateMipmaps(Vk, Res.Image, VK_FORMAT_R8G8B8A8_SRGB,  TexWidth, TexHeight, MipLevels);
+        
+        vkDestroyBuffer(Vk->Device, Staging.Buffer, VulkanAllocator);
+        VulkanFreeMemory(Vk->Device, Staging.Memory);
+    }
+    
+    // Vulkan: Texture image view
+    {
+        u32 MipLevels = VulkanGetImageMipLevels(&Vk->Resources, Vk->TextureImage);
+        VkImageView View = VulkanCreateImageView(Vk->Device, VulkanGetImage(&Vk->Resources, Vk->TextureImage), VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, MipLevels);
+        Vk->TextureImageView = VulkanAddView(&Vk->Resources, View, Vk->TextureImage);
+    }
+    
+    // Vulkan: Texture sampler
+    {
+        VkSamplerCreateInfo SamplerCreateInfo = {};
+        SamplerCreateInfo.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        SamplerCreateInfo.magFilter               = VK_FILTER_LINEAR;
+        SamplerCreateInfo.minFilter               = VK_FILTER_LINEAR;
+        SamplerCreateInfo.addressModeU            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        SamplerCreateInfo.addressModeV            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        SamplerCreateInfo.addressModeW            = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        SamplerCreateInfo.anisotropyEnable        = VK_TRUE;
+        SamplerCreateInfo.maxAnisotropy           = 16.0f;
+        SamplerCreateInfo.borderColor             = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        SamplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+        SamplerCreateInfo.compareEnable           = VK_FALSE;             // PCF for shadow maps
+        SamplerCreateInfo.compareOp               = VK_COMPARE_OP_ALWAYS; // PCF for shadow maps
+        SamplerCreateInfo.mipmapMode              = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        SamplerCreateInfo.mipLodBias              = 0.0f;
+        SamplerCreateInfo.minLod                  = 0.0f;
+        SamplerCreateInfo.maxLod                  = (f32)VulkanGetImageMipLevels(&Vk->Resources, Vk->TextureImage);
+        
+        VkSampler Sampler;
+        if (vkCreateSampler(Vk->Device, &SamplerCreateInfo, VulkanAllocator, &Sampler) != VK_SUCCESS) {
+            ExitWithError("Failed to create texture sampler");
+        }
+        Vk->TextureSampler = VulkanAddSampler(&Vk->Resources, Sampler);
+    }
+    
+    // Vulkan: Vertex buffer
+    {
+        scratch_block VertexScratch;
+        packed_vertex *PackedVertices = PushArray(VertexScratch, packed_vertex, ArrayCount(Vertices));
+        PackVertices(PackedVertices, Vertices, ArrayCount(Vertices), VertexScratch);
+        
+        VkDeviceSize BufferSize = ArrayCount(Vertices) * sizeof(packed_vertex);
+        
+        // temporary staging buffer
+        vulkan_create_buffer_result Staging =
+            VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryTag_Staging);
+        
+        // copy vertices into memory
+        void *Data;
+        vkMapMemory(Vk->Device, Staging.Memory, 0, BufferSize, 0, &Data);
+        memcpy(Data, PackedVertices, BufferSize);
+        vkUnmapMemory(Vk->Device, Staging.Memory);
+        
+        vulkan_create_buffer_result Vertex =
+            VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryTag_Meshes);
+        Vk->VertexBuffer = VulkanAddBuffer(&Vk->Resources, Vertex.Buffer, Vertex.Memory, BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        
+        VulkanCopyBuffer(Vk, Staging.Buffer, Vertex.Buffer, BufferSize);
+        
+        vkDestroyBuffer(Vk->Device, Staging.Buffer, VulkanAllocator);
+        VulkanFreeMemory(Vk->Device, Staging.Memory);
+    }
+    
+    // Vulkan: Index buffer
+    {
+        VkDeviceSize BufferSize = sizeof(Indices);
+        
+        // temporary staging buffer
+        vulkan_create_buffer_result Staging =
+            VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, MemoryTag_Staging);
+        
+        // copy indices into memory
+        void *Data;
+        vkMapMemory(Vk->Device, Staging.Memory, 0, BufferSize, 0, &Data);
+        memcpy(Data, Indices, BufferSize);
+        vkUnmapMemory(Vk->Device, Staging.Memory);
+        
+        vulkan_create_buffer_result Index =
+            VulkanCreateBuffer(Vk->PhysicalDevice, Vk->Device, BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, MemoryTag_Meshes);
+        Vk->IndexBuffer = VulkanAddBuffer(&Vk->Resources, Index.Buffer, Index.Memory, BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        
+        VulkanCopyBuffer(Vk, Staging.Buffer, Index.Buffer, BufferSize);
+        
+        vkDestroyBuffer(Vk->Device, Staging.Buffer, VulkanAllocator);
+        VulkanFreeMemory(Vk->Device, Staging.Memory);
+    }
+    
+    // Vulkan: Descriptor set layout
+    {
+        VkDescriptorSetLayoutBinding UboLayoutBinding = {};
+        UboLayoutBinding.binding            = 0;
+        UboLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        UboLayoutBinding.descriptorCount    = 1; // more than 1 if it is an array
+        UboLayoutBinding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
+        UboLayoutBinding.pImmutableSamplers = NULL;
+        
+        VkDescriptorSetLayoutBinding SamplerLayoutBinding = {};
+        SamplerLayoutBinding.binding            = 1;
+        SamplerLayoutBinding.descriptorCount    = 1; // more than 1 if it is an array
+        SamplerLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        SamplerLayoutBinding.pImmutableSamplers = NULL;
+        SamplerLayoutBinding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
+        
+        VkDescriptorSetLayoutBinding ObjectsLayoutBinding = {};
+        ObjectsLayoutBinding.binding            = 2;
+        ObjectsLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        ObjectsLayoutBinding.descriptorCount    = 1;
+        ObjectsLayoutBinding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
+        ObjectsLayoutBinding.pImmutableSamplers = NULL;
+        
+        VkDescriptorSetLayoutBinding VisibleLayoutBinding = ObjectsLayoutBinding;
+        VisibleLayoutBinding.binding            = 3;
+        
+        VkDescriptorSetLayoutBinding Bindings[] = {UboLayoutBinding, SamplerLayoutBinding, ObjectsLayoutBinding, VisibleLayoutBinding};
+        
+        VkDescriptorSetLayoutCreateInfo DescriptorSetLayoutCreateInfo = {};
+        DescriptorSetLayoutCreateInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        DescriptorSetLayoutCreateInfo.bindingCount = ArrayCount(Bindings);
+        DescriptorSetLayoutCreateInfo.pBindings    = Bindings;
+        
+        if (vkCreateDescriptorSetLayout(Vk->Device, &DescriptorSetLayoutCreateInfo, VulkanAllocator, &Vk->DescriptorSetLayout) != VK_SUCCESS) {
+            ExitWithError("Failed to create descriptor set layout");
+        }
+    }
+    
+    // Vulkan: Semaphore creation
+    {
+        VkSemaphoreCreateInfo SemaphoreCreateInfo = {};
+        SemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        
+        VkFenceCreateInfo FenceCreateInfo = {};
+        FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        FenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        
+        for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        {
+            if (vkCreateSemaphore(Vk->Device, &SemaphoreCreateInfo, VulkanAllocator, &Vk->ImageAvailableSemaphore[i]) != VK_SUCCESS
+                || vkCreateSemaphore(Vk->Device, &SemaphoreCreateInfo, VulkanAllocator, &Vk->RenderFinishedSemaphore[i]) != VK_SUCCESS
+                || vkCreateFence(Vk->Device, &FenceCreateInfo, VulkanAllocator, &Vk->InFlightFences[i]) != VK_SUCCESS) {
+                ExitWithError("Failed to create semaphores");
+            }
+        }
+        
+        for (u32 i = 0; i < MAX_SWAPCHAIN_IMAGES; ++i)
+        {
+            Vk->InFlightImages[i] = VK_NULL_HANDLE;
+        }
+    }
+    
+    // Scene: ObjectCount quads on a grid in the XY plane, a single one at the origin. Every
+    // TRANSFORM_GROUP_OBJECTS of them are under a group node placed at the first one, the groups are
+    // under the scene root.
+    {
+        ObjectCount = Max(1u, Min(ObjectCount, (u32)MAX_SCENE_OBJECTS));
+        u32 GroupCount = (ObjectCount + TRANSFORM_GROUP_OBJECTS - 1) / TRANSFORM_GROUP_OBJECTS;
+        
+        Vk->SceneMemory = MakeGrowingArena(MB(1), MemoryTag_Scene);
+        TransformSoAInit(&Vk->Objects, &Vk->SceneMemory, ObjectCount);
+        TransformHierarchyInit(&Vk->SceneHierarchy, &Vk->SceneMemory, 1 + GroupCount);
+        u32 Root = TransformHierarchyAdd(&Vk->SceneHierarchy, TRANSFORM_HIERARCHY_ROOT, Identity());
+        
+        u32 Side    = 1;
+        while (Side * Side < ObjectCount) {
+            ++Side;
+        }
+        f32 Spacing = 3.0f / Side;
+        f32 Scale   = Min(1.0f, 0.8f * Spacing);
+        
+        // bounds of the spheres around the object origins, they do not change as the objects spin
+        scratch_block BoundsScratch(MB(1) + ObjectCount * (sizeof(aabb) + sizeof(vec3) + sizeof(bvh_node)));
+        aabb *Bounds = PushArray(BoundsScratch, aabb, ObjectCount);
+        f32   Radius = Scale * 0.8661f; // the vertices are within a half unit cube
+        
+        vec3 GroupPosition = {};
+        for (u32 i = 0; i < ObjectCount; ++i)
+        {
+            vec3 Position = V3(((i % Side) + 0.5f) * Spacing - 1.5f, ((i / Side) + 0.5f) * Spacing - 1.5f, 0.0f);
+            if (i % TRANSFORM_GROUP_OBJECTS == 0)
+            {
+                GroupPosition = Position;
+                TransformHierarchyAdd(&Vk->SceneHierarchy, Root, Translation(GroupPosition));
+            }
+            TransformAdd(&Vk->Objects, Position - GroupPosition, V4(0.0f, 0.0f, 0.0f, 1.0f), V3(Scale));
+            
+            Bounds[i].Min = Position - V3(Radius);
+            Bounds[i].Max = Position + V3(Radius);
+        }
+        
+        BvhInit(&Vk->ObjectBvh, &Vk->SceneMemory, ObjectCount);
+        BvhBuild(&Vk->ObjectBvh, Bounds, ObjectCount, BoundsScratch);
+        LOG("Scene: %u objects in %u groups, %u BVH nodes", ObjectCount, GroupCount, Vk->ObjectBvh.NodeCount);
+    }
+    
+    VulkanCreateSwapchain(Vk);
+    
+    PakClose(&AssetPak);
+    
+    VulkanHostMemoryReport("init");
+}
+
+internal void VulkanCleanup(vulkan_context* Vk)
+{
+    // wait the logical device to finish operations
+    vkDeviceWaitIdle(Vk->Device);
+    
+    VulkanCleanupSwapchain(Vk);
+    
+    for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        vkDestroySemaphore(Vk->Device, Vk->RenderFinishedSemaphore[i], VulkanAllocator);
+        vkDestroySemaphore(Vk->Device, Vk->ImageAvailableSemaphore[i], VulkanAllocator);
+        vkDestroyFence(Vk->Device, Vk->InFlightFences[i], VulkanAllocator);
+    }
+    
+    VulkanDestroySampler(Vk->Device, &Vk->Resources, Vk->TextureSampler);
+    VulkanDestroyView(Vk->Device, &Vk->Resources, Vk->TextureImageView);
+    VulkanDestroyImage(Vk->Device, &Vk->Resources, Vk->TextureImage);
+    
+    vkDestroyDescriptorSetLayout(Vk->Device, Vk->DescriptorSetLayout, VulkanAllocator);
+    
+    vkDestroyShaderModule(Vk->Device, Vk->FragmentShaderModule, VulkanAllocator);
+    vkDestroyShaderModule(Vk->Device, Vk->VertexShaderModule, VulkanAllocator);
+    
+    VulkanDestroyBuffer(Vk->Device, &Vk->Resources, Vk->VertexBuffer);
+    VulkanDestroyBuffer(Vk->Device, &Vk->Resources, Vk->IndexBuffer);
+    
+    vkDestroyCommandPool(Vk->Device, Vk->CommandPool, VulkanAllocator);
+    
+    vkDestroyDevice(Vk->Device, VulkanAllocator);
+    vkDestroySurfaceKHR(Vk->Instance, Vk->Surface, VulkanAllocator);
+    vkDestroyInstance(Vk->Instance, VulkanAllocator);
+    
+    ClearArena(&Vk->SceneMemory);
+    
+    VulkanResourcesShutdown(&Vk->Resources);
+    VulkanHostAllocatorShutdown();
+}
+
+internal void VulkanDrawFrame(vulkan_context *Vk, frame_timing *Timing, b32 WindowResized)
+{
+    u32 CurrentFrame = Vk->CurrentFrame;
+    
+    // Wait for this frame fence
+    vkWaitForFences(Vk->Device, 1, &Vk->InFlightFences[CurrentFrame], VK_TRUE, UINT64_MAX);
+    
+    FrameTimingEndPhase(Timing, FramePhase_FenceWait);
+    
+    // aquire an image from the swapchain
+    uint32_t ImageIndex;
+    VkResult Res = vkAcquireNextImageKHR(Vk->Device, Vk->Swapchain, UINT64_MAX, Vk->ImageAvailableSemaphore[CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
+    
+    // check if the swapchain needs to be recreated
+    if (Res == VK_ERROR_OUT_OF_DATE_KHR)
+    {
+        vkDeviceWaitIdle(Vk->Device);
+        VulkanCleanupSwapchain(Vk);
+        VulkanCreateSwapchain(Vk);
+        VulkanHostMemoryReport("swapchain recreated");
+    }
+    else if (Res != VK_SUCCESS && Res != VK_SUBOPTIMAL_KHR)
+    {
+        ExitWithError("Failed to acquire swapchain image");
+    }
+    
+    // this is just in case the image returned by vkAquireNextImage is not consecutive
+    if (Vk->InFlightImages[ImageIndex] != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(Vk->Device, 1, &Vk->InFlightImages[ImageIndex], VK_TRUE, UINT64_MAX);
+    }
+    Vk->InFlightImages[ImageIndex] = Vk->InFlightFences[CurrentFrame];
+    
+    vkResetFences(Vk->Device, 1, &Vk->InFlightFences[CurrentFrame]);
+    
+    FrameTimingEndPhase(Timing, FramePhase_Acquire);
+    
+    // update uniform buffer and object transforms (the objects spin at a fixed rate regardless of
+    // the frame rate)
+    local_persist f32 Angle = 0.0f;
+    Angle += 30.0f * Timing->DeltaSeconds; // degrees per second
+    if (Angle >= 360.0f) Angle -= 360.0f;
+    uniform_buffer_object UBO = {};
+    UBO.viewProj = Vk->ViewProj;
+    
+    vec4 Spin = Quaternion(Radians(Angle), V3(0.0, 0.0, 1.0));
+    for (u32 i = 0; i < Vk->Objects.Count; ++i)
+    {
+        Vk->Objects.RotationX[i] = Spin.x;
+        Vk->Objects.RotationY[i] = Spin.y;
+        Vk->Objects.RotationZ[i] = Spin.z;
+        Vk->Objects.RotationW[i] = Spin.w;
+    }
+    
+    // NOTE(jdiaz): Only the group nodes that were moved (none in this scene) are recomputed. A moved
+    // group also moves the bounds of its objects, which would need a BvhRefit.
+    TransformHierarchyUpdate(&Vk->SceneHierarchy);
+    const mat4 *GroupWorld = Vk->SceneHierarchy.World + 1;
+    
+    scratch_block TransformScratch(MB(1) + Vk->Objects.Count * sizeof(u32)); // job data and Visible
+    TransformBatchParallel(&Vk->Objects, UBO.viewProj, GroupWorld, Vk->ObjectTransforms[ImageIndex], TransformScratch);
+    
+    // culling, to scratch first: the draw buffer is write-combined memory
+    frustum Frustum = FrustumFromViewProj(UBO.viewProj);
+    u32* Visible      = PushArray(TransformScratch, u32, Vk->ObjectBvh.Count);
+    u32  VisibleCount = BvhQueryFrustumParallel(&Vk->ObjectBvh, &Frustum, Visible, TransformScratch);
+    
+    u8* DrawData = Vk->DrawData[ImageIndex];
+    memcpy(DrawData + DRAW_BUFFER_VISIBLE_OFFSET, Visible, VisibleCount * sizeof(u32));
+    ((VkDrawIndexedIndirectCommand*)DrawData)->instanceCount = VisibleCount;
+    
+    void *UBOData;
+    VkDeviceMemory UniformMemory = VulkanGetBufferMemory(&Vk->Resources, Vk->UniformBuffers[ImageIndex]);
+    vkMapMemory(Vk->Device, UniformMemory, 0, sizeof(uniform_buffer_object), 0, &UBOData);
+    memcpy(UBOData, &UBO, sizeof(uniform_buffer_object));
+    vkUnmapMemory(Vk->Device, UniformMemory);
+    
+    FrameTimingEndPhase(Timing, FramePhase_UBOUpdate);
+    
+    // submitting the command buffer
+    VkSemaphore          WaitSemaphores[]   = {Vk->ImageAvailableSemaphore[CurrentFrame]};
+    VkSemaphore          SignalSemaphores[] = {Vk->RenderFinishedSemaphore[CurrentFrame]};
+    VkPipelineStageFlags WaitStages[]       = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    
+    VkSubmitInfo SubmitInfo = {};
+    SubmitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.waitSemaphoreCount   = 1;
+    SubmitInfo.pWaitSemaphores      = WaitSemaphores;
+    SubmitInfo.pWaitDstStageMask    = WaitStages;
+    SubmitInfo.commandBufferCount   = 1;
+    SubmitInfo.pCommandBuffers      = &Vk->CommandBuffers[ImageIndex];
+    SubmitInfo.signalSemaphoreCount = 1;
+    SubmitInfo.pSignalSemaphores    = SignalSemaphores;
+    
+    if (vkQueueSubmit(Vk->GraphicsQueue, 1, &SubmitInfo, 
+                      Vk->InFlightFences[CurrentFrame]) != VK_SUCCESS) {
+        ExitWithError("Failed to submit draw command buffer");
+    }
+    
+    FrameTimingEndPhase(Timing, FramePhase_Submit);
+    
+    VkSwapchainKHR Swapchains[] = {Vk->Swapchain};
+    
+    // presentation
+    VkPresentInfoKHR PresentInfo = {};
+    PresentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    PresentInfo.waitSemaphoreCount = 1;
+    PresentInfo.pWaitSemaphores    = SignalSemaphores;
+    PresentInfo.swapchainCount     = 1;
+    PresentInfo.pSwapchains        = Swapchains;
+    PresentInfo.pImageIndices      = &ImageIndex;
+    PresentInfo.pResults           = NULL;
+    
+    Res = vkQueuePresentKHR(Vk->PresentQueue, &PresentInfo);
+    
+    FrameTimingEndPhase(Timing, FramePhase_Present);
+    
+    if (Res == VK_ERROR_OUT_OF_DATE_KHR || Res == VK_SUBOPTIMAL_KHR || WindowResized)
+    {
+        vkDeviceWaitIdle(Vk->Device);
+        VulkanCleanupSwapchain(Vk);
+        VulkanCreateSwapchain(Vk);
+        VulkanHostMemoryReport("swapchain recreated");
+    }
+    else if (Res != VK_SUCCESS)
+    {
+        ExitWithError("Failed to present swapchain image");
+    }
+    
+    Vk->CurrentFrame = (CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
@@ -0,0 +1,333 @@
+/* date = October 17th 2026 7:50 pm */
+
+#ifndef VULKAN_RESOURCES_H
+#define VULKAN_RESOURCES_H
+
+// NOTE(jdiaz): GPU resource tables. Every kind of resource (buffers, images, views, samplers,
+// pipelines) lives in a table of parallel arrays: the Vulkan handle used when recording commands
+// (hot) is packed on its own, the memory and creation info only needed to create, inspect or
+// destroy the resource (cold) live in separate arrays.
+//
+// Resources are addressed by 32-bit generational handles: the low RESOURCE_INDEX_BITS are the
+// slot, the rest is the slot generation. The generation is bumped when a slot is filled and again
+// when it is released (odd = live), so a handle to a released or reused slot never validates.
+// A zero handle is never valid.
+
+#define RESOURCE_INDEX_BITS       20
+#define RESOURCE_INDEX_MASK       ((1u << RESOURCE_INDEX_BITS) - 1)
+#define RESOURCE_GENERATION_MASK  ((1u << (32 - RESOURCE_INDEX_BITS)) - 1)
+
+#define VULKAN_MAX_BUFFERS   65536
+#define VULKAN_MAX_IMAGES    16384
+#define VULKAN_MAX_VIEWS     16384
+#define VULKAN_MAX_SAMPLERS  1024
+#define VULKAN_MAX_PIPELINES 1024
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct vulkan_buffer_handle   { u32 Value; };
+struct vulkan_image_handle    { u32 Value; };
+struct vulkan_view_handle     { u32 Value; };
+struct vulkan_sampler_handle  { u32 Value; };
+struct vulkan_pipeline_handle { u32 Value; };
+
+// Slot bookkeeping shared by all the tables
+struct resource_table
+{
+    u32  Capacity;
+    u32  Count;       // live slots
+    u32  UsedCount;   // slots below this have been used at least once
+    u32  FirstFree;   // released slots, linked through NextFree
+    u16* Generations;
+    u32* NextFree;
+};
+
+struct vulkan_buffer_table
+{
+    resource_table      Table;
+    VkBuffer*           Buffers;   // hot
+    VkDeviceMemory*     Memories;
+    VkDeviceSize*       Sizes;
+    VkBufferUsageFlags* Usages;
+};
+
+struct vulkan_image_table
+{
+    resource_table  Table;
+    VkImage*        Images;    // hot
+    VkDeviceMemory* Memories;
+    VkFormat*       Formats;
+    VkExtent2D*     Extents;
+    u32*            MipLevels;
+};
+
+struct vulkan_view_table
+{
+    resource_table       Table;
+    VkImageView*         Views;  // hot
+    vulkan_image_handle* Images;
+};
+
+struct vulkan_sampler_table
+{
+    resource_table Table;
+    VkSampler*     Samplers; // hot
+};
+
+struct vulkan_pipeline_table
+{
+    resource_table    Table;
+    VkPipeline*       Pipelines; // hot
+    VkPipelineLayout* Layouts;
+};
+
+struct vulkan_resources
+{
+    arena                 Memory;
+    vulkan_buffer_table   Buffers;
+    vulkan_image_table    Images;
+    vulkan_view_table     Views;
+    vulkan_sampler_table  Samplers;
+    vulkan_pipeline_table Pipelines;
+};
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal void ResourceTableInit(resource_table *Table, arena *Arena, u32 Capacity)
+{
+    Assert(Capacity <= RESOURCE_INDEX_MASK);
+    
+    *Table = {};
+    Table->Capacity    = Capacity;
+    Table->FirstFree   = U32_MAX;
+    Table->Generations = PushArray(Arena, u16, Capacity, ArenaPush_Zero);
+    Table->NextFree    = PushArray(Arena, u32, Capacity);
+}
+
+inline u32 ResourceHandleIndex(u32 Handle)
+{
+    return Handle & RESOURCE_INDEX_MASK;
+}
+
+inline b32 ResourceTableIsLive(resource_table *Table, u32 Handle)
+{
+    u32 Index = ResourceHandleIndex(Handle);
+    return Handle != 0 && Index < Table->UsedCount &&
+        Table->Generations[Index] == (Handle >> RESOURCE_INDEX_BITS);
+}
+
+// Index of a live handle, stale handles stop here
+inline u32 ResourceTableIndex(resource_table *Table, u32 Handle)
+{
+    Assert(ResourceTableIsLive(Table, Handle));
+    return ResourceHandleIndex(Handle);
+}
+
+internal u32 ResourceTableAdd(resource_table *Table)
+{
+    u32 Index;
+    if (Table->FirstFree != U32_MAX)
+    {
+        Index = Table->FirstFree;
+        Table->FirstFree = Table->NextFree[Index];
+    }
+    else
+    {
+        Assert(Table->UsedCount < Table->Capacity);
+        Index = Table->UsedCount++;
+    }
+    
+    // even -> odd, a live generation is never 0 so neither is the handle
+    u16 Generation = (Table->Generations[Index] + 1) & RESOURCE_GENERATION_MASK;
+    Table->Generations[Index] = Generation;
+    Table->Count++;
+    
+    return (Generation << RESOURCE_INDEX_BITS) | Index;
+}
+
+internal void ResourceTableRemove(resource_table *Table, u32 Handle)
+{
+    u32 Index = ResourceTableIndex(Table, Handle);
+    
+    // odd -> even, wraps back to 0 after RESOURCE_GENERATION_MASK
+    Table->Generations[Index] = (Table->Generations[Index] + 1) & RESOURCE_GENERATION_MASK;
+    Table->NextFree[Index] = Table->FirstFree;
+    Table->FirstFree = Index;
+    Table->Count--;
+}
+
+internal void VulkanResourcesInit(vulkan_resources *Res)
+{
+    *Res = {};
+    Res->Memory = MakeGrowingArena(MB(4), MemoryTag_Resources);
+    arena *Arena = &Res->Memory;
+    
+    ResourceTableInit(&Res->Buffers.Table, Arena, VULKAN_MAX_BUFFERS);
+    Res->Buffers.Buffers  = PushArray(Arena, VkBuffer,           VULKAN_MAX_BUFFERS);
+    Res->Buffers.Memories = PushArray(Arena, VkDeviceMemory,     VULKAN_MAX_BUFFERS);
+    Res->Buffers.Sizes    = PushArray(Arena, VkDeviceSize,       VULKAN_MAX_BUFFERS);
+    Res->Buffers.Usages   = PushArray(Arena, VkBufferUsageFlags, VULKAN_MAX_BUFFERS);
+    
+    ResourceTableInit(&Res->Images.Table, Arena, VULKAN_MAX_IMAGES);
+    Res->Images.Images    = PushArray(Arena, VkImage,        VULKAN_MAX_IMAGES);
+    Res->Images.Memories  = PushArray(Arena, VkDeviceMemory, VULKAN_MAX_IMAGES);
+    Res->Images.Formats   = PushArray(Arena, VkFormat,       VULKAN_MAX_IMAGES);
+    Res->Images.Extents   = PushArray(Arena, VkExtent2D,     VULKAN_MAX_IMAGES);
+    Res->Images.MipLevels = PushArray(Arena, u32,            VULKAN_MAX_IMAGES);
+    
+    ResourceTableInit(&Res->Views.Table, Arena, VULKAN_MAX_VIEWS);
+    Res->Views.Views      = PushArray(Arena, VkImageView,         VULKAN_MAX_VIEWS);
+    Res->Views.Images     = PushArray(Arena, vulkan_image_handle, VULKAN_MAX_VIEWS);
+    
+    ResourceTableInit(&Res->Samplers.Table, Arena, VULKAN_MAX_SAMPLERS);
+    Res->Samplers.Samplers = PushArray(Arena, VkSampler, VULKAN_MAX_SAMPLERS);
+    
+    ResourceTableInit(&Res->Pipelines.Table, Arena, VULKAN_MAX_PIPELINES);
+    Res->Pipelines.Pipelines = PushArray(Arena, VkPipeline,       VULKAN_MAX_PIPELINES);
+    Res->Pipelines.Layouts   = PushArray(Arena, VkPipelineLayout, VULKAN_MAX_PIPELINES);
+}
+
+// Every resource has to be destroyed by now, anything left is a leak
+internal void VulkanResourcesShutdown(vulkan_resources *Res)
+{
+    Assert(Res->Buffers.Table.Count   == 0);
+    Assert(Res->Images.Table.Count    == 0);
+    Assert(Res->Views.Table.Count     == 0);
+    Assert(Res->Samplers.Table.Count  == 0);
+    Assert(Res->Pipelines.Table.Count == 0);
+    
+    ClearArena(&Res->Memory);
+}
+
+// Buffers
+
+internal vulkan_buffer_handle VulkanAddBuffer(vulkan_resources *Res, VkBuffer Buffer, VkDeviceMemory Memory, VkDeviceSize Size, VkBufferUsageFlags Usage)
+{
+    vulkan_buffer_handle Handle = { ResourceTableAdd(&Res->Buffers.Table) };
+    u32 Index = ResourceHandleIndex(Handle.Value);
+    Res->Buffers.Buffers[Index]  = Buffer;
+    Res->Buffers.Memories[Index] = Memory;
+    Res->Buffers.Sizes[Index]    = Size;
+    Res->Buffers.Usages[Index]   = Usage;
+    return Handle;
+}
+
+inline VkBuffer VulkanGetBuffer(vulkan_resources *Res, vulkan_buffer_handle Handle)
+{
+    return Res->Buffers.Buffers[ ResourceTableIndex(&Res->Buffers.Table, Handle.Value) ];
+}
+
+inline VkDeviceMemory VulkanGetBufferMemory(vulkan_resources *Res, vulkan_buffer_handle Handle)
+{
+    return Res->Buffers.Memories[ ResourceTableIndex(&Res->Buffers.Table, Handle.Value) ];
+}
+
+internal void VulkanDestroyBuffer(VkDevice Device, vulkan_resources *Res, vulkan_buffer_handle Handle)
+{
+    u32 Index = ResourceTableIndex(&Res->Buffers.Table, Handle.Value);
+    vkDestroyBuffer(Device, Res->Buffers.Buffers[Index], VulkanAllocator);
+    VulkanFreeMemory(Device, Res->Buffers.Memories[Index]);
+    ResourceTableRemove(&Res->Buffers.Table, Handle.Value);
+}
+
+// Images
+
+internal vulkan_image_handle VulkanAddImage(vulkan_resources *Res, VkImage Image, VkDeviceMemory Memory, VkFormat Format, u32 Width, u32 Height, u32 MipLevels)
+{
+    vulkan_image_handle Handle = { ResourceTableAdd(&Res->Images.Table) };
+    u32 Index = ResourceHandleIndex(Handle.Value);
+    Res->Images.Images[Index]    = Image;
+    Res->Images.Memories[Index]  = Memory;
+    Res->Images.Formats[Index]   = Format;
+    Res->Images.Extents[Index]   = { Width, Height };
+    Res->Images.MipLevels[Index] = MipLevels;
+    return Handle;
+}
+
+inline VkImage VulkanGetImage(vulkan_resources *Res, vulkan_image_handle Handle)
+{
+    return Res->Images.Images[ ResourceTableIndex(&Res->Images.Table, Handle.Value) ];
+}
+
+inline u32 VulkanGetImageMipLevels(vulkan_resources *Res, vulkan_image_handle Handle)
+{
+    return Res->Images.MipLevels[ ResourceTableIndex(&Res->Images.Table, Handle.Value) ];
+}
+
+internal void VulkanDestroyImage(VkDevice Device, vulkan_resources *Res, vulkan_image_handle Handle)
+{
+    u32 Index = ResourceTableIndex(&Res->Images.Table, Handle.Value);
+    vkDestroyImage(Device, Res->Images.Images[Index], VulkanAllocator);
+    VulkanFreeMemory(Device, Res->Images.Memories[Index]);
+    ResourceTableRemove(&Res->Images.Table, Handle.Value);
+}
+
+// Image views
+
+internal vulkan_view_handle VulkanAddView(vulkan_resources *Res, VkImageView View, vulkan_image_handle Image)
+{
+    vulkan_view_handle Handle = { ResourceTableAdd(&Res->Views.Table) };
+    u32 Index = ResourceHandleIndex(Handle.Value);
+    Res->Views.Views[Index]  = View;
+    Res->Views.Images[Index] = Image;
+    return Handle;
+}
+
+inline VkImageView VulkanGetView(vulkan_resources *Res, vulkan_view_handle Handle)
+{
+    return Res->Views.Views[ ResourceTableIndex(&Res->Views.Table, Handle.Value) ];
+}
+
+internal void VulkanDestroyView(VkDevice Device, vulkan_resources *Res, vulkan_view_handle Handle)
+{
+    u32 Index = ResourceTableIndex(&Res->Views.Table, Handle.Value);
+    vkDestroyImageView(Device, Res->Views.Views[Index], VulkanAllocator);
+    ResourceTableRemove(&Res->Views.Table, Handle.Value);
+}
+
+// Samplers
+
+internal vulkan_sampler_handle VulkanAddSampler(vulkan_resources *Res, VkSampler Sampler)
+{
+    vulkan_sampler_handle Handle = { ResourceTableAdd(&Res->Samplers.Table) };
+    Res->Samplers.Samplers[ ResourceHandleIndex(Handle.Value) ] = Sampler;
+    return Handle;
+}
+
+inline VkSampler VulkanGetSampler(vulkan_resources *Res, vulkan_sampler_handle Handle)
+{
+    return Res->Samplers.Samplers[ ResourceTableIndex(&Res->Samplers.Table, Handle.Value) ];
+}
+
+internal void VulkanDestroySampler(VkDevice Device, vulkan_resources *Res, vulkan_sampler_handle Handle)
+{
+    u32 Index = ResourceTableIndex(&Res->Samplers.Table, Handle.Value);
+    vkDestroySampler(Device, Res->Samplers.Samplers[Index], VulkanAllocator);
+    ResourceTableRemove(&Res->Samplers.Table, Handle.Value);
+}
+
+// Pipelines (the layout is referenced, not owned)
+
+internal vulkan_pipeline_handle VulkanAddPipeline(vulkan_resources *Res, VkPipeline Pipeline, VkPipelineLayout Layout)
+{
+    vulkan_pipeline_handle Handle = { ResourceTableAdd(&Res->Pipelines.Table) };
+    u32 Index = ResourceHandleIndex(Handle.Value);
+    Res->Pipelines.Pipelines[Index] = Pipeline;
+    Res->Pipelines.Layouts[Index]   = Layout;
+    return Handle;
+}
+
+inline VkPipeline VulkanGetPipeline(vulkan_resources *Res, vulkan_pipeline_handle Handle)
+{
+    return Res->Pipelines.Pipelines[ ResourceTableIndex(&Res->Pipelines.Table, Handle.Value) ];
+}
+
+internal void VulkanDestroyPipeline(VkDevice Device, vulkan_resources *Res, vulkan_pipeline_handle Handle)
+{
+    u32 Index = ResourceTableIndex(&Res->Pipelines.Table, Handle.Value);
+    vkDestroyPipeline(Device, Res->Pipelines.Pipelines[Index], VulkanAllocator);
+    ResourceTableRemove(&Res->Pipelines.Table, Handle.Value);
+}
+
+#endif //VULKAN_RESOURCES_H
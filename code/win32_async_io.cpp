@@ -0,0 +1,208 @@
+// NOTE(jdiaz): Overlapped I/O backend for async_io.h. Every file is opened with
+// FILE_FLAG_OVERLAPPED and bound to a single completion port, ReadFile returns as soon as the read
+// is queued, and finished reads are dequeued in batches with GetQueuedCompletionStatusEx. Reads are
+// handed to the kernel as soon as they are submitted, so AsyncIOFlush has nothing to do here.
+
+// Types //////////////////////////////////////////////////////////////////////////////////////////
+
+struct win32_async_io_slot
+{
+    OVERLAPPED  Overlapped;
+    HANDLE      File;
+    async_read* Read;
+    u64         Offset;
+    u32         NextFree;
+};
+
+struct win32_async_io
+{
+    HANDLE Port;
+    
+    win32_async_io_slot* Slots;
+    u32                  SlotCount;
+    u32                  FirstFreeSlot;
+    volatile LONG        InFlight;
+    
+    arena            Memory; // slots
+    CRITICAL_SECTION Lock;
+};
+
+
+// Globals ////////////////////////////////////////////////////////////////////////////////////////
+
+internal win32_async_io AsyncIO;
+
+
+// Functions //////////////////////////////////////////////////////////////////////////////////////
+
+internal void AsyncIOInit(u32 QueueDepth)
+{
+    AsyncIO = {};
+    AsyncIO.Memory.Tag = MemoryTag_AsyncIO;
+    InitializeCriticalSection(&AsyncIO.Lock);
+    
+    AsyncIO.Port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 0);
+    if (!AsyncIO.Port) {
+        ExitWithError("Could not create the I/O completion port");
+    }
+    
+    AsyncIO.SlotCount = QueueDepth;
+    AsyncIO.Slots     = PushArray(&AsyncIO.Memory, win32_async_io_slot, QueueDepth, ArenaPush_Zero);
+    
+    for (u32 i = 0; i < QueueDepth; ++i)
+    {
+        AsyncIO.Slots[i].NextFree = i + 1;
+    }
+    AsyncIO.FirstFreeSlot = 0;
+}
+
+internal void AsyncIOShutdown()
+{
+    Assert(AsyncIO.InFlight == 0);
+    
+    CloseHandle(AsyncIO.Port);
+    ClearArena(&AsyncIO.Memory);
+    DeleteCriticalSection(&AsyncIO.Lock);
+    AsyncIO = {};
+}
+
+internal void Win32QueueRead(u32 SlotIndex)
+{
+    win32_async_io_slot *Slot = AsyncIO.Slots + SlotIndex;
+    async_read *Read = Slot->Read;
+    
+    Slot->Overlapped = {};
+    Slot->Overlapped.Offset     = (DWORD)(Slot->Offset);
+    Slot->Overlapped.OffsetHigh = (DWORD)(Slot->Offset >> 32);
+    
+    DWORD ByteCount = (DWORD)(Read->ByteCount - Slot->Offset);
+    
+    if (ByteCount == 0 ||
+        (!ReadFile(Slot->File, Read->Bytes + Slot->Offset, ByteCount, NULL, &Slot->Overlapped) &&
+         GetLastError() != ERROR_IO_PENDING))
+    {
+        // NOTE(jdiaz): Nothing was queued, post the completion ourselves so it is reaped like the rest
+        Slot->Overlapped.Internal = (ByteCount == 0) ? 0 : GetLastError();
+        PostQueuedCompletionStatus(AsyncIO.Port, 0, SlotIndex, &Slot->Overlapped);
+    }
+}
+
+internal b32 AsyncIOSubmitRead(async_read *Read, arena *Arena)
+{
+    Read->Bytes     = 0;
+    Read->ByteCount = 0;
+    Read->Completed = false;
+    Read->Succeeded = false;
+    
+    HANDLE File = CreateFileA(Read->FilePath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                              FILE_FLAG_OVERLAPPED|FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (File == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize))
+    {
+        CloseHandle(File);
+        return false;
+    }
+    Assert(FileSize.QuadPart < U32_MAX);
+    
+    EnterCriticalSection(&AsyncIO.Lock);
+    
+    if ((u32)AsyncIO.InFlight == AsyncIO.SlotCount)
+    {
+        LeaveCriticalSection(&AsyncIO.Lock);
+        CloseHandle(File);
+        return false;
+    }
+    
+    // NOTE(jdiaz): 16 byte aligned so SPIR-V and pixel data can be consumed in place
+    Read->ByteCount = FileSize.QuadPart;
+    Read->Bytes     = PushSize(Arena, Read->ByteCount + 1, 16);
+    Read->Bytes[ Read->ByteCount ] = 0;
+    
+    u32 SlotIndex = AsyncIO.FirstFreeSlot;
+    win32_async_io_slot *Slot = AsyncIO.Slots + SlotIndex;
+    AsyncIO.FirstFreeSlot = Slot->NextFree;
+    InterlockedIncrement(&AsyncIO.InFlight);
+    
+    LeaveCriticalSection(&AsyncIO.Lock);
+    
+    Slot->Read   = Read;
+    Slot->File   = File;
+    Slot->Offset = 0;
+    
+    if (!CreateIoCompletionPort(File, AsyncIO.Port, SlotIndex, 0)) {
+        ExitWithError("Could not bind a file to the I/O completion port");
+    }
+    
+    Win32QueueRead(SlotIndex);
+    
+    return true;
+}
+
+internal void AsyncIOFlush()
+{
+}
+
+internal u32 AsyncIOGetCompletions(async_read **Completions, u32 MaxCount, b32 Wait)
+{
+    u32 Count = 0;
+    
+    while (Count == 0 && AsyncIO.InFlight > 0)
+    {
+        OVERLAPPED_ENTRY Entries[16];
+        ULONG EntryCount = 0;
+        ULONG MaxEntryCount = Min(MaxCount, (u32)ArrayCount(Entries));
+        
+        // NOTE(jdiaz): Several threads can wait at once (e.g. a job waiting for the texture while the
+        // render thread waits for the shaders) and any of them may dequeue the last completion, so
+        // never block forever, wake up now and then to check if there is still something in flight
+        if (!GetQueuedCompletionStatusEx(AsyncIO.Port, Entries, MaxEntryCount, &EntryCount, Wait ? 1 : 0, FALSE))
+        {
+            if (Wait && GetLastError() == WAIT_TIMEOUT) {
+                continue;
+            }
+            break;
+        }
+        
+        for (ULONG i = 0; i < EntryCount; ++i)
+        {
+            u32 SlotIndex = (u32)Entries[i].lpCompletionKey;
+            win32_async_io_slot *Slot = AsyncIO.Slots + SlotIndex;
+            async_read *Read = Slot->Read;
+            
+            b32 Succeeded = (Slot->Overlapped.Internal == 0);
+            Slot->Offset += Entries[i].dwNumberOfBytesTransferred;
+            
+            if (Succeeded && Entries[i].dwNumberOfBytesTransferred > 0 && Slot->Offset < Read->ByteCount)
+            {
+                // Short read, queue the remainder
+                Win32QueueRead(SlotIndex);
+                continue;
+            }
+            
+            CloseHandle(Slot->File);
+            Read->Succeeded = Succeeded && Slot->Offset == Read->ByteCount;
+            
+            // Completed before InFlight drops, a waiter seeing nothing in flight must see its read done
+            MemoryBarrier();
+            Read->Completed = true;
+            Completions[Count++] = Read;
+            
+            EnterCriticalSection(&AsyncIO.Lock);
+            Slot->Read     = 0;
+            Slot->NextFree = AsyncIO.FirstFreeSlot;
+            AsyncIO.FirstFreeSlot = SlotIndex;
+            InterlockedDecrement(&AsyncIO.InFlight);
+            LeaveCriticalSection(&AsyncIO.Lock);
+        }
+        
+        if (!Wait) {
+            break;
+        }
+    }
+    
+    return Count;
+}
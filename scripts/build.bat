@@ -8,12 +8,15 @@ pushd %BAT_DIR%\..
 
 set OutputDirs=-Febin\main.exe -Fobuild\ -Fdbuild\
 set CommonCompilerFlags=-Zi -FC -GR- -EHa- -nologo
-set CommonLinkerFlags=-PDB:build\main.pdb -INCREMENTAL:NO -MACHINE:X64 user32.lib
+set CommonLinkerFlags=-PDB:build\main.pdb -INCREMENTAL:NO -MACHINE:X64 user32.lib advapi32.lib winmm.lib
 
 set VulkanDir=C:\VulkanSDK\1.2.148.1
 set CommonCompilerFlags=%CommonCompilerFlags% -I%VulkanDir%\Include
 set CommonLinkerFlags=%CommonLinkerFlags% -LIBPATH:%VulkanDir%\Lib vulkan-1.lib
 
+REM Pool poisoning, catches use after free and double frees (see code\pool.h)
+REM set CommonCompilerFlags=%CommonCompilerFlags% -DPOOL_DEBUG=1
+
 REM Optimization switches /O2
 REM set CommonCompilerFlags=-MTd -nologo -fp:fast -Gm- -GR- -EHa- -Od -Oi -WX -W4 -wd4201 -wd4100 -wd4189 -wd4505 -FC -Z7
 
@@ -23,8 +26,22 @@ IF NOT EXIST bin   mkdir bin
 REM Executable
 cl %OutputDirs% %CommonCompilerFlags% code\main.cpp /link %CommonLinkerFlags%
 
+REM Asset packer
+cl -Febin\pak_builder.exe -Fobuild\ -Fdbuild\ %CommonCompilerFlags% code\pak_builder.cpp /link -INCREMENTAL:NO
+
+REM BVH queries against brute force (run bin\bvh_test.exe)
+cl -Febin\bvh_test.exe -Fobuild\ -Fdbuild\ %CommonCompilerFlags% code\bvh_test.cpp /link -INCREMENTAL:NO
+
+REM Vertex packing round trips (run bin\vertex_packing_test.exe)
+cl -Febin\vertex_packing_test.exe -Fobuild\ -Fdbuild\ %CommonCompilerFlags% code\vertex_packing_test.cpp /link -INCREMENTAL:NO
+
 REM Shaders
 glslc code\vertex_shader.glsl   -o bin\vertex_shader.spv
 glslc code\fragment_shader.glsl -o bin\fragment_shader.spv
 
+REM Asset archive (texture.jpg is not part of the repository, it is packed when present)
+set PakFiles=bin\vertex_shader.spv bin\fragment_shader.spv
+IF EXIST bin\texture.jpg set PakFiles=%PakFiles% bin\texture.jpg
+bin\pak_builder.exe bin\assets.pak %PakFiles%
+
 popd
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+
+pushd "$SCRIPT_DIR/.." > /dev/null
+
+OutputDirs="-o bin/main"
+CommonCompilerFlags="-g -O2 -std=c++14 -fno-rtti -fno-exceptions -Wno-write-strings"
+CommonLinkerFlags="-lvulkan -lm -lpthread"
+
+# Validation layers (needs the Vulkan SDK layers installed)
+# CommonCompilerFlags="$CommonCompilerFlags -DUSE_VALIDATION_LAYERS"
+
+# Pool poisoning, catches use after free and double frees (see code/pool.h)
+# CommonCompilerFlags="$CommonCompilerFlags -DPOOL_DEBUG=1"
+
+mkdir -p build bin
+
+# Executable
+g++ $CommonCompilerFlags code/linux_main.cpp $OutputDirs $CommonLinkerFlags
+
+# Asset packer
+g++ $CommonCompilerFlags code/pak_builder.cpp -o bin/pak_builder
+
+# BVH queries against brute force (run bin/bvh_test)
+g++ $CommonCompilerFlags code/bvh_test.cpp -o bin/bvh_test -lm -lpthread
+
+# Vertex packing round trips (run bin/vertex_packing_test)
+g++ $CommonCompilerFlags code/vertex_packing_test.cpp -o bin/vertex_packing_test -lm
+
+# Shaders
+glslc code/vertex_shader.glsl   -o bin/vertex_shader.spv
+glslc code/fragment_shader.glsl -o bin/fragment_shader.spv
+
+# Asset archive (texture.jpg is not part of the repository, it is packed when present)
+PakFiles="bin/vertex_shader.spv bin/fragment_shader.spv"
+if [ -f bin/texture.jpg ]; then PakFiles="$PakFiles bin/texture.jpg"; fi
+bin/pak_builder bin/assets.pak $PakFiles
+
+popd > /dev/null
@@ -0,0 +1,7 @@
+#!/bin/bash
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+
+pushd "$SCRIPT_DIR/../bin" > /dev/null
+./main "$@"
+popd > /dev/null